@@ -1,5 +1,6 @@
 
 #include <async/oneshot-event.hpp>
+#include <helix/clock.hpp>
 #include <helix/memory.hpp>
 #include <protocols/clock/defs.hpp>
 #include <protocols/mbus/client.hpp>
@@ -65,21 +66,26 @@ async::result<void> enumerateTracker() {
 int64_t getRealtimeNanos() {
 	auto page = reinterpret_cast<TrackerPage *>(trackerPageMapping.get());
 
-	// Start the seqlock read.
-	auto seqlock = __atomic_load_n(&page->seqlock, __ATOMIC_ACQUIRE);
-	assert(!(seqlock & 1));
+	int64_t ref;
+	int64_t base;
+	while(true) {
+		// Start the seqlock read.
+		auto seqlock = __atomic_load_n(&page->seqlock, __ATOMIC_ACQUIRE);
+		if(seqlock & 1)
+			continue;
 
-	// Perform the actual loads.
-	auto ref = __atomic_load_n(&page->refClock, __ATOMIC_RELAXED);
-	auto base = __atomic_load_n(&page->baseRealtime, __ATOMIC_RELAXED);
+		// Perform the actual loads.
+		ref = __atomic_load_n(&page->refClock, __ATOMIC_RELAXED);
+		base = __atomic_load_n(&page->baseRealtime, __ATOMIC_RELAXED);
 
-	// Finish the seqlock read.
-	__atomic_thread_fence(__ATOMIC_ACQUIRE);
-	assert(__atomic_load_n(&page->seqlock, __ATOMIC_RELAXED) == seqlock);
+		// Finish the seqlock read.
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if(__atomic_load_n(&page->seqlock, __ATOMIC_RELAXED) == seqlock)
+			break;
+	}
 
 	// Calculate the current time.
-	uint64_t now;
-	HEL_CHECK(helGetClock(&now));
+	uint64_t now = helix::getClockNanos();
 
 	return base + (now - ref);
 }
@@ -93,8 +99,7 @@ struct timespec getRealtime() {
 }
 
 struct timespec getTimeSinceBoot() {
-	uint64_t now;
-	HEL_CHECK(helGetClock(&now));
+	uint64_t now = helix::getClockNanos();
 
 	struct timespec result;
 	result.tv_sec = now / 1'000'000'000;
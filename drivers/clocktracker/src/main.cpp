@@ -62,6 +62,21 @@ TrackerPage *accessPage() {
 	return reinterpret_cast<TrackerPage *>(trackerPageMapping.get());
 }
 
+// Updates the tracker page. Readers retry while the seqlock is odd
+// or if it changed during their read.
+void updatePage(int64_t refClock, int64_t baseRealtime) {
+	auto page = accessPage();
+
+	auto seqlock = __atomic_load_n(&page->seqlock, __ATOMIC_RELAXED);
+	__atomic_store_n(&page->seqlock, seqlock + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&page->refClock, refClock, __ATOMIC_RELAXED);
+	__atomic_store_n(&page->baseRealtime, baseRealtime, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&page->seqlock, seqlock + 2, __ATOMIC_RELEASE);
+}
+
 // ----------------------------------------------------------------------------
 // clocktracker mbus interface.
 // ----------------------------------------------------------------------------
@@ -143,13 +158,12 @@ async::detached initializeDriver() {
 #if defined(__aarch64__) || defined(__riscv)
 	auto result = RtcTime{0, 0};
 #else
-	auto result = co_await getRtcTime(); // TODO: Use the seqlock.
+	auto result = co_await getRtcTime();
 #endif
 
 	std::cout << "drivers/clocktracker: Initializing time to "
 			<< std::get<1>(result) << std::endl;
-	accessPage()->refClock = std::get<0>(result);
-	accessPage()->baseRealtime = std::get<1>(result);
+	updatePage(std::get<0>(result), std::get<1>(result));
 
 	// Create an mbus object for the device.
 	mbus_ng::Properties descriptor{
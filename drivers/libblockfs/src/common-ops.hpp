@@ -96,8 +96,6 @@ async::result<protocols::fs::ReadResult> doReadImpl(T *inode, void *buffer, size
 	auto chunkOffset = offset;
 	offset += chunkSize;
 
-	// TODO: Add a sendFromMemory action to exchangeMsgs to avoid
-	// having to copy this data twice.
 	auto readMemory = co_await helix_ng::readMemory(
 		inode->accessMemory(),
 		chunkOffset, chunkSize, buffer);
@@ -131,8 +129,6 @@ doWriteImpl(T *inode, const void *buffer, size_t length, bool append, auto &offs
 	if (offset >= inode->fileSize())
 		FRG_CO_TRY(co_await inode->resizeFile(offset + length));
 
-	// TODO: Add a recvToMemory action to exchangeMsgs to avoid
-	// having to copy this data twice.
 	auto writeMemory = co_await helix_ng::writeMemory(
 		inode->accessMemory(),
 		offset, length, buffer);
@@ -143,6 +139,86 @@ doWriteImpl(T *inode, const void *buffer, size_t length, bool append, auto &offs
 	co_return length;
 }
 
+// Like doReadImpl() but lets the server send the file contents directly
+// from the inode's memory object (via sendFromMemory).
+template <Inode T>
+async::result<frg::expected<protocols::fs::Error, size_t>>
+doReadRangeImpl(T *inode, size_t length, auto &offset,
+		protocols::fs::MemoryRangeTransfer &transfer) {
+	protocols::ostrace::Timer timer;
+	frg::scope_exit evtOnExit{[&] {
+		ostContext.emit(
+			ostEvtRead,
+			ostAttrNumBytes(length),
+			ostAttrTime(timer.elapsed())
+		);
+	}};
+
+	co_await inode->readyEvent.wait();
+
+	if (!length)
+		co_return size_t{0};
+
+	if (inode->fileType == FileType::kTypeDirectory)
+		co_return protocols::fs::Error::isDirectory;
+	if (offset >= inode->fileSize())
+		co_return protocols::fs::Error::endOfFile;
+
+	// The transfer is submitted before we suspend again, hence a concurrent truncate
+	// cannot shrink the memory object below the range that we compute here.
+	auto remaining = inode->fileSize() - offset;
+	auto chunkSize = std::min(length, remaining);
+	if (!chunkSize)
+		co_return protocols::fs::Error::endOfFile;
+
+	auto chunkOffset = offset;
+	auto sent = co_await transfer(inode->accessMemory(), chunkOffset, chunkSize);
+	offset = chunkOffset + sent;
+
+	co_return sent;
+}
+
+// Like doWriteImpl() but lets the server receive the client's data directly
+// into the inode's memory object (via recvToMemory).
+template <Inode T>
+async::result<frg::expected<protocols::fs::Error, size_t>>
+doWriteRangeImpl(T *inode, size_t length, bool append, auto &offset,
+		protocols::fs::MemoryRangeTransfer &transfer) {
+	protocols::ostrace::Timer timer;
+	frg::scope_exit evtOnExit{[&] {
+		ostContext.emit(
+			ostEvtWrite,
+			ostAttrNumBytes(length),
+			ostAttrTime(timer.elapsed())
+		);
+	}};
+
+	co_await inode->readyEvent.wait();
+
+	if (!length)
+		co_return size_t{0};
+
+	if (inode->fileType == FileType::kTypeDirectory)
+		co_return protocols::fs::Error::isDirectory;
+
+	if (append)
+		offset = inode->fileSize();
+	auto chunkOffset = offset;
+	auto oldSize = inode->fileSize();
+	if (chunkOffset + length > oldSize)
+		FRG_CO_TRY(co_await inode->resizeFile(chunkOffset + length));
+
+	auto received = co_await transfer(inode->accessMemory(), chunkOffset, length);
+
+	// Only commit the data that the client actually sent. Concurrent pwrites may
+	// have grown the file further in the meantime; in this case, we keep their size.
+	if (received < length && chunkOffset + length > oldSize
+			&& inode->fileSize() == chunkOffset + length)
+		FRG_CO_TRY(co_await inode->resizeFile(std::max(oldSize, chunkOffset + received)));
+	offset = chunkOffset + received;
+
+	co_return received;
+}
 
 } // namespace detail
 
@@ -217,6 +293,87 @@ async::result<frg::expected<protocols::fs::Error, size_t>> doPwrite(void *object
 	co_return co_await detail::doWriteImpl(inode.get(), buffer, length, false, unsignedOffset);
 }
 
+// The *Range() variants below let the server transfer file contents directly
+// from/to the inode's memory object. The transfer runs with the file's mutex held
+// such that the offset only advances by the transferred length.
+
+template <FileSystem T>
+async::result<frg::expected<protocols::fs::Error, size_t>> doReadRange(void *object,
+		helix_ng::CredentialsView, size_t length, async::cancellation_token cancellation,
+		protocols::fs::MemoryRangeTransfer transfer) {
+	using File = typename T::File;
+	using Inode = typename T::Inode;
+
+	auto self = static_cast<File *>(object);
+	auto inode = std::static_pointer_cast<Inode>(self->inode);
+
+	co_await self->mutex.async_lock();
+	frg::unique_lock lock{frg::adopt_lock, self->mutex};
+
+	// Do not start the transfer if the request was cancelled while we waited for the mutex.
+	if (cancellation.is_cancellation_requested())
+		co_return protocols::fs::Error::interrupted;
+
+	co_return co_await detail::doReadRangeImpl(inode.get(), length, self->offset, transfer);
+}
+
+template <FileSystem T>
+async::result<frg::expected<protocols::fs::Error, size_t>> doPreadRange(void *object,
+		int64_t offset, helix_ng::CredentialsView, size_t length,
+		protocols::fs::MemoryRangeTransfer transfer) {
+	using File = typename T::File;
+	using Inode = typename T::Inode;
+
+	if (offset < 0)
+		co_return protocols::fs::Error::illegalArguments;
+	size_t unsignedOffset = offset;
+
+	auto self = static_cast<File *>(object);
+	auto inode = std::static_pointer_cast<Inode>(self->inode);
+
+	co_await self->mutex.async_lock_shared();
+	frg::shared_lock lock{frg::adopt_lock, self->mutex};
+
+	co_return co_await detail::doReadRangeImpl(inode.get(), length, unsignedOffset, transfer);
+}
+
+template <FileSystem T>
+async::result<frg::expected<protocols::fs::Error, size_t>> doWriteRange(void *object,
+		helix_ng::CredentialsView, size_t length, protocols::fs::MemoryRangeTransfer transfer) {
+	using File = typename T::File;
+	using Inode = typename T::Inode;
+
+	auto self = static_cast<File *>(object);
+	auto inode = std::static_pointer_cast<Inode>(self->inode);
+
+	co_await self->mutex.async_lock();
+	frg::unique_lock lock{frg::adopt_lock, self->mutex};
+
+	co_return co_await detail::doWriteRangeImpl(inode.get(), length, self->append, self->offset,
+			transfer);
+}
+
+template <FileSystem T>
+async::result<frg::expected<protocols::fs::Error, size_t>> doPwriteRange(void *object,
+		int64_t offset, helix_ng::CredentialsView, size_t length,
+		protocols::fs::MemoryRangeTransfer transfer) {
+	using File = typename T::File;
+	using Inode = typename T::Inode;
+
+	if (offset < 0)
+		co_return protocols::fs::Error::illegalArguments;
+	size_t unsignedOffset = offset;
+
+	auto self = static_cast<File *>(object);
+	auto inode = std::static_pointer_cast<Inode>(self->inode);
+
+	co_await self->mutex.async_lock_shared();
+	frg::shared_lock lock{frg::adopt_lock, self->mutex};
+
+	co_return co_await detail::doWriteRangeImpl(inode.get(), length, false, unsignedOffset,
+			transfer);
+}
+
 template <FileSystem T>
 async::result<frg::expected<protocols::fs::Error>> doTruncate(void *object, size_t size) {
 	using File = typename T::File;
@@ -312,6 +312,10 @@ constinit protocols::fs::FileOperations fileOperations {
 	.pread        = &doPread<FileSystem>,
 	.write        = &doWrite<FileSystem>,
 	.pwrite       = &doPwrite<FileSystem>,
+	.readRange    = &doReadRange<FileSystem>,
+	.preadRange   = &doPreadRange<FileSystem>,
+	.writeRange   = &doWriteRange<FileSystem>,
+	.pwriteRange  = &doPwriteRange<FileSystem>,
 	.readEntries  = &readEntries,
 	.accessMemory = &doAccessMemory<FileSystem>,
 	.truncate     = &doTruncate<FileSystem>,
@@ -362,6 +362,16 @@ extern inline __attribute__ (( always_inline )) HelError helSubmitAwaitClock(uin
 	return error;
 };
 
+extern inline __attribute__ (( always_inline )) HelError helSubmitAwaitClockWithSlack(
+		uint64_t counter, uint64_t slack, HelHandle queue, uintptr_t context,
+		uint64_t *async_id) {
+	HelWord async_word;
+	HelError error = helSyscall4_1(kHelCallSubmitAwaitClockWithSlack, (HelWord)counter,
+			(HelWord)slack, (HelWord)queue, (HelWord)context, &async_word);
+	*async_id = (uint64_t)async_word;
+	return error;
+};
+
 extern inline __attribute__ (( always_inline )) HelError helCreateStream(HelHandle *lane1,
 		HelHandle *lane2, uint32_t attach_credentials) {
 	HelWord out_lane1;
@@ -393,6 +403,21 @@ extern inline __attribute__ (( always_inline )) HelError helFutexWake(int *point
 	return helSyscall1(kHelCallFutexWake, (HelWord)pointer);
 };
 
+extern inline __attribute__ (( always_inline )) HelError helFutexWakeSome(int *pointer,
+		unsigned int count, unsigned int *woken) {
+	HelWord woken_word;
+	HelError error = helSyscall2_1(kHelCallFutexWakeSome, (HelWord)pointer,
+			(HelWord)count, &woken_word);
+	*woken = (unsigned int)woken_word;
+	return error;
+};
+
+extern inline __attribute__ (( always_inline )) HelError helFutexRequeue(int *pointer,
+		int expected, int *target, unsigned int wakeCount, unsigned int requeueCount) {
+	return helSyscall5(kHelCallFutexRequeue, (HelWord)pointer, (HelWord)expected,
+			(HelWord)target, (HelWord)wakeCount, (HelWord)requeueCount);
+};
+
 extern inline __attribute__ (( always_inline )) HelError helCreateOneshotEvent(HelHandle *handle) {
 	HelWord handle_word;
 	HelError error = helSyscall0_1(kHelCallCreateOneshotEvent, &handle_word);
@@ -18,7 +18,7 @@
 
 enum {
 	// largest system call number plus 1
-	kHelNumCalls = 105,
+	kHelNumCalls = 108,
 
 	kHelCallLog = 1,
 	kHelCallPanic = 10,
@@ -73,6 +73,7 @@ enum {
 	kHelCallWriteFsBase = 41,
 	kHelCallGetClock = 42,
 	kHelCallSubmitAwaitClock = 80,
+	kHelCallSubmitAwaitClockWithSlack = 107,
 	kHelCallCreateVirtualizedCpu = 37,
 	kHelCallRunVirtualizedCpu = 38,
 	kHelCallGetRandomBytes = 101,
@@ -87,6 +88,8 @@ enum {
 
 	kHelCallFutexWait = 73,
 	kHelCallFutexWake = 71,
+	kHelCallFutexWakeSome = 105,
+	kHelCallFutexRequeue = 106,
 
 	kHelCallCreateOneshotEvent = 96,
 	kHelCallCreateBitsetEvent = 97,
@@ -180,7 +183,10 @@ enum {
 	kHelNullHandle = 0,
 	kHelThisUniverse = -1,
 	kHelThisThread = -2,
-	kHelZeroMemory = -3
+	kHelZeroMemory = -3,
+	//! Read-only page that contains a ::HelClockPage.
+	//! Can be mapped using ::helMapMemory.
+	kHelClockMemory = -4
 };
 
 enum {
@@ -203,7 +209,9 @@ enum {
 	kHelActionRecvInline = 7,
 	kHelActionRecvToBuffer = 3,
 	kHelActionPushDescriptor = 2,
-	kHelActionPullDescriptor = 4
+	kHelActionPullDescriptor = 4,
+	kHelActionSendFromMemory = 12,
+	kHelActionRecvToMemory = 13
 };
 
 enum {
@@ -229,6 +237,8 @@ struct HelAction {
 	void *buffer;
 	size_t length;
 	HelHandle handle;
+	// Offset into the memory object for kHelActionSendFromMemory and kHelActionRecvToMemory.
+	uintptr_t offset;
 };
 
 struct HelDescriptorInfo {
@@ -238,10 +248,15 @@ struct HelDescriptorInfo {
 enum HelAllocFlags {
 	kHelAllocContinuous = 4,
 	kHelAllocOnDemand = 1,
+	//! Prefer memory from HelAllocRestrictions::numaNode.
+	kHelAllocNumaNode = 8,
 };
 
 struct HelAllocRestrictions {
 	int addressBits;
+	//! Preferred NUMA node; only read if kHelAllocNumaNode is passed.
+	//! The kernel falls back to other nodes if the node is out of memory.
+	int numaNode;
 };
 
 enum HelManagedFlags {
@@ -260,7 +275,15 @@ enum HelMapFlags {
 	kHelMapProtExecute = 1024,
 	kHelMapDontRequireBacking = 128,
 	kHelMapFixed = 2048,
-	kHelMapFixedNoReplace = 4096
+	kHelMapFixedNoReplace = 4096,
+	// Disables mapping of resident neighbouring pages on read faults.
+	kHelMapNoFaultAround = 8192,
+	// Bits 16 to 19 hold the order n of the fault-around window: read faults map up to
+	// 2^n resident pages around the faulting page. Zero selects the default window
+	// of 16 pages. Orders above kHelMapMaxFaultAroundOrder are rejected.
+	kHelMapFaultAroundMask = 0xF0000,
+	kHelMapFaultAroundShift = 16,
+	kHelMapMaxFaultAroundOrder = 9
 };
 
 enum HelSliceFlags {
@@ -498,6 +521,26 @@ struct HelChunk {
 	char buffer[];
 };
 
+enum HelClockSource {
+	//! The clock cannot be read from user space; use ::helGetClock instead.
+	kHelClockSourceNone = 0,
+	//! The clock is derived from the CPU's timestamp counter
+	//! (rdtsc on x86_64, cntvct_el0 on aarch64, rdtime on riscv64).
+	kHelClockSourceCounter = 1
+};
+
+//! Parameters to read the system-wide monotone clock (see ::helGetClock) without a syscall.
+//! With kHelClockSourceCounter, the clock in nanoseconds is (counter * multiplier) >> shift,
+//! where the multiplication is done in 128 bits.
+//! Readers must retry if seqlock is odd or changes while the page is read.
+struct HelClockPage {
+	uint64_t seqlock;
+	//! One of the ::HelClockSource values.
+	uint32_t source;
+	uint32_t shift;
+	uint64_t multiplier;
+};
+
 //! A single element of a HelQueue.
 struct HelElement {
 	//! Length of the element in bytes.
@@ -702,6 +745,7 @@ HEL_C_LINKAGE HelError helCancelAsync(HelHandle queueHandle, uint64_t asyncId);
 //! @param[in] restrictions
 //!    	Specifies restrictions for the kernel's memory allocator.
 //!    	May be @p NULL if there are no restrictions.
+//!    	By default, memory is allocated from the NUMA node of the faulting CPU.
 //! @param[out] handle
 //!    	Handle to the new memory object.
 HEL_C_LINKAGE HelError helAllocateMemory(size_t size, uint32_t flags,
@@ -1020,6 +1064,9 @@ HEL_C_LINKAGE HelError helGetCurrentCpu(int *cpu);
 
 //! Read the system-wide monotone clock.
 //!
+//! The clock can also be read without a syscall via the page
+//! mapped from ::kHelClockMemory (see ::HelClockPage).
+//!
 //! @param[out] counter
 //!     Current value of the system-wide clock in nanoseconds since boot.
 HEL_C_LINKAGE HelError helGetClock(uint64_t *counter);
@@ -1034,6 +1081,21 @@ HEL_C_LINKAGE HelError helGetClock(uint64_t *counter);
 HEL_C_LINKAGE HelError helSubmitAwaitClock(uint64_t counter,
 		HelHandle queue, uintptr_t context, uint64_t *asyncId);
 
+//! Wait until time passes, allowing the kernel to delay the wakeup.
+//!
+//! Like ::helSubmitAwaitClock but the operation may complete up to
+//! @p slack nanoseconds after @p counter. The kernel uses this to serve
+//! multiple timers by a single timer interrupt.
+//! This is an asynchronous operation.
+//! @param[in] counter
+//!     Deadline (absolute, see ::helGetClock).
+//! @param[in] slack
+//!     Maximal delay (in nanoseconds) after the deadline.
+//! @param[out] asyncId
+//!     ID to identify the asynchronous operation (absolute, see ::helCancelAsync).
+HEL_C_LINKAGE HelError helSubmitAwaitClockWithSlack(uint64_t counter, uint64_t slack,
+		HelHandle queue, uintptr_t context, uint64_t *asyncId);
+
 HEL_C_LINKAGE HelError helCreateVirtualizedCpu(HelHandle handle, HelHandle *out_handle);
 
 HEL_C_LINKAGE HelError helRunVirtualizedCpu(HelHandle handle, struct HelVmexitReason *reason);
@@ -1113,6 +1175,36 @@ HEL_C_LINKAGE HelError helFutexWait(int *pointer, int expected, int64_t deadline
 //!     Pointer that identifies the futex.
 HEL_C_LINKAGE HelError helFutexWake(int *pointer);
 
+//! Wakes up a limited number of waiters of a futex.
+//!
+//! Waiters are woken in the order in which they started to wait.
+//! @param[in] pointer
+//!     Pointer that identifies the futex.
+//! @param[in] count
+//!     Maximal number of waiters to wake up.
+//! @param[out] woken
+//!     Number of waiters that were woken up.
+HEL_C_LINKAGE HelError helFutexWakeSome(int *pointer, unsigned int count,
+		unsigned int *woken);
+
+//! Wakes up waiters of a futex and moves other waiters to a second futex.
+//!
+//! This is useful to implement condition variable broadcasts: only one waiter
+//! is woken up and the remaining waiters are moved to the mutex.
+//! @param[in] pointer
+//!     Pointer that identifies the futex.
+//! @param[in] expected
+//!     Expected value of the futex. This function fails with
+//!     ::kHelErrIllegalState unless the futex pointed to by @pointer matches this value.
+//! @param[in] target
+//!     Pointer that identifies the futex that waiters are moved to.
+//! @param[in] wakeCount
+//!     Maximal number of waiters to wake up.
+//! @param[in] requeueCount
+//!     Maximal number of waiters to move to @p target.
+HEL_C_LINKAGE HelError helFutexRequeue(int *pointer, int expected, int *target,
+		unsigned int wakeCount, unsigned int requeueCount);
+
 //! @}
 //! @name Event Handling
 //! @{
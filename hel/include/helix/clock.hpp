@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace helix {
+
+// Returns the system-wide monotone clock in nanoseconds since boot (see helGetClock()).
+// If the kernel exports the clock parameters via kHelClockMemory,
+// the clock is read without a syscall.
+uint64_t getClockNanos();
+
+} // namespace helix
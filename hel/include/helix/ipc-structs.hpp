@@ -477,6 +477,18 @@ struct RecvBuffer {
 	size_t size;
 };
 
+struct SendFromMemory {
+	HelHandle handle;
+	uintptr_t offset;
+	size_t size;
+};
+
+struct RecvToMemory {
+	HelHandle handle;
+	uintptr_t offset;
+	size_t size;
+};
+
 struct RecvInline { };
 
 struct PushDescriptor {
@@ -568,6 +580,15 @@ inline auto recvBuffer(void *data, size_t length) {
 	return RecvBuffer{data, length};
 }
 
+// Sends (receives) a range of a memory object without copying it through our address space.
+inline auto sendFromMemory(BorrowedDescriptor memory, uintptr_t offset, size_t length) {
+	return SendFromMemory{memory.getHandle(), offset, length};
+}
+
+inline auto recvToMemory(BorrowedDescriptor memory, uintptr_t offset, size_t length) {
+	return RecvToMemory{memory.getHandle(), offset, length};
+}
+
 inline auto recvInline() {
 	return RecvInline{};
 }
@@ -707,6 +728,28 @@ inline auto createActionsArrayFor(bool chain, const RecvBuffer &item) {
 	return frg::array<HelAction, 1>{action};
 }
 
+inline auto createActionsArrayFor(bool chain, const SendFromMemory &item) {
+	HelAction action{};
+	action.type = kHelActionSendFromMemory;
+	action.flags = chain ? kHelItemChain : 0;
+	action.length = item.size;
+	action.handle = item.handle;
+	action.offset = item.offset;
+
+	return frg::array<HelAction, 1>{action};
+}
+
+inline auto createActionsArrayFor(bool chain, const RecvToMemory &item) {
+	HelAction action{};
+	action.type = kHelActionRecvToMemory;
+	action.flags = chain ? kHelItemChain : 0;
+	action.length = item.size;
+	action.handle = item.handle;
+	action.offset = item.offset;
+
+	return frg::array<HelAction, 1>{action};
+}
+
 inline auto createActionsArrayFor(bool chain, const RecvInline &) {
 	HelAction action{};
 	action.type = kHelActionRecvInline;
@@ -802,6 +845,14 @@ inline auto resultTypeTuple(const RecvBuffer &) {
 	return frg::tuple<RecvBufferResult>{};
 }
 
+inline auto resultTypeTuple(const SendFromMemory &) {
+	return frg::tuple<SendBufferResult>{};
+}
+
+inline auto resultTypeTuple(const RecvToMemory &) {
+	return frg::tuple<RecvBufferResult>{};
+}
+
 inline auto resultTypeTuple(const RecvInline &) {
 	return frg::tuple<RecvInlineResult>{};
 }
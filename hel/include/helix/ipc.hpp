@@ -1,6 +1,8 @@
 #pragma once
 
 #include <assert.h>
+#include <stdint.h>
+#include <algorithm>
 #include <tuple>
 #include <array>
 
@@ -162,6 +164,16 @@ private:
 public:
 	static constexpr int sizeShift = 9;
 
+	static constexpr unsigned int defaultMaxSpins = 4096;
+
+	// Statistics about busy-polling, see enableBusyPolling().
+	struct PollingStats {
+		// Number of waits that were satisfied by busy-polling.
+		uint64_t spinHits = 0;
+		// Number of waits that blocked on the progress futex.
+		uint64_t futexSleeps = 0;
+	};
+
 	static Dispatcher &global();
 
 	Dispatcher()
@@ -200,6 +212,24 @@ public:
 		return _handle;
 	}
 
+	// Opt-in: busy-poll for new elements before blocking on the progress futex.
+	// The spin budget adapts between maxSpins / 16 and maxSpins: it doubles when
+	// polling finds an element and halves when we have to block anyway.
+	// This trades CPU time for latency; it is meant for servers on dedicated cores.
+	void enableBusyPolling(unsigned int maxSpins = defaultMaxSpins) {
+		_maxSpins = maxSpins;
+		_spinBudget = maxSpins;
+	}
+
+	void disableBusyPolling() {
+		_maxSpins = 0;
+		_spinBudget = 0;
+	}
+
+	const PollingStats &pollingStats() const {
+		return _pollingStats;
+	}
+
 	void wait() {
 		while(true) {
 			// TODO: Initialize all chunks when setting up the queue.
@@ -292,10 +322,49 @@ private:
 		}
 	}
 
+	bool _hasProgress(int futex) {
+		return _lastProgress != (futex & kHelProgressMask) || (futex & kHelProgressDone);
+	}
+
+	static void _relaxCpu() {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__)
+		asm volatile ("yield");
+#elif defined(__riscv)
+		asm volatile (".insn i 0x0F, 0, x0, x0, 0x010"); // pause (Zihintpause).
+#endif
+	}
+
+	// Returns true if the progress futex advanced within the spin budget.
+	bool _spinOnProgressFutex() {
+		for(unsigned int i = 0; i < _spinBudget; ++i) {
+			auto futex = __atomic_load_n(&_retrieveChunk()->progressFutex, __ATOMIC_ACQUIRE);
+			if(_hasProgress(futex))
+				return true;
+			_relaxCpu();
+		}
+		return false;
+	}
+
 	void _waitProgressFutex(bool *done) {
+		bool spun = false;
+		bool slept = false;
 		while(true) {
 			auto futex = __atomic_load_n(&_retrieveChunk()->progressFutex, __ATOMIC_ACQUIRE);
 			assert(!(futex & ~(kHelProgressMask | kHelProgressWaiters | kHelProgressDone)));
+
+			// Busy-poll before setting the waiters bit. As long as the bit is clear,
+			// the kernel also does not need to issue a futex wake-up.
+			if(_spinBudget && !spun && !_hasProgress(futex)) {
+				spun = true;
+				if(_spinOnProgressFutex()) {
+					_pollingStats.spinHits++;
+					_spinBudget = std::min(_spinBudget * 2, _maxSpins);
+				}
+				continue;
+			}
+
 			do {
 				if(_lastProgress != (futex & kHelProgressMask)) {
 					*done = false;
@@ -311,6 +380,12 @@ private:
 						_lastProgress | kHelProgressWaiters,
 						false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
 
+			if(!slept) {
+				_pollingStats.futexSleeps++;
+				if(spun)
+					_spinBudget = std::max(_spinBudget / 2, std::max(_maxSpins / 16, 1u));
+				slept = true;
+			}
 			HEL_CHECK(helFutexWait(&_retrieveChunk()->progressFutex,
 					_lastProgress | kHelProgressWaiters, -1));
 		}
@@ -333,6 +408,11 @@ private:
 
 	// Per-chunk reference counts.
 	int _refCounts[16];
+
+	// Busy-polling state, see enableBusyPolling().
+	unsigned int _maxSpins = 0;
+	unsigned int _spinBudget = 0;
+	PollingStats _pollingStats;
 };
 
 inline void CurrentDispatcherToken::wait() {
@@ -461,6 +541,15 @@ struct Submission : private Context {
 		operation->setAsyncId(async_id);
 	}
 
+	Submission(AwaitClock *operation,
+			uint64_t counter, uint64_t slack, Dispatcher &dispatcher)
+	: _result(operation) {
+		uint64_t async_id;
+		HEL_CHECK(helSubmitAwaitClockWithSlack(counter, slack, dispatcher.acquire(),
+				reinterpret_cast<uintptr_t>(context()), &async_id));
+		operation->setAsyncId(async_id);
+	}
+
 	Submission(BorrowedDescriptor space, ProtectMemory *operation,
 			void *pointer, size_t length, uint32_t flags,
 			Dispatcher &dispatcher)
@@ -523,6 +612,11 @@ inline Submission submitAwaitClock(AwaitClock *operation, uint64_t counter,
 	return {operation, counter, dispatcher};
 }
 
+inline Submission submitAwaitClock(AwaitClock *operation, uint64_t counter,
+		uint64_t slack, Dispatcher &dispatcher) {
+	return {operation, counter, slack, dispatcher};
+}
+
 inline Submission submitProtectMemory(BorrowedDescriptor memory, ProtectMemory *operation,
 		void *pointer, size_t length, uint32_t flags,
 		Dispatcher &dispatcher) {
@@ -77,12 +77,14 @@ private:
 	TimeoutCallback<Functor> _tb;
 };
 
-inline async::result<bool> sleepFor(uint64_t duration, async::cancellation_token cancel = {}) {
+// The wakeup can be delayed by up to slack nanoseconds (see helSubmitAwaitClockWithSlack).
+inline async::result<bool> sleepFor(uint64_t duration, async::cancellation_token cancel = {},
+		uint64_t slack = 0) {
 	uint64_t tick;
 	HEL_CHECK(helGetClock(&tick));
 
 	helix::AwaitClock await;
-	auto &&submit = helix::submitAwaitClock(&await, tick + duration,
+	auto &&submit = helix::submitAwaitClock(&await, tick + duration, slack,
 			helix::Dispatcher::global());
 	auto async_id = await.asyncId();
 
@@ -100,9 +102,10 @@ inline async::result<bool> sleepFor(uint64_t duration, async::cancellation_token
 	co_return true;
 }
 
-inline async::result<bool> sleepUntil(uint64_t tick, async::cancellation_token cancelToken) {
+inline async::result<bool> sleepUntil(uint64_t tick, async::cancellation_token cancelToken,
+		uint64_t slack = 0) {
 	helix::AwaitClock await;
-	auto &&submit = helix::submitAwaitClock(&await, tick,
+	auto &&submit = helix::submitAwaitClock(&await, tick, slack,
 			helix::Dispatcher::global());
 	auto asyncId = await.asyncId();
 	{
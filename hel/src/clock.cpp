@@ -0,0 +1,77 @@
+#include <hel.h>
+#include <hel-syscalls.h>
+#include <helix/clock.hpp>
+
+namespace helix {
+
+namespace {
+
+const HelClockPage *mapClockPage() {
+	void *pointer;
+	if(helMapMemory(kHelClockMemory, kHelNullHandle, nullptr,
+			0, 0x1000, kHelMapProtRead, &pointer))
+		return nullptr;
+	return reinterpret_cast<const HelClockPage *>(pointer);
+}
+
+const HelClockPage *clockPage() {
+	static const HelClockPage *page = mapClockPage();
+	return page;
+}
+
+uint64_t readCounter() {
+#if defined(__x86_64__)
+	uint32_t lsw, msw;
+	asm volatile ("lfence; rdtsc" : "=a"(lsw), "=d"(msw));
+	return (static_cast<uint64_t>(msw) << 32)
+			| static_cast<uint64_t>(lsw);
+#elif defined(__aarch64__)
+	uint64_t cnt;
+	asm volatile ("isb; mrs %0, cntvct_el0" : "=r"(cnt));
+	return cnt;
+#elif defined(__riscv)
+	uint64_t v;
+	asm volatile ("rdtime %0" : "=r"(v));
+	return v;
+#else
+#	error Unsupported architecture
+#endif
+}
+
+} // anonymous namespace
+
+uint64_t getClockNanos() {
+	if(auto page = clockPage(); page) {
+		while(true) {
+			// Start the seqlock read.
+			auto seqlock = __atomic_load_n(&page->seqlock, __ATOMIC_ACQUIRE);
+			if(seqlock & 1)
+				continue;
+
+			// Perform the actual loads.
+			auto source = __atomic_load_n(&page->source, __ATOMIC_RELAXED);
+			auto shift = __atomic_load_n(&page->shift, __ATOMIC_RELAXED);
+			auto multiplier = __atomic_load_n(&page->multiplier, __ATOMIC_RELAXED);
+
+			// Finish the seqlock read.
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if(__atomic_load_n(&page->seqlock, __ATOMIC_RELAXED) != seqlock)
+				continue;
+
+			if(source != kHelClockSourceCounter)
+				break;
+
+			// This matches the kernel's computation (including the saturation).
+			auto product = (static_cast<unsigned __int128>(readCounter()) * multiplier) >> shift;
+			if(product >> 64)
+				return UINT64_MAX;
+			return static_cast<uint64_t>(product);
+		}
+	}
+
+	uint64_t nanos;
+	HEL_CHECK(helGetClock(&nanos));
+	return nanos;
+}
+
+} // namespace helix
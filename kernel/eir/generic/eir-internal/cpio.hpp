@@ -28,7 +28,7 @@ struct CpioFile {
 
 struct CpioRange {
 	struct Iterator {
-		Iterator(void *ptr) : ptr_{static_cast<uint8_t *>(ptr)} {}
+		Iterator(void *ptr) : ptr_{static_cast<uint8_t *>(ptr)} { skipPadding(); }
 
 		Iterator &operator++() {
 			next();
@@ -59,6 +59,13 @@ struct CpioRange {
 			return v;
 		}
 
+		// gen-initrd.py inserts NUL padding in front of headers to page-align file data.
+		// Headers are 4-byte aligned and always start with a non-zero magic.
+		void skipPadding() {
+			while (!ptr_[0] && !ptr_[1] && !ptr_[2] && !ptr_[3])
+				ptr_ += 4;
+		}
+
 		CpioFile parse() {
 			CpioHeader hdr;
 			memcpy(&hdr, ptr_, sizeof(CpioHeader));
@@ -89,8 +96,14 @@ struct CpioRange {
 			auto nameSize = parseHex(hdr.nameSize, 8);
 			auto fileSize = parseHex(hdr.fileSize, 8);
 
+			frg::string_view path{
+			    reinterpret_cast<char *>(ptr_) + sizeof(CpioHeader), nameSize - 1
+			};
 			ptr_ += ((sizeof(CpioHeader) + nameSize + 3) & ~uint32_t{3})
 			        + ((fileSize + 3) & ~uint32_t{3});
+			// Do not skip past the trailer: the archive is followed by unrelated memory.
+			if (path != "TRAILER!!!")
+				skipPadding();
 		}
 
 		uint8_t *ptr_;
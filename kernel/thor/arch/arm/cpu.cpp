@@ -264,6 +264,15 @@ void initializeThisProcessor() {
 	asm volatile("mrs %0, mpidr_el1" : "=r"(mpidr));
 	cpu_data->affinity = (mpidr & 0xFFFFFF) | (mpidr >> 32 & 0xFF) << 24;
 
+	// If MPIDR_EL1.MT is set, Aff0 identifies threads within a core.
+	// Otherwise, Aff0 identifies cores and Aff1 identifies clusters.
+	if(mpidr & (uint64_t(1) << 24)) {
+		cpu_data->coreId = cpu_data->affinity >> 8;
+		cpu_data->packageId = cpu_data->affinity >> 16;
+	}else{
+		cpu_data->packageId = cpu_data->affinity >> 8;
+	}
+
 	cpu_data->irqStack = UniqueKernelStack::make();
 	cpu_data->detachedStack = UniqueKernelStack::make();
 	cpu_data->idleStack = UniqueKernelStack::make();
@@ -42,6 +42,20 @@ void sendShootdownIpi() {
 	);
 }
 
+void sendShootdownIpi(CpuData *dstData) {
+	std::visit(
+	    frg::overloaded{
+	        [](std::monostate) {
+		        panicLogger() << "thor: Cannot send IPIs without an IRQ controller" << frg::endlog;
+		        __builtin_unreachable();
+	        },
+	        [&](GicV2 *gic) { gic->sendIpi(dstData->cpuIndex, 1); },
+	        [&](GicV3 *gic) { gic->sendIpi(dstData->cpuIndex, 1); },
+	    },
+	    externalIrq
+	);
+}
+
 void sendSelfCallIpi() {
 	auto *dstData = getCpuData();
 	std::visit(
@@ -1,6 +1,9 @@
+#include <string.h>
+#include <initgraph.hpp>
 #include <thor-internal/arch-generic/paging.hpp>
 #include <thor-internal/arch/ints.hpp>
 #include <arch/variable.hpp>
+#include <thor-internal/main.hpp>
 #include <thor-internal/physical.hpp>
 #include <thor-internal/mm-rc.hpp>
 #include <thor-internal/cpu-data.hpp>
@@ -49,6 +52,40 @@ void switchToPageTable(PhysicalAddr root, int asid, bool invalidate) {
 
 namespace {
 
+// Size of the blocks that DC ZVA zeroes, or zero if DC ZVA is prohibited.
+constinit size_t dczvaBlockSize = 0;
+
+initgraph::Task selectPageOpsTask{&globalInitEngine, "arm.select-page-ops",
+	[] {
+		uint64_t dczid;
+		asm volatile ("mrs %0, dczid_el0" : "=r"(dczid));
+		// DZP (bit 4) prohibits DC ZVA; BS (bits 3:0) is the log2 of the block size in words.
+		if(!(dczid & (1 << 4)))
+			dczvaBlockSize = size_t{4} << (dczid & 0xF);
+	}
+};
+
+} // namespace anonymous
+
+void copyPage(void *dest, const void *src) {
+	memcpy(dest, src, kPageSize);
+}
+
+void zeroPage(void *dest) {
+	auto blockSize = dczvaBlockSize;
+	if(!blockSize || blockSize > kPageSize) {
+		memset(dest, 0, kPageSize);
+		return;
+	}
+
+	// DC ZVA zeroes a whole block without reading it into the cache first.
+	auto p = reinterpret_cast<uintptr_t>(dest);
+	for(size_t off = 0; off < kPageSize; off += blockSize)
+		asm volatile ("dc zva, %0" : : "r"(p + off) : "memory");
+}
+
+namespace {
+
 PhysicalAddr nullTable = PhysicalAddr(-1);
 
 } // namespace anonymous
@@ -39,6 +39,11 @@ uint64_t getClockNanos() {
 	return timerInverseFreq * getRawTimestampCounter();
 }
 
+frg::optional<FreqFraction> getUserCounterInverseFreq() {
+	// EL0 access to cntvct_el0 is enabled by initTimerOnThisCpu().
+	return timerInverseFreq;
+}
+
 void setTimerDeadline(frg::optional<uint64_t> deadline) {
 	if (deadline) {
 		uint64_t rawDeadline = timerFreq * *deadline;
@@ -119,6 +124,13 @@ bool haveTimer() {
 
 // Sets up the proper interrupt trigger and polarity for the PPI
 void initTimerOnThisCpu() {
+	// Allow EL0 to read the virtual counter (EL0VCTEN) such that user space
+	// can read the clock without a syscall (see getUserCounterInverseFreq()).
+	uint64_t cntkctl;
+	asm volatile ("mrs %0, cntkctl_el1" : "=r"(cntkctl));
+	asm volatile ("msr cntkctl_el1, %0" :: "r"(cntkctl | (uint64_t{1} << 1)));
+	asm volatile ("isb" ::: "memory");
+
 	auto sink = frg::construct<GenericTimerSink>(*kernelAlloc);
 	auto pin = timerIrqParent->resolveDtIrq(*timerIrq);
 	IrqPin::attachSink(pin, sink);
@@ -1,5 +1,7 @@
+#include <string.h>
 #include <arch/variable.hpp>
 #include <riscv/csr.hpp>
+#include <thor-internal/arch-generic/paging.hpp>
 #include <thor-internal/arch/ints.hpp>
 #include <thor-internal/arch/paging.hpp>
 #include <thor-internal/arch/unimplemented.hpp>
@@ -43,6 +45,14 @@ void invalidatePage(int asid, const void *address) {
 	asm volatile("sfence.vma" : : : "memory"); // This is too coarse (also invalidates global).
 }
 
+void copyPage(void *dest, const void *src) {
+	memcpy(dest, src, kPageSize);
+}
+
+void zeroPage(void *dest) {
+	memset(dest, 0, kPageSize);
+}
+
 void initializeAsidContext(CpuData *cpuData) {
 	auto irqLock = frg::guard(&irqMutex());
 
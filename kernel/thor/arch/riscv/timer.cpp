@@ -102,6 +102,11 @@ uint64_t getRawTimestampCounter() {
 
 uint64_t getClockNanos() { return inverseFreq * getRawTimestampCounter(); }
 
+frg::optional<FreqFraction> getUserCounterInverseFreq() {
+	// TODO: Set scounteren.TM to allow U-mode to execute rdtime.
+	return frg::null_opt;
+}
+
 void setTimerDeadline(frg::optional<uint64_t> deadline) {
 	assert(!intsAreEnabled());
 
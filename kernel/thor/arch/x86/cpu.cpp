@@ -420,6 +420,15 @@ static initgraph::Task enumerateCpuFeaturesTask{&globalInitEngine, "x86.enumerat
 					<< frg::endlog;
 		}
 
+		if(common::x86::cpuid(0x07)[1] & (1 << 9)) {
+			debugLogger() << "thor: CPUs support enhanced rep movsb/stosb"
+					<< frg::endlog;
+			globalCpuFeatures.haveErms = true;
+		}else{
+			debugLogger() << "thor: CPUs do not support enhanced rep movsb/stosb!"
+					<< frg::endlog;
+		}
+
 		auto intelPmLeaf = common::x86::cpuid(0xA)[0];
 		if(intelPmLeaf & 0xFF) {
 			debugLogger() << "thor: CPUs support Intel performance counters"
@@ -557,9 +566,46 @@ static initgraph::Task initBootProcessorTask{&globalInitEngine, "x86.init-boot-p
 	}
 };
 
+namespace {
+
+// Determines SMT siblings and packages from the x2APIC ID topology (CPUID leaf 0xB).
+void detectTopology(CpuData *cpuData) {
+	if(common::x86::cpuid(0)[0] < 0xB)
+		return;
+
+	unsigned int smtShift = 0;
+	unsigned int coreShift = 0;
+	bool haveSmtLevel = false;
+	bool haveCoreLevel = false;
+	uint32_t x2apicId = 0;
+	for(uint32_t level = 0; level < 8; ++level) {
+		auto regs = common::x86::cpuid(0xB, level);
+		auto type = (regs[2] >> 8) & 0xFF;
+		if(!type)
+			break;
+		x2apicId = regs[3];
+		if(type == 1) {
+			smtShift = regs[0] & 0x1F;
+			haveSmtLevel = true;
+		}else if(type == 2) {
+			coreShift = regs[0] & 0x1F;
+			haveCoreLevel = true;
+		}
+	}
+	if(!haveSmtLevel || !haveCoreLevel)
+		return;
+
+	cpuData->coreId = x2apicId >> smtShift;
+	cpuData->packageId = x2apicId >> coreShift;
+}
+
+} // anonymous namespace
+
 void initializeThisProcessor() {
 	auto cpuData = getCpuData();
 
+	detectTopology(cpuData);
+
 	// Allocate per-CPU areas.
 	cpuData->irqStack = UniqueKernelStack::make();
 	cpuData->dfStack = UniqueKernelStack::make();
@@ -796,6 +842,7 @@ void bootSecondary(unsigned int apic_id) {
 	prepareCpuDataFor(context, cpuNr);
 
 	context->localApicId = apic_id;
+	context->numaNode = getNumaNodeOfPlatformCpu(apic_id);
 	context->localLogRing = frg::construct<ReentrantRecordRing>(*kernelAlloc);
 
 	// Participate in global TLB invalidation *before* paging is used by the target CPU.
@@ -5,6 +5,7 @@
 #include <thor-internal/arch-generic/cpu.hpp>
 #include <thor-internal/arch/pmc-amd.hpp>
 #include <thor-internal/arch/pmc-intel.hpp>
+#include <thor-internal/arch/paging.hpp>
 #include <thor-internal/arch/system.hpp>
 #include <thor-internal/arch/pic.hpp>
 
@@ -554,6 +555,111 @@ namespace {
 			}
 		}
 	}
+
+	// Reads a word from the current address space without ever faulting.
+	// Since we cannot handle page faults in NMI context, we walk the page tables
+	// (starting at CR3) instead of dereferencing the address directly.
+	bool peekWord(uintptr_t address, bool user, uint64_t &word) {
+		if(address & (sizeof(uint64_t) - 1))
+			return false;
+		if(user && address >= 0x8000'0000'0000)
+			return false;
+
+		uint64_t cr3;
+		asm volatile ("mov %%cr3, %0" : "=r"(cr3));
+
+		PhysicalAddr table = cr3 & pteAddress;
+		for(int level = 3; level >= 0; level--) {
+			auto shift = 12 + 9 * level;
+			PageAccessor accessor{table};
+			auto pte = __atomic_load_n(reinterpret_cast<uint64_t *>(accessor.get())
+					+ ((address >> shift) & 0x1FF), __ATOMIC_RELAXED);
+			if(!(pte & ptePresent))
+				return false;
+			if(user && !(pte & pteUser))
+				return false;
+			if(level && !(pte & ptePageSize)) {
+				table = pte & pteAddress;
+				continue;
+			}
+
+			// Do not touch uncached pages; they might be MMIO.
+			if(pte & (ptePwt | ptePcd))
+				return false;
+			auto pageMask = (uintptr_t{1} << shift) - 1;
+			auto physical = (pte & pteAddress & ~pageMask) | (address & pageMask);
+			word = *reinterpret_cast<uint64_t *>(directPhysicalOffset() + physical);
+			return true;
+		}
+		__builtin_unreachable();
+	}
+
+	// Follows the chain of frame pointers, starting at the given IP and RBP.
+	size_t walkFramePointers(uintptr_t ip, uintptr_t rbp, bool user, uint64_t *frames) {
+		size_t n = 0;
+		frames[n++] = ip;
+		while(n < maxProfileFrames && rbp) {
+			// Kernel frames always live in the higher half, user frames in the lower half.
+			if(!user && rbp < 0xFFFF'8000'0000'0000)
+				break;
+			uint64_t nextRbp, returnIp;
+			if(!peekWord(rbp, user, nextRbp) || !peekWord(rbp + 8, user, returnIp))
+				break;
+			if(!returnIp)
+				break;
+			frames[n++] = returnIp;
+			// Stacks grow downwards; this guarantees that the walk terminates.
+			if(nextRbp <= rbp)
+				break;
+			rbp = nextRbp;
+		}
+		return n;
+	}
+
+	void recordProfileSample(CpuData *cpuData, NmiImageAccessor image) {
+		struct {
+			ProfileRecordHeader header;
+			uint64_t frames[2 * maxProfileFrames];
+		} record;
+		record.header.magic = profileRecordMagic;
+		record.header.threadId = 0;
+		record.header.universeId = 0;
+
+		size_t numKernelFrames = 0;
+		size_t numUserFrames = 0;
+		auto cs = *image.cs();
+		if(cs == kSelClientUserCode) {
+			numUserFrames = walkFramePointers(*image.ip(), *image.rbp(), true, record.frames);
+		}else if(cs == kSelClientUserCompat) {
+			// We do not unwind 32-bit code.
+			record.frames[0] = *image.ip();
+			numUserFrames = 1;
+		}else{
+#ifdef THOR_HAS_FRAME_POINTERS
+			numKernelFrames = walkFramePointers(*image.ip(), *image.rbp(), false, record.frames);
+#else
+			record.frames[0] = *image.ip();
+			numKernelFrames = 1;
+#endif
+		}
+		record.header.numKernelFrames = numKernelFrames;
+		record.header.numUserFrames = numUserFrames;
+
+		// activeThread is only meaningful if we interrupted the thread domain.
+		if(cs == kSelExecutorFaultCode || cs == kSelExecutorSyscallCode
+				|| cs == kSelClientUserCompat || cs == kSelClientUserCode) {
+			auto thread = cpuData->activeThread.get();
+			if(thread) {
+				record.header.threadId = thread->id();
+				auto universe = thread->getUniverse().get();
+				if(universe)
+					record.header.universeId = universe->id();
+			}
+		}
+
+		cpuData->localProfileRing->enqueue(&record, sizeof(ProfileRecordHeader)
+				+ (numKernelFrames + numUserFrames) * sizeof(uint64_t));
+	}
 }
 
 extern "C" void onPlatformNmi(NmiImageAccessor image) {
@@ -573,15 +679,13 @@ extern "C" void onPlatformNmi(NmiImageAccessor image) {
 	bool explained = false;
 	auto pmcMechanism = cpuData->profileMechanism.load(std::memory_order_acquire);
 	if(pmcMechanism == ProfileMechanism::intelPmc && checkIntelPmcOverflow()) {
-		uintptr_t ip = *image.ip();
-		cpuData->localProfileRing->enqueue(&ip, sizeof(uintptr_t));
+		recordProfileSample(cpuData, image);
 		// Note: on Intel, the PMI is automatically masked on raises.
 		LocalApicContext::clearPmi();
 		setIntelPmc();
 		explained = true;
 	}else if(pmcMechanism == ProfileMechanism::amdPmc && checkAmdPmcOverflow()) {
-		uintptr_t ip = *image.ip();
-		cpuData->localProfileRing->enqueue(&ip, sizeof(uintptr_t));
+		recordProfileSample(cpuData, image);
 		setAmdPmc();
 		explained = true;
 	}
@@ -1,10 +1,13 @@
 
 #include <arch/variable.hpp>
 #include <frg/list.hpp>
+#include <initgraph.hpp>
 #include <thor-internal/cpu-data.hpp>
+#include <thor-internal/main.hpp>
 #include <thor-internal/physical.hpp>
 #include <thor-internal/mm-rc.hpp>
 #include <thor-internal/arch-generic/paging.hpp>
+#include <thor-internal/arch/cpu.hpp>
 
 // --------------------------------------------------------
 // Physical page access.
@@ -67,6 +70,57 @@ void invalidatePage(int asid, const void *address) {
 	}
 }
 
+// --------------------------------------------------------
+// Page copy and zero primitives.
+// --------------------------------------------------------
+
+namespace {
+
+void copyPageMovsq(void *dest, const void *src) {
+	size_t count = kPageSize / sizeof(uint64_t);
+	asm volatile ("rep movsq" : "+D"(dest), "+S"(src), "+c"(count) : : "memory");
+}
+
+void zeroPageStosq(void *dest) {
+	size_t count = kPageSize / sizeof(uint64_t);
+	asm volatile ("rep stosq" : "+D"(dest), "+c"(count) : "a"(0) : "memory");
+}
+
+// With ERMS, the byte variants use the CPU's fast string microcode
+// (which moves full cache lines) for all sizes.
+void copyPageMovsb(void *dest, const void *src) {
+	size_t count = kPageSize;
+	asm volatile ("rep movsb" : "+D"(dest), "+S"(src), "+c"(count) : : "memory");
+}
+
+void zeroPageStosb(void *dest) {
+	size_t count = kPageSize;
+	asm volatile ("rep stosb" : "+D"(dest), "+c"(count) : "a"(0) : "memory");
+}
+
+constinit void (*copyPageImpl)(void *, const void *) = copyPageMovsq;
+constinit void (*zeroPageImpl)(void *) = zeroPageStosq;
+
+initgraph::Task selectPageOpsTask{&globalInitEngine, "x86.select-page-ops",
+	initgraph::Requires{getCpuFeaturesKnownStage()},
+	[] {
+		if(getGlobalCpuFeatures()->haveErms) {
+			copyPageImpl = copyPageMovsb;
+			zeroPageImpl = zeroPageStosb;
+		}
+	}
+};
+
+} // namespace anonymous
+
+void copyPage(void *dest, const void *src) {
+	copyPageImpl(dest, src);
+}
+
+void zeroPage(void *dest) {
+	zeroPageImpl(dest);
+}
+
 // --------------------------------------------------------
 // Kernel paging management.
 // --------------------------------------------------------
@@ -166,8 +220,11 @@ ClientPageSpace::~ClientPageSpace() {
 		PageAccessor accessor{ps};
 		auto tbl = reinterpret_cast<uint64_t *>(accessor.get());
 		for(int i = 0; i < 512; i++) {
-			if(tbl[i] & ptePresent)
-				physicalAllocator->free(tbl[i] & pteAddress, kPageSize);
+			if(!(tbl[i] & ptePresent))
+				continue;
+			// Large pages are removed when their mappings are unmapped.
+			assert(!(tbl[i] & ptePageSize));
+			physicalAllocator->free(tbl[i] & pteAddress, kPageSize);
 		}
 	};
 
@@ -325,6 +325,31 @@ uint64_t getClockNanos() {
 	}
 }
 
+frg::optional<FreqFraction> getUserCounterInverseFreq() {
+	// Without an invariant TSC, the system clock is driven by the HPET.
+	if(!getGlobalCpuFeatures()->haveInvariantTsc)
+		return frg::null_opt;
+	return apicContext.getFor(0).tscInverseFreq;
+}
+
+namespace {
+
+// Sends an IPI through the xAPIC ICR, which takes two separate MMIO writes.
+// IRQs must be disabled between the two writes: an IRQ handler that sends an IPI itself
+// (e.g., to wake up a thread on another CPU) would otherwise overwrite ICR-high.
+// x2APIC does not have this problem since it writes the full ICR with a single MSR access.
+void sendXapicIpi(arch::bit_value<uint32_t> high, arch::bit_value<uint32_t> low) {
+	auto irqLock = frg::guard(&irqMutex());
+
+	picBase.store(lApicIcrHigh, high);
+	picBase.store(lApicIcrLow, low);
+	while(picBase.load(lApicIcrLow) & apicIcrLowDelivStatus) {
+		// Wait for IPI delivery.
+	}
+}
+
+} // anonymous namespace
+
 void acknowledgeIpi() {
 	picBase.store(lApicEoi, 0);
 }
@@ -381,12 +406,19 @@ void sendShootdownIpi() {
 		picBase.store(lX2ApicIcr, x2apicIcrLowVector(0xF0) | x2apicIcrLowDelivMode(0)
 				| x2apicIcrLowLevel(true) | x2apicIcrLowShorthand(2) | x2apicIcrHighDestField(0));
 	} else {
-		picBase.store(lApicIcrHigh, apicIcrHighDestField(0));
-		picBase.store(lApicIcrLow, apicIcrLowVector(0xF0) | apicIcrLowDelivMode(0)
+		sendXapicIpi(apicIcrHighDestField(0), apicIcrLowVector(0xF0) | apicIcrLowDelivMode(0)
 				| apicIcrLowLevel(true) | apicIcrLowShorthand(2));
-		while(picBase.load(lApicIcrLow) & apicIcrLowDelivStatus) {
-			// Wait for IPI delivery.
-		}
+	}
+}
+
+void sendShootdownIpi(CpuData *dstData) {
+	auto apic = dstData->localApicId;
+	if(picBase.isUsingX2apic()) {
+		picBase.store(lX2ApicIcr, x2apicIcrLowVector(0xF0) | x2apicIcrLowDelivMode(0)
+				| x2apicIcrLowLevel(true) | x2apicIcrLowShorthand(0) | x2apicIcrHighDestField(apic));
+	} else {
+		sendXapicIpi(apicIcrHighDestField(apic), apicIcrLowVector(0xF0) | apicIcrLowDelivMode(0)
+				| apicIcrLowLevel(true) | apicIcrLowShorthand(0));
 	}
 }
 
@@ -397,12 +429,8 @@ void sendPingIpi(CpuData *dstData) {
 		picBase.store(lX2ApicIcr, x2apicIcrLowVector(0xF1) | x2apicIcrLowDelivMode(0)
 				| x2apicIcrLowLevel(true) | x2apicIcrLowShorthand(0) | x2apicIcrHighDestField(apic));
 	} else {
-		picBase.store(lApicIcrHigh, apicIcrHighDestField(apic));
-		picBase.store(lApicIcrLow, apicIcrLowVector(0xF1) | apicIcrLowDelivMode(0)
+		sendXapicIpi(apicIcrHighDestField(apic), apicIcrLowVector(0xF1) | apicIcrLowDelivMode(0)
 				| apicIcrLowLevel(true) | apicIcrLowShorthand(0));
-		while(picBase.load(lApicIcrLow) & apicIcrLowDelivStatus) {
-			// Wait for IPI delivery.
-		}
 	}
 }
 
@@ -413,12 +441,8 @@ void sendSelfCallIpi() {
 		picBase.store(lX2ApicIcr, x2apicIcrLowVector(vec) | x2apicIcrLowDelivMode(0)
 				| x2apicIcrLowLevel(true) | x2apicIcrLowShorthand(0) | x2apicIcrHighDestField(apic));
 	} else {
-		picBase.store(lApicIcrHigh, apicIcrHighDestField(apic));
-		picBase.store(lApicIcrLow, apicIcrLowVector(vec) | apicIcrLowDelivMode(0)
+		sendXapicIpi(apicIcrHighDestField(apic), apicIcrLowVector(vec) | apicIcrLowDelivMode(0)
 				| apicIcrLowLevel(true) | apicIcrLowShorthand(0));
-		while(picBase.load(lApicIcrLow) & apicIcrLowDelivStatus) {
-			// Wait for IPI delivery.
-		}
 	}
 }
 
@@ -287,6 +287,7 @@ struct NmiImageAccessor {
 	Word *ip() { return &_frame()->rip; }
 	Word *cs() { return &_frame()->cs; }
 	Word *rflags() { return &_frame()->rflags; }
+	Word *rbp() { return &_frame()->rbp; }
 
 private:
 	// note: this struct is accessed from assembly.
@@ -526,6 +527,7 @@ struct CpuFeatures {
 	bool haveZmm;
 	bool haveInvariantTsc;
 	bool haveTscDeadline;
+	bool haveErms;
 	bool haveVmx;
 	bool haveSvm;
 	uint32_t profileFlags;
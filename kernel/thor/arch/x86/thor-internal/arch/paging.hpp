@@ -20,6 +20,9 @@ constexpr uint64_t ptePwt = 0x8;
 constexpr uint64_t ptePcd = 0x10;
 constexpr uint64_t pteDirty = 0x40;
 constexpr uint64_t ptePat = 0x80;
+// In PDEs, bit 7 selects a large page and the PAT bit moves to bit 12.
+constexpr uint64_t ptePageSize = 0x80;
+constexpr uint64_t pteLargePat = 0x1000;
 constexpr uint64_t pteGlobal = 0x100;
 constexpr uint64_t pteXd = 0x8000000000000000;
 constexpr uint64_t pteAddress = 0x000F'FFFF'FFFF'F000;
@@ -100,12 +103,30 @@ struct X86CursorPolicy {
 		return pte;
 	}
 
+	static constexpr bool ptePageIsLarge(uint64_t pte) {
+		return (pte & ptePresent) && (pte & ptePageSize);
+	}
+
+	static constexpr uint64_t pteBuildLarge(PhysicalAddr physical, PageFlags flags, CachingMode cachingMode) {
+		auto pte = pteBuild(physical, flags, cachingMode);
+		if(pte & ptePat)
+			pte = (pte & ~ptePat) | pteLargePat;
+		return pte | ptePageSize;
+	}
+
+	static constexpr uint64_t pteSplitLarge(uint64_t pte, size_t index) {
+		auto smallPte = pte & ~(ptePageSize | pteLargePat);
+		if(pte & pteLargePat)
+			smallPte |= ptePat;
+		return smallPte + index * kPageSize;
+	}
+
 	static constexpr void pteWriteBarrier() { }
 	static constexpr void pteSyncICache(uintptr_t) { }
 
 
 	static constexpr bool pteTablePresent(uint64_t pte) {
-		return pte & ptePresent;
+		return (pte & ptePresent) && !(pte & ptePageSize);
 	}
 
 	static constexpr PhysicalAddr pteTableAddress(uint64_t pte) {
@@ -128,6 +149,7 @@ static_assert(CursorPolicy<KernelCursorPolicy>);
 
 using ClientCursorPolicy = X86CursorPolicy<false>;
 static_assert(CursorPolicy<ClientCursorPolicy>);
+static_assert(LargePageCursorPolicy<ClientCursorPolicy>);
 
 
 struct KernelPageSpace : PageSpace {
@@ -11,10 +11,16 @@ namespace thor {
 
 extern size_t kernelMemoryUsage;
 
+extern "C" int doCopyToUser(void *dest, const void *src, size_t size);
+
 namespace {
 	constexpr bool logCleanup = false;
 	constexpr bool logUsage = false;
 
+	// Number of pages around a read fault that are mapped if they are already resident,
+	// unless the mapping selects a different window.
+	constexpr size_t defaultFaultAroundPages = 16;
+
 	[[maybe_unused]]
 	void logRss(VirtualSpace *space) {
 		if(!logUsage)
@@ -107,6 +113,17 @@ frg::expected<Error> VirtualOperations::faultPage(VirtualAddr va, MemoryView *vi
 	return {};
 }
 
+frg::expected<Error> VirtualOperations::faultAround(VirtualAddr, MemoryView *,
+		uintptr_t, size_t, PageFlags, CachingMode) {
+	// Fault-around is only an optimization; doing nothing is always correct.
+	return {};
+}
+
+frg::expected<Error> VirtualOperations::faultLargePage(VirtualAddr, MemoryView *,
+		uintptr_t, PageFlags, CachingMode) {
+	return Error::noHardwareSupport;
+}
+
 frg::expected<Error> VirtualOperations::cleanPages(VirtualAddr va, MemoryView *view,
 		uintptr_t offset, size_t size) {
 	assert(!(va & (kPageSize - 1)));
@@ -150,8 +167,9 @@ size_t VirtualOperations::getRss() {
 // --------------------------------------------------------
 
 MemorySlice::MemorySlice(smarter::shared_ptr<MemoryView> view,
-		ptrdiff_t view_offset, size_t view_size, CachingFlags cachingFlags)
-: _view{std::move(view)}, _viewOffset{view_offset}, _viewSize{view_size}, cachingFlags_{cachingFlags} {
+		ptrdiff_t view_offset, size_t view_size, CachingFlags cachingFlags, bool readOnly)
+: _view{std::move(view)}, _viewOffset{view_offset}, _viewSize{view_size},
+		cachingFlags_{cachingFlags}, readOnly_{readOnly} {
 	assert(!(_viewOffset & (kPageSize - 1)));
 	assert(!(_viewSize & (kPageSize - 1)));
 }
@@ -214,6 +232,12 @@ Mapping::Mapping(size_t length, MappingFlags flags,
 	assert(viewOffset >= slice->offset());
 	assert(viewOffset + length <= slice->offset() + slice->length());
 	view = slice->getView();
+
+	if(slice->isReadOnly()) {
+		std::underlying_type_t<MappingFlags> newFlags = flags;
+		newFlags &= ~(MappingFlags::protWrite | MappingFlags::protExecute);
+		flags = static_cast<MappingFlags>(newFlags);
+	}
 }
 
 Mapping::~Mapping() {
@@ -232,9 +256,18 @@ void Mapping::protect(MappingFlags protectFlags) {
 	std::underlying_type_t<MappingFlags> newFlags = flags;
 	newFlags &= ~(MappingFlags::protRead | MappingFlags::protWrite | MappingFlags::protExecute);
 	newFlags |= protectFlags;
+	if(slice->isReadOnly())
+		newFlags &= ~(MappingFlags::protWrite | MappingFlags::protExecute);
 	flags = static_cast<MappingFlags>(newFlags);
 }
 
+size_t Mapping::faultAroundPages() {
+	auto order = (flags & MappingFlags::faultAroundMask) >> MappingFlags::faultAroundShift;
+	if(!order)
+		return defaultFaultAroundPages;
+	return size_t{1} << order;
+}
+
 uint32_t Mapping::compilePageFlags() {
 	uint32_t pageFlags = 0;
 	if(flags & MappingFlags::protRead)
@@ -467,6 +500,10 @@ VirtualSpace::map(smarter::borrowed_ptr<MemorySlice> slice,
 
 		if(flags & kMapDontRequireBacking)
 			mappingFlags |= MappingFlags::dontRequireBacking;
+		if(flags & kMapNoFaultAround)
+			mappingFlags |= MappingFlags::noFaultAround;
+		mappingFlags |= ((flags & kMapFaultAroundMask) >> kMapFaultAroundShift)
+				<< MappingFlags::faultAroundShift;
 
 		mapping = smarter::allocate_shared<Mapping>(Allocator{},
 				length, static_cast<MappingFlags>(mappingFlags),
@@ -671,6 +708,18 @@ VirtualSpace::handleFault(VirtualAddr address, uint32_t faultFlags,
 		co_await mapping->evictionMutex.async_lock();
 		frg::unique_lock evictionLock{frg::adopt_lock, mapping->evictionMutex};
 
+		// Try to map the whole surrounding large page if it is part of the mapping.
+		auto largeOffset = offset & ~(kLargePageSize - 1);
+		if(!((mapping->address + largeOffset) & (kLargePageSize - 1))
+				&& !((mapping->viewOffset + largeOffset) & (kLargePageSize - 1))
+				&& largeOffset + kLargePageSize <= mapping->length) {
+			auto largeOutcome = _ops->faultLargePage(mapping->address + largeOffset,
+					mapping->view.get(), mapping->viewOffset + largeOffset,
+					mapping->compilePageFlags(), caching);
+			if(largeOutcome)
+				co_return {};
+		}
+
 		auto remapOutcome = _ops->faultPage(address & ~(kPageSize - 1),
 				mapping->view.get(), mapping->viewOffset + offset,
 				mapping->compilePageFlags(), caching);
@@ -687,6 +736,19 @@ VirtualSpace::handleFault(VirtualAddr address, uint32_t faultFlags,
 			}
 		}
 
+		// On read faults, also map neighbouring pages that are already resident
+		// (e.g., page cache pages of executables and shared libraries).
+		if(!(faultFlags & VirtualSpace::kFaultWrite)
+				&& !(mapping->flags & MappingFlags::noFaultAround)) {
+			auto windowSize = mapping->faultAroundPages() * kPageSize;
+			auto windowStart = offset & ~(windowSize - 1);
+			auto windowEnd = frg::min(windowStart + windowSize, mapping->length);
+			auto aroundOutcome = _ops->faultAround(mapping->address + windowStart,
+					mapping->view.get(), mapping->viewOffset + windowStart,
+					windowEnd - windowStart, mapping->compilePageFlags(), caching);
+			assert(aroundOutcome);
+		}
+
 		co_return {};
 	}
 }
@@ -784,9 +846,18 @@ frg::expected<Error, VirtualAddr> VirtualSpace::_allocate(size_t length, MapFlag
 			}
 
 			if(current->length() >= length) {
+				// Align large mappings such that they can be backed by large pages.
+				VirtualAddr offset = 0;
+				if(length >= kLargePageSize) {
+					auto aligned = (current->address() + kLargePageSize - 1)
+							& ~VirtualAddr(kLargePageSize - 1);
+					if(aligned - current->address() + length <= current->length())
+						offset = aligned - current->address();
+				}
+
 				// Note that _splitHole can deallocate the hole!
-				auto address = current->address();
-				_splitHole(current, 0, length);
+				auto address = current->address() + offset;
+				_splitHole(current, offset, length);
 				return address;
 			}
 
@@ -804,8 +875,15 @@ frg::expected<Error, VirtualAddr> VirtualSpace::_allocate(size_t length, MapFlag
 			}
 
 			if(current->length() >= length) {
-				// Note that _splitHole can deallocate the hole!
 				auto offset = current->length() - length;
+				// Align large mappings such that they can be backed by large pages.
+				if(length >= kLargePageSize) {
+					auto aligned = (current->address() + offset) & ~VirtualAddr(kLargePageSize - 1);
+					if(aligned >= current->address())
+						offset = aligned - current->address();
+				}
+
+				// Note that _splitHole can deallocate the hole!
 				auto address = current->address() + offset;
 				_splitHole(current, offset, length);
 				return address;
@@ -1163,6 +1241,107 @@ coroutine<size_t> VirtualSpace::readPartialSpace(uintptr_t address,
 	co_return progress;
 }
 
+coroutine<size_t> VirtualSpace::readPartialSpaceToUser(uintptr_t address,
+		void *userBuffer, size_t size, bool &userFault, smarter::shared_ptr<WorkQueue> wq) {
+	// We do not take _consistencyMutex here since we are only interested in a snapshot.
+
+	userFault = false;
+	uintptr_t userLimit;
+	if(__builtin_add_overflow(reinterpret_cast<uintptr_t>(userBuffer), size, &userLimit)
+			|| inHigherHalf(userLimit)) {
+		userFault = true;
+		co_return 0;
+	}
+
+	// The destination is only accessible from wq. We need to (re-)schedule onto wq
+	// initially and whenever we might have been suspended.
+	bool needSchedule = true;
+
+	size_t progress = 0;
+	while(progress < size) {
+		smarter::shared_ptr<Mapping> mapping;
+		{
+			auto irqLock = frg::guard(&irqMutex());
+			auto spaceGuard = frg::guard(&_snapshotMutex);
+
+			mapping = _findMapping(address + progress);
+		}
+		if(!mapping)
+			co_return progress;
+		// The sender can only transfer memory that it can read itself.
+		if(!(mapping->flags & MappingFlags::protRead))
+			co_return progress;
+
+		auto startInMapping = address + progress - mapping->address;
+		auto limitInMapping = frg::min(size - progress, mapping->length - startInMapping);
+		// Otherwise, _findMapping() would have returned garbage.
+		assert(limitInMapping);
+
+		auto lockOutcome = co_await mapping->lockVirtualRange(startInMapping, limitInMapping, wq);
+		needSchedule = true;
+		if(!lockOutcome)
+			co_return progress;
+
+		FetchFlags fetchFlags = 0;
+		if(mapping->flags & MappingFlags::dontRequireBacking)
+			fetchFlags |= fetchDisallowBacking;
+
+		// This loop iterates until we hit the end of the mapping.
+		bool success = true;
+		while(progress < size) {
+			auto offsetInMapping = address + progress - mapping->address;
+			if(offsetInMapping == mapping->length)
+				break;
+			assert(offsetInMapping < mapping->length);
+
+			// Since we have locked the MemoryView, the physical address remains valid here.
+			auto [physical, cacheMode] = mapping->resolveRange(
+					offsetInMapping & ~(kPageSize - 1));
+			if(physical == PhysicalAddr(-1)) {
+				auto touchOutcome = co_await mapping->view->fetchRange(
+						(mapping->viewOffset + offsetInMapping) & ~(kPageSize - 1),
+						fetchFlags, wq);
+				needSchedule = true;
+				if(!touchOutcome) {
+					success = false;
+					break;
+				}
+
+				physical = mapping->resolveRange(offsetInMapping & ~(kPageSize - 1)).get<0>();
+				assert(physical != PhysicalAddr(-1));
+			}
+
+			if(needSchedule) {
+				co_await wq->schedule();
+				needSchedule = false;
+			}
+
+			PageAccessor accessor{physical};
+			auto misalign = offsetInMapping & (kPageSize - 1);
+			auto chunk = frg::min(size - progress, kPageSize - misalign);
+			assert(chunk); // Otherwise, we would have finished already.
+			enableUserAccess();
+			int e = doCopyToUser(reinterpret_cast<std::byte *>(userBuffer) + progress,
+					reinterpret_cast<const std::byte *>(accessor.get()) + misalign,
+					chunk);
+			disableUserAccess();
+			if(e) {
+				userFault = true;
+				success = false;
+				break;
+			}
+			progress += chunk;
+		}
+
+		mapping->unlockVirtualRange(startInMapping, limitInMapping);
+
+		if(!success)
+			co_return progress;
+	}
+
+	co_return progress;
+}
+
 coroutine<size_t> VirtualSpace::writePartialSpace(uintptr_t address,
 		const void *buffer, size_t size, smarter::shared_ptr<WorkQueue> wq) {
 	// We do not take _consistencyMutex here since we are only interested in a snapshot.
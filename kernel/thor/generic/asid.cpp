@@ -3,7 +3,11 @@
 #include <thor-internal/arch-generic/paging-consts.hpp>
 #include <thor-internal/arch-generic/paging.hpp>
 
+#include <initgraph.hpp>
 #include <thor-internal/cpu-data.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
+#include <thor-internal/main.hpp>
 
 namespace thor {
 
@@ -11,16 +15,37 @@ THOR_DEFINE_PERCPU(asidData);
 
 namespace {
 
+struct ShootdownStatistics {
+	// Number of shootdowns that were submitted.
+	std::atomic<uint64_t> shootdowns{0};
+	// Number of shootdowns that completed without involving other CPUs.
+	std::atomic<uint64_t> localShootdowns{0};
+	// Number of IPIs that were sent for shootdowns.
+	std::atomic<uint64_t> ipis{0};
+	// Number of times that a whole ASID was invalidated instead of individual pages.
+	std::atomic<uint64_t> fullFlushes{0};
+	// Number of pages that were invalidated individually.
+	std::atomic<uint64_t> pageFlushes{0};
+};
+
+constinit ShootdownStatistics shootdownStats;
+
+void invalidateRange(int asid, VirtualAddr address, size_t size) {
+	for(size_t off = 0; off < size; off += kPageSize)
+		invalidatePage(asid, reinterpret_cast<void *>(address + off));
+	shootdownStats.pageFlushes.fetch_add(size >> kPageShift, std::memory_order_relaxed);
+}
+
 void invalidateNode(int asid, ShootNode *node) {
 	// If we're invalidating a lot of pages, just invalidate the
 	// whole ASID instead.
 	// invalidateAsid(globalBindingId) is not allowed, so avoid
 	// the optimization in that case.
-	if(asid != globalBindingId && (node->size >> kPageShift) >= 64) {
+	if(asid != globalBindingId && (node->size >> kPageShift) >= shootdownFullFlushPages) {
 		invalidateAsid(asid);
+		shootdownStats.fullFlushes.fetch_add(1, std::memory_order_relaxed);
 	} else {
-		for(size_t off = 0; off < node->size; off += kPageSize)
-			invalidatePage(asid, reinterpret_cast<void *>(node->address + off));
+		invalidateRange(asid, node->address, node->size);
 	}
 }
 
@@ -34,6 +59,31 @@ PageBinding::completeShootdown_(PageSpace *space, uint64_t afterSequence, bool d
 
 	ShootNodeList complete;
 
+	// Accumulate the ranges of all pending shootdowns such that we can
+	// invalidate the whole ASID once instead of invalidating each range.
+	bool flushAll = false;
+	if(doShootdown && id_ != globalBindingId && !space->shootQueue_.empty()) {
+		size_t numPages = 0;
+		auto current = space->shootQueue_.back();
+		while(current->sequence_ > afterSequence) {
+			if(current->initiatorCpu_ != getCpuData())
+				numPages += current->size >> kPageShift;
+			if(numPages >= shootdownFullFlushPages) {
+				flushAll = true;
+				break;
+			}
+
+			auto predecessor = current->queueNode.previous;
+			if(!predecessor)
+				break;
+			current = predecessor;
+		}
+	}
+	if(flushAll) {
+		invalidateAsid(id_);
+		shootdownStats.fullFlushes.fetch_add(1, std::memory_order_relaxed);
+	}
+
 	if(!space->shootQueue_.empty()) {
 		auto current = space->shootQueue_.back();
 		while(current->sequence_ > afterSequence) {
@@ -41,8 +91,8 @@ PageBinding::completeShootdown_(PageSpace *space, uint64_t afterSequence, bool d
 
 			// Signal completion of the shootdown.
 			if(current->initiatorCpu_ != getCpuData()) {
-				if(doShootdown) {
-					invalidateNode(id_, current);
+				if(doShootdown && !flushAll) {
+					invalidateRange(id_, current->address, current->size);
 				}
 
 				if(current->bindingsToShoot_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
@@ -61,6 +111,7 @@ PageBinding::completeShootdown_(PageSpace *space, uint64_t afterSequence, bool d
 	// If not just doing a TLB shootdown, we're unbinding this
 	// page space.
 	if(!doShootdown) {
+		space->removeBindingCpu_(getCpuData()->cpuIndex);
 		space->numBindings_--;
 		if(!space->numBindings_ && space->retireNode_) {
 			space->retireNode_->complete();
@@ -109,6 +160,7 @@ void PageBinding::rebind(smarter::shared_ptr<PageSpace> space) {
 		auto lock = frg::guard(&space->mutex_);
 
 		targetSeq = space->shootSequence_;
+		space->addBindingCpu_(getCpuData()->cpuIndex);
 		space->numBindings_++;
 	}
 
@@ -149,6 +201,7 @@ void PageBinding::initialBind(smarter::shared_ptr<PageSpace> space) {
 		auto lock = frg::guard(&space->mutex_);
 
 		targetSeq = space->shootSequence_;
+		space->addBindingCpu_(getCpuData()->cpuIndex);
 		space->numBindings_++;
 	}
 
@@ -255,6 +308,67 @@ PageSpace::~PageSpace() {
 	assert(!numBindings_);
 }
 
+void PageSpace::addBindingCpu_(int cpu) {
+	if(static_cast<size_t>(cpu) >= shootdownTrackedCpus) {
+		numUntrackedBindings_++;
+		return;
+	}
+	assert(!(bindingCpus_[cpu / 64] & (uint64_t{1} << (cpu % 64))));
+	bindingCpus_[cpu / 64] |= uint64_t{1} << (cpu % 64);
+}
+
+void PageSpace::removeBindingCpu_(int cpu) {
+	if(static_cast<size_t>(cpu) >= shootdownTrackedCpus) {
+		assert(numUntrackedBindings_);
+		numUntrackedBindings_--;
+		return;
+	}
+	assert(bindingCpus_[cpu / 64] & (uint64_t{1} << (cpu % 64)));
+	bindingCpus_[cpu / 64] &= ~(uint64_t{1} << (cpu % 64));
+}
+
+void PageSpace::sendShootdownIpis_() {
+	constexpr size_t numWords = shootdownTrackedCpus / 64;
+
+	uint64_t targets[numWords];
+	bool broadcast;
+	{
+		auto irqLock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&mutex_);
+
+		for(size_t w = 0; w < numWords; w++)
+			targets[w] = bindingCpus_[w];
+		broadcast = numUntrackedBindings_;
+
+		// We do not need to IPI ourselves.
+		auto self = getCpuData()->cpuIndex;
+		if(static_cast<size_t>(self) < shootdownTrackedCpus)
+			targets[self / 64] &= ~(uint64_t{1} << (self % 64));
+	}
+
+	size_t numTargets = 0;
+	for(size_t w = 0; w < numWords; w++)
+		numTargets += __builtin_popcountll(targets[w]);
+
+	// If all other CPUs need to be interrupted, a single broadcast is cheaper.
+	auto numOthers = getCpuCount() - 1;
+	if(broadcast || numTargets >= numOthers) {
+		sendShootdownIpi();
+		shootdownStats.ipis.fetch_add(numOthers, std::memory_order_relaxed);
+		return;
+	}
+
+	for(size_t w = 0; w < numWords; w++) {
+		auto word = targets[w];
+		while(word) {
+			auto bit = __builtin_ctzll(word);
+			word &= word - 1;
+			sendShootdownIpi(getCpuData(w * 64 + bit));
+		}
+	}
+	shootdownStats.ipis.fetch_add(numTargets, std::memory_order_relaxed);
+}
+
 
 void PageSpace::retire(RetireNode *node) {
 	bool anyBindings;
@@ -269,10 +383,12 @@ void PageSpace::retire(RetireNode *node) {
 		}
 	}
 
-	if(!anyBindings)
+	if(!anyBindings) {
 		node->complete();
+		return;
+	}
 
-	sendShootdownIpi();
+	sendShootdownIpis_();
 }
 
 
@@ -280,6 +396,8 @@ bool PageSpace::submitShootdown(ShootNode *node) {
 	assert(!(node->address & (kPageSize - 1)));
 	assert(!(node->size & (kPageSize - 1)));
 
+	shootdownStats.shootdowns.fetch_add(1, std::memory_order_relaxed);
+
 	{
 		auto irqLock = frg::guard(&irqMutex());
 		auto lock = frg::guard(&mutex_);
@@ -304,8 +422,10 @@ bool PageSpace::submitShootdown(ShootNode *node) {
 			}
 		}
 
-		if(!unshotBindings)
+		if(!unshotBindings) {
+			shootdownStats.localShootdowns.fetch_add(1, std::memory_order_relaxed);
 			return true;
+		}
 
 		node->initiatorCpu_ = getCpuData();
 		node->sequence_ = ++shootSequence_;
@@ -313,9 +433,36 @@ bool PageSpace::submitShootdown(ShootNode *node) {
 		shootQueue_.push_back(node);
 	}
 
-	sendShootdownIpi();
+	sendShootdownIpis_();
 	return false;
 }
 
+namespace {
+
+struct ShootdownStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		sink.emit("tlb", ".shootdowns",
+				shootdownStats.shootdowns.load(std::memory_order_relaxed));
+		sink.emit("tlb", ".local-shootdowns",
+				shootdownStats.localShootdowns.load(std::memory_order_relaxed));
+		sink.emit("tlb", ".shootdown-ipis",
+				shootdownStats.ipis.load(std::memory_order_relaxed));
+		sink.emit("tlb", ".full-flushes",
+				shootdownStats.fullFlushes.load(std::memory_order_relaxed));
+		sink.emit("tlb", ".page-flushes",
+				shootdownStats.pageFlushes.load(std::memory_order_relaxed));
+	}
+};
+
+constinit ShootdownStatisticsSource shootdownStatisticsSource;
+
+initgraph::Task initShootdownStatistics{&globalInitEngine, "generic.init-shootdown-statistics",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		registerStatisticsSource(&shootdownStatisticsSource);
+	}
+};
+
+} // anonymous namespace
 
 } // namespace thor
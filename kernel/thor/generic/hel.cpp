@@ -5,10 +5,10 @@
 #include <async/cancellation.hpp>
 #include <frg/container_of.hpp>
 #include <frg/formatting.hpp>
-#include <frg/dyn_array.hpp>
 #include <frg/small_vector.hpp>
 #include <thor-internal/event.hpp>
 #include <thor-internal/coroutine.hpp>
+#include <thor-internal/cpu-data.hpp>
 #include <thor-internal/io.hpp>
 #include <thor-internal/ipc-queue.hpp>
 #include <thor-internal/irq.hpp>
@@ -99,6 +99,25 @@ bool writeUserArray(T *pointer, const T *array, size_t count) {
 	return writeUserMemory(pointer, array, size);
 }
 
+namespace {
+	// helSubmitAsync() stores up to this many items inline in its closure.
+	// Larger submissions allocate their items separately.
+	constexpr size_t numInlineSubmitItems = 4;
+
+	// Maximal number of helSubmitAsync() closures that are cached per CPU.
+	constexpr size_t submitClosureCacheSize = 16;
+
+	// Caches the memory of completed helSubmitAsync() closures. Together with the
+	// inline items, this makes the common request/reply case allocation-free.
+	struct SubmitClosureCache {
+		frg::array<void *, submitClosureCacheSize> closures{};
+		size_t numClosures = 0;
+	};
+}
+
+extern PerCpu<SubmitClosureCache> submitClosureCache;
+THOR_DEFINE_PERCPU(submitClosureCache);
+
 size_t ipcSourceSize(size_t size) {
 	return (size + 7) & ~size_t(7);
 }
@@ -115,6 +134,7 @@ HelError translateError(Error error) {
 	case Error::bufferTooSmall: return kHelErrBufferTooSmall;
 	case Error::fault: return kHelErrFault;
 	case Error::remoteFault: return kHelErrRemoteFault;
+	case Error::noMemory: return kHelErrNoMemory;
 	default:
 		assert(!"Unexpected error");
 		__builtin_unreachable();
@@ -212,9 +232,8 @@ HelError helSubmitAsyncNop(HelHandle queueHandle, uintptr_t context) {
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
 
-		auto queueWrapper = thisUniverse->getDescriptor(universeGuard, queueHandle);
+		auto queueWrapper = thisUniverse->getDescriptor(queueHandle);
 		if(!queueWrapper)
 			return kHelErrNoDescriptor;
 		if(!queueWrapper->is<QueueDescriptor>())
@@ -242,8 +261,11 @@ HelError helCreateUniverse(HelHandle *handle) {
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				UniverseDescriptor(std::move(new_universe)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -263,13 +285,12 @@ helTransferDescriptor(HelHandle handle, HelHandle universeHandle, HelTransferDes
 
 	{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard lock(thisUniverse->lock);
 
 		smarter::shared_ptr<Universe> universe;
 		if(universeHandle == kHelThisUniverse) {
 			universe = thisUniverse.lock();
 		}else{
-			auto universeIt = thisUniverse->getDescriptor(lock, universeHandle);
+			auto universeIt = thisUniverse->getDescriptor(universeHandle);
 			if(!universeIt)
 				return kHelErrNoDescriptor;
 			if(!universeIt->is<UniverseDescriptor>())
@@ -289,9 +310,8 @@ helTransferDescriptor(HelHandle handle, HelHandle universeHandle, HelTransferDes
 
 	{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard lock{srcUniverse->lock};
 
-		auto descriptorIt = srcUniverse->getDescriptor(lock, handle);
+		auto descriptorIt = srcUniverse->getDescriptor(handle);
 		if (!descriptorIt)
 			return kHelErrNoDescriptor;
 		descriptor = *descriptorIt;
@@ -303,7 +323,10 @@ helTransferDescriptor(HelHandle handle, HelHandle universeHandle, HelTransferDes
 		auto irqLock = frg::guard(&irqMutex());
 		Universe::Guard lock(dstUniverse->lock);
 
-		*outHandle = dstUniverse->attachDescriptor(lock, std::move(descriptor));
+		auto attachOutcome = dstUniverse->attachDescriptor(lock, std::move(descriptor));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*outHandle = attachOutcome.value();
 	}
 	return kHelErrNone;
 }
@@ -313,9 +336,8 @@ HelError helDescriptorInfo(HelHandle handle, HelDescriptorInfo *) {
 	auto this_universe = this_thread->getUniverse();
 
 	auto irq_lock = frg::guard(&irqMutex());
-	Universe::Guard universe_guard(this_universe->lock);
 
-	auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+	auto wrapper = this_universe->getDescriptor(handle);
 	if(!wrapper)
 		return kHelErrNoDescriptor;
 	switch(wrapper->tag()) {
@@ -334,12 +356,11 @@ HelError helGetCredentials(HelHandle handle, uint32_t flags, char *credentials)
 	std::array<char, 16> creds;
 	{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(thisUniverse->lock);
 
 		if(handle == kHelThisThread) {
 			creds = thisThread->credentials();
 		}else{
-			auto wrapper = thisUniverse->getDescriptor(universe_guard, handle);
+			auto wrapper = thisUniverse->getDescriptor(handle);
 			if(!wrapper)
 				return kHelErrNoDescriptor;
 			if(wrapper->is<ThreadDescriptor>())
@@ -366,9 +387,8 @@ HelError helCloseDescriptor(HelHandle universeHandle, HelHandle handle) {
 		universe = thisUniverse.lock();
 	}else{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeLock(thisUniverse->lock);
 
-		auto universeIt = thisUniverse->getDescriptor(universeLock, universeHandle);
+		auto universeIt = thisUniverse->getDescriptor(universeHandle);
 		if(!universeIt)
 			return kHelErrNoDescriptor;
 		if(!universeIt->is<UniverseDescriptor>())
@@ -409,8 +429,11 @@ HelError helCreateQueue(const HelQueueParameters *paramsPtr, HelHandle *handle)
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(thisUniverse->lock);
 
-		*handle = thisUniverse->attachDescriptor(universe_guard,
+		auto attachOutcome = thisUniverse->attachDescriptor(universe_guard,
 				QueueDescriptor(std::move(queue)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -423,9 +446,8 @@ HelError helCancelAsync(HelHandle handle, uint64_t async_id) {
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto queue_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto queue_wrapper = this_universe->getDescriptor(handle);
 		if(!queue_wrapper)
 			return kHelErrNoDescriptor;
 		if(!queue_wrapper->is<QueueDescriptor>())
@@ -453,21 +475,31 @@ HelError helAllocateMemory(size_t size, uint32_t flags,
 //			<< ", sum of allocated memory: " << (void *)pressure << frg::endlog;
 
 	HelAllocRestrictions effective{
-		.addressBits = 64
+		.addressBits = 64,
+		.numaNode = -1
 	};
-	if(restrictions)
-		if(!readUserMemory(&effective, restrictions, sizeof(HelAllocRestrictions)))
+	if(restrictions) {
+		// Older binaries pass a HelAllocRestrictions struct without the numaNode field.
+		auto restrictionsSize = (flags & kHelAllocNumaNode)
+				? sizeof(HelAllocRestrictions)
+				: offsetof(HelAllocRestrictions, numaNode);
+		if(!readUserMemory(&effective, restrictions, restrictionsSize))
 			return kHelErrFault;
+	}
+	if(effective.numaNode < -1 || effective.numaNode >= physicalAllocator->numNumaNodes())
+		return kHelErrIllegalArgs;
 
 	smarter::shared_ptr<AllocatedMemory> memory;
 	if(flags & kHelAllocContinuous) {
 		memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, size, effective.addressBits,
-				size, kPageSize);
+				size, kPageSize, effective.numaNode);
 	}else if(flags & kHelAllocOnDemand) {
-		memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, size, effective.addressBits);
+		memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, size, effective.addressBits,
+				kPageSize, kPageSize, effective.numaNode);
 	}else{
 		// TODO:
-		memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, size, effective.addressBits);
+		memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, size, effective.addressBits,
+				kPageSize, kPageSize, effective.numaNode);
 	}
 	memory->selfPtr = memory;
 
@@ -475,8 +507,11 @@ HelError helAllocateMemory(size_t size, uint32_t flags,
 		auto irqLock = frg::guard(&irqMutex());
 		Universe::Guard universeGuard(thisUniverse->lock);
 
-		*handle = thisUniverse->attachDescriptor(universeGuard,
+		auto attachOutcome = thisUniverse->attachDescriptor(universeGuard,
 				MemoryViewDescriptor(std::move(memory)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -489,9 +524,8 @@ HelError helResizeMemory(HelHandle handle, size_t newSize) {
 	smarter::shared_ptr<MemoryView> memory;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto wrapper = this_universe->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		if(!wrapper->is<MemoryViewDescriptor>())
@@ -528,10 +562,18 @@ HelError helCreateManagedMemory(size_t size, uint32_t flags,
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(thisUniverse->lock);
 
-		*backing_handle = thisUniverse->attachDescriptor(universe_guard,
+		auto backingOutcome = thisUniverse->attachDescriptor(universe_guard,
 				MemoryViewDescriptor(std::move(backingMemory)));
-		*frontal_handle = thisUniverse->attachDescriptor(universe_guard,
+		if(!backingOutcome)
+			return translateError(backingOutcome.error());
+		auto frontalOutcome = thisUniverse->attachDescriptor(universe_guard,
 				MemoryViewDescriptor(std::move(frontalMemory)));
+		if(!frontalOutcome) {
+			thisUniverse->detachDescriptor(universe_guard, backingOutcome.value());
+			return translateError(frontalOutcome.error());
+		}
+		*backing_handle = backingOutcome.value();
+		*frontal_handle = frontalOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -552,10 +594,9 @@ HelError helCopyOnWrite(HelHandle memoryHandle,
 
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
 		if(memoryHandle >= 0) {
-			auto wrapper = this_universe->getDescriptor(universe_guard, memoryHandle);
+			auto wrapper = this_universe->getDescriptor(memoryHandle);
 			if(!wrapper)
 				return kHelErrNoDescriptor;
 			if(!wrapper->is<MemoryViewDescriptor>())
@@ -571,8 +612,11 @@ HelError helCopyOnWrite(HelHandle memoryHandle,
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*outHandle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				MemoryViewDescriptor(std::move(slice)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*outHandle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -591,8 +635,11 @@ HelError helAccessPhysical(uintptr_t physical, size_t size, HelHandle *handle) {
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				MemoryViewDescriptor(std::move(memory)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -607,8 +654,11 @@ HelError helCreateIndirectMemory(size_t numSlots, HelHandle *handle) {
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				MemoryViewDescriptor(std::move(memory)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -624,9 +674,8 @@ HelError helAlterMemoryIndirection(HelHandle indirectHandle, size_t slot,
 	CachingFlags cacheFlags = 0;
 	{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeLock(thisUniverse->lock);
 
-		auto indirectWrapper = thisUniverse->getDescriptor(universeLock, indirectHandle);
+		auto indirectWrapper = thisUniverse->getDescriptor(indirectHandle);
 		if(!indirectWrapper)
 			return kHelErrNoDescriptor;
 		if(indirectWrapper->is<MemoryViewDescriptor>())
@@ -634,7 +683,7 @@ HelError helAlterMemoryIndirection(HelHandle indirectHandle, size_t slot,
 		else
 			return kHelErrBadDescriptor;
 
-		auto memoryWrapper = thisUniverse->getDescriptor(universeLock, memoryHandle);
+		auto memoryWrapper = thisUniverse->getDescriptor(memoryHandle);
 		if(!memoryWrapper)
 			return kHelErrNoDescriptor;
 		if(memoryWrapper->is<MemoryViewDescriptor>()) {
@@ -672,9 +721,8 @@ HelError helCreateSliceView(HelHandle memoryHandle,
 	smarter::shared_ptr<MemoryView> view;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, memoryHandle);
+		auto wrapper = this_universe->getDescriptor(memoryHandle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		if(!wrapper->is<MemoryViewDescriptor>())
@@ -692,8 +740,11 @@ HelError helCreateSliceView(HelHandle memoryHandle,
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				MemorySliceDescriptor(std::move(slice)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -706,9 +757,8 @@ HelError helForkMemory(HelHandle handle, HelHandle *forkedHandle) {
 	smarter::shared_ptr<MemoryView> view;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto viewWrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto viewWrapper = this_universe->getDescriptor(handle);
 		if(!viewWrapper)
 			return kHelErrNoDescriptor;
 		if(!viewWrapper->is<MemoryViewDescriptor>())
@@ -726,8 +776,11 @@ HelError helForkMemory(HelHandle handle, HelHandle *forkedHandle) {
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*forkedHandle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				MemoryViewDescriptor(forkedView));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*forkedHandle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -742,8 +795,11 @@ HelError helCreateSpace(HelHandle *handle) {
 	auto irq_lock = frg::guard(&irqMutex());
 	Universe::Guard universe_guard(this_universe->lock);
 
-	*handle = this_universe->attachDescriptor(universe_guard,
+	auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 			AddressSpaceDescriptor(std::move(space)));
+	if(!attachOutcome)
+		return translateError(attachOutcome.error());
+	*handle = attachOutcome.value();
 
 	return kHelErrNone;
 }
@@ -756,12 +812,10 @@ HelError helCreateVirtualizedSpace(HelHandle *handle) {
 	auto this_thread = getCurrentThread();
 	auto this_universe = this_thread->getUniverse();
 
-	PhysicalAddr pml4e = physicalAllocator->allocate(kPageSize);
+	PhysicalAddr pml4e = allocateZeroedPage();
 	if(pml4e == static_cast<PhysicalAddr>(-1)) {
 		return kHelErrNoMemory;
 	}
-	PageAccessor paccessor{pml4e};
-	memset(paccessor.get(), 0, kPageSize);
 
 	smarter::shared_ptr<VirtualizedPageSpace> vspace;
 	if(getGlobalCpuFeatures()->haveVmx) {
@@ -776,8 +830,11 @@ HelError helCreateVirtualizedSpace(HelHandle *handle) {
 	{
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				VirtualizedSpaceDescriptor(std::move(vspace)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 		return kHelErrNone;
 	}
 #else
@@ -797,9 +854,8 @@ HelError helCreateVirtualizedCpu(HelHandle handle, HelHandle *out) {
 	smarter::shared_ptr<VirtualizedPageSpace> vspace;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto wrapper = this_universe->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		if(!wrapper->is<VirtualizedSpaceDescriptor>())
@@ -819,8 +875,11 @@ HelError helCreateVirtualizedCpu(HelHandle handle, HelHandle *out) {
 	{
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
-		*out = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				VirtualizedCpuDescriptor(std::move(vcpu)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*out = attachOutcome.value();
 		return kHelErrNone;
 	}
 #else
@@ -840,9 +899,8 @@ HelError helRunVirtualizedCpu(HelHandle handle, HelVmexitReason *exitInfo) {
 	smarter::shared_ptr<VirtualizedCpu> vcpu;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto wrapper = this_universe->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		if(!wrapper->is<VirtualizedCpuDescriptor>())
@@ -902,6 +960,12 @@ HelError helMapMemory(HelHandle memory_handle, HelHandle space_handle,
 
 	if(flags & kHelMapDontRequireBacking)
 		map_flags |= AddressSpace::kMapDontRequireBacking;
+	if(flags & kHelMapNoFaultAround)
+		map_flags |= AddressSpace::kMapNoFaultAround;
+	auto faultAroundOrder = (flags & kHelMapFaultAroundMask) >> kHelMapFaultAroundShift;
+	if(faultAroundOrder > kHelMapMaxFaultAroundOrder)
+		return kHelErrIllegalArgs;
+	map_flags |= faultAroundOrder << AddressSpace::kMapFaultAroundShift;
 
 	smarter::shared_ptr<MemorySlice> slice;
 	smarter::shared_ptr<AddressSpace, BindableHandle> space;
@@ -909,12 +973,16 @@ HelError helMapMemory(HelHandle memory_handle, HelHandle space_handle,
 	bool isVspace = false;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto memory_wrapper = this_universe->getDescriptor(universe_guard, memory_handle);
-		if(!memory_wrapper)
+		auto memory_wrapper = this_universe->getDescriptor(memory_handle);
+		if(memory_handle == kHelClockMemory) {
+			auto memory = getClockPageMemory();
+			auto sliceLength = memory->getLength();
+			slice = smarter::allocate_shared<MemorySlice>(*kernelAlloc,
+					std::move(memory), 0, sliceLength, 0, true);
+		}else if(!memory_wrapper) {
 			return kHelErrNoDescriptor;
-		if(memory_wrapper->is<MemorySliceDescriptor>()) {
+		}else if(memory_wrapper->is<MemorySliceDescriptor>()) {
 			slice = memory_wrapper->get<MemorySliceDescriptor>().slice;
 		}else if(memory_wrapper->is<MemoryViewDescriptor>()) {
 			auto memory = memory_wrapper->get<MemoryViewDescriptor>().memory;
@@ -933,7 +1001,7 @@ HelError helMapMemory(HelHandle memory_handle, HelHandle space_handle,
 		if(space_handle == kHelNullHandle) {
 			space = this_thread->getAddressSpace().lock();
 		}else{
-			auto space_wrapper = this_universe->getDescriptor(universe_guard, space_handle);
+			auto space_wrapper = this_universe->getDescriptor(space_handle);
 			if(!space_wrapper)
 				return kHelErrNoDescriptor;
 			if(space_wrapper->is<AddressSpaceDescriptor>()) {
@@ -994,12 +1062,11 @@ HelError helSubmitProtectMemory(HelHandle space_handle,
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
 		if(space_handle == kHelNullHandle) {
 			space = this_thread->getAddressSpace().lock();
 		}else{
-			auto space_wrapper = this_universe->getDescriptor(universe_guard, space_handle);
+			auto space_wrapper = this_universe->getDescriptor(space_handle);
 			if(!space_wrapper)
 				return kHelErrNoDescriptor;
 			if(!space_wrapper->is<AddressSpaceDescriptor>())
@@ -1007,7 +1074,7 @@ HelError helSubmitProtectMemory(HelHandle space_handle,
 			space = space_wrapper->get<AddressSpaceDescriptor>().space;
 		}
 
-		auto queue_wrapper = this_universe->getDescriptor(universe_guard, queue_handle);
+		auto queue_wrapper = this_universe->getDescriptor(queue_handle);
 		if(!queue_wrapper)
 			return kHelErrNoDescriptor;
 		if(!queue_wrapper->is<QueueDescriptor>())
@@ -1043,12 +1110,11 @@ HelError helUnmapMemory(HelHandle space_handle, void *pointer, size_t length) {
 	smarter::shared_ptr<AddressSpace, BindableHandle> space;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
 		if(space_handle == kHelNullHandle) {
 			space = this_thread->getAddressSpace().lock();
 		}else{
-			auto space_wrapper = this_universe->getDescriptor(universe_guard, space_handle);
+			auto space_wrapper = this_universe->getDescriptor(space_handle);
 			if(!space_wrapper)
 				return kHelErrNoDescriptor;
 			if(!space_wrapper->is<AddressSpaceDescriptor>())
@@ -1075,12 +1141,11 @@ HelError helSubmitSynchronizeSpace(HelHandle spaceHandle, void *pointer, size_t
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
 
 		if(spaceHandle == kHelNullHandle) {
 			space = thisThread->getAddressSpace().lock();
 		}else{
-			auto spaceWrapper = thisUniverse->getDescriptor(universeGuard, spaceHandle);
+			auto spaceWrapper = thisUniverse->getDescriptor(spaceHandle);
 			if(!spaceWrapper)
 				return kHelErrNoDescriptor;
 			if(!spaceWrapper->is<AddressSpaceDescriptor>())
@@ -1088,7 +1153,7 @@ HelError helSubmitSynchronizeSpace(HelHandle spaceHandle, void *pointer, size_t
 			space = spaceWrapper->get<AddressSpaceDescriptor>().space;
 		}
 
-		auto queueWrapper = thisUniverse->getDescriptor(universeGuard, queueHandle);
+		auto queueWrapper = thisUniverse->getDescriptor(queueHandle);
 		if(!queueWrapper)
 			return kHelErrNoDescriptor;
 		if(!queueWrapper->is<QueueDescriptor>())
@@ -1141,14 +1206,13 @@ HelError helSubmitReadMemory(HelHandle handle, uintptr_t address,
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
 
-		auto wrapper = thisUniverse->getDescriptor(universeGuard, handle);
+		auto wrapper = thisUniverse->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		descriptor = *wrapper;
 
-		auto queueWrapper = thisUniverse->getDescriptor(universeGuard, queueHandle);
+		auto queueWrapper = thisUniverse->getDescriptor(queueHandle);
 		if(!queueWrapper)
 			return kHelErrNoDescriptor;
 		if(!queueWrapper->is<QueueDescriptor>())
@@ -1280,14 +1344,13 @@ HelError helSubmitWriteMemory(HelHandle handle, uintptr_t address,
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
 
-		auto wrapper = thisUniverse->getDescriptor(universeGuard, handle);
+		auto wrapper = thisUniverse->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		descriptor = *wrapper;
 
-		auto queueWrapper = thisUniverse->getDescriptor(universeGuard, queueHandle);
+		auto queueWrapper = thisUniverse->getDescriptor(queueHandle);
 		if(!queueWrapper)
 			return kHelErrNoDescriptor;
 		if(!queueWrapper->is<QueueDescriptor>())
@@ -1417,9 +1480,8 @@ HelError helMemoryInfo(HelHandle handle, size_t *size) {
 	smarter::shared_ptr<MemoryView> memory;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto wrapper = this_universe->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		if(!wrapper->is<MemoryViewDescriptor>())
@@ -1439,16 +1501,15 @@ HelError helSubmitManageMemory(HelHandle handle, HelHandle queue_handle, uintptr
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto memory_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto memory_wrapper = this_universe->getDescriptor(handle);
 		if(!memory_wrapper)
 			return kHelErrNoDescriptor;
 		if(!memory_wrapper->is<MemoryViewDescriptor>())
 			return kHelErrBadDescriptor;
 		memory = memory_wrapper->get<MemoryViewDescriptor>().memory;
 
-		auto queue_wrapper = this_universe->getDescriptor(universe_guard, queue_handle);
+		auto queue_wrapper = this_universe->getDescriptor(queue_handle);
 		if(!queue_wrapper)
 			return kHelErrNoDescriptor;
 		if(!queue_wrapper->is<QueueDescriptor>())
@@ -1493,9 +1554,8 @@ HelError helUpdateMemory(HelHandle handle, int type,
 	smarter::shared_ptr<MemoryView> memory;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto memory_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto memory_wrapper = this_universe->getDescriptor(handle);
 		if(!memory_wrapper)
 			return kHelErrNoDescriptor;
 		if(!memory_wrapper->is<MemoryViewDescriptor>())
@@ -1533,16 +1593,15 @@ HelError helSubmitLockMemoryView(HelHandle handle, uintptr_t offset, size_t size
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto memory_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto memory_wrapper = this_universe->getDescriptor(handle);
 		if(!memory_wrapper)
 			return kHelErrNoDescriptor;
 		if(!memory_wrapper->is<MemoryViewDescriptor>())
 			return kHelErrBadDescriptor;
 		memory = memory_wrapper->get<MemoryViewDescriptor>().memory;
 
-		auto queue_wrapper = this_universe->getDescriptor(universe_guard, queue_handle);
+		auto queue_wrapper = this_universe->getDescriptor(queue_handle);
 		if(!queue_wrapper)
 			return kHelErrNoDescriptor;
 		if(!queue_wrapper->is<QueueDescriptor>())
@@ -1580,18 +1639,23 @@ HelError helSubmitLockMemoryView(HelHandle handle, uintptr_t offset, size_t size
 		}
 
 		// Attach the descriptor.
-		HelHandle handle;
+		HelError error = kHelErrNone;
+		HelHandle handle = kHelNullHandle;
 		{
 			auto irq_lock = frg::guard(&irqMutex());
 			Universe::Guard lock(universe->lock);
 
-			handle = universe->attachDescriptor(lock,
+			auto attachOutcome = universe->attachDescriptor(lock,
 					MemoryViewLockDescriptor{
 						smarter::allocate_shared<NamedMemoryViewLock>(
 							*kernelAlloc, std::move(lockHandle))});
+			if(attachOutcome)
+				handle = attachOutcome.value();
+			else
+				error = translateError(attachOutcome.error());
 		}
 
-		HelHandleResult helResult{kHelErrNone, 0, handle};
+		HelHandleResult helResult{error, 0, handle};
 		QueueSource ipcSource{&helResult, sizeof(HelHandleResult), nullptr};
 		co_await queue->submit(&ipcSource, context);
 	}(std::move(this_universe), std::move(memory), std::move(queue),
@@ -1609,9 +1673,8 @@ HelError helLoadahead(HelHandle handle, uintptr_t offset, size_t length) {
 	smarter::shared_ptr<MemoryView> memory;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto memory_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto memory_wrapper = this_universe->getDescriptor(handle);
 		if(!memory_wrapper)
 			return kHelErrNoDescriptor;
 		if(!memory_wrapper->is<MemoryViewDescriptor>())
@@ -1644,12 +1707,11 @@ HelError helCreateThread(HelHandle universe_handle, HelHandle space_handle,
 	smarter::shared_ptr<AddressSpace, BindableHandle> space;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
 		if(universe_handle == kHelNullHandle) {
 			universe = this_thread->getUniverse().lock();
 		}else{
-			auto universe_wrapper = this_universe->getDescriptor(universe_guard, universe_handle);
+			auto universe_wrapper = this_universe->getDescriptor(universe_handle);
 			if(!universe_wrapper)
 				return kHelErrNoDescriptor;
 			if(!universe_wrapper->is<UniverseDescriptor>())
@@ -1660,7 +1722,7 @@ HelError helCreateThread(HelHandle universe_handle, HelHandle space_handle,
 		if(space_handle == kHelNullHandle) {
 			space = this_thread->getAddressSpace().lock();
 		}else{
-			auto space_wrapper = this_universe->getDescriptor(universe_guard, space_handle);
+			auto space_wrapper = this_universe->getDescriptor(space_handle);
 			if(!space_wrapper)
 				return kHelErrNoDescriptor;
 			if(!space_wrapper->is<AddressSpaceDescriptor>())
@@ -1689,8 +1751,11 @@ HelError helCreateThread(HelHandle universe_handle, HelHandle space_handle,
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				ThreadDescriptor(std::move(new_thread)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -1705,9 +1770,8 @@ HelError helQueryThreadStats(HelHandle handle, HelThreadStats *user_stats) {
 		thread = this_thread.lock();
 	}else{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto thread_wrapper = this_universe->getDescriptor(handle);
 		if(!thread_wrapper)
 			return kHelErrNoDescriptor;
 		if(!thread_wrapper->is<ThreadDescriptor>())
@@ -1734,9 +1798,8 @@ HelError helSetPriority(HelHandle handle, int priority) {
 		thread = this_thread.lock();
 	}else{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto thread_wrapper = this_universe->getDescriptor(handle);
 		if(!thread_wrapper)
 			return kHelErrNoDescriptor;
 		if(!thread_wrapper->is<ThreadDescriptor>())
@@ -1764,16 +1827,15 @@ HelError helSubmitObserve(HelHandle handle, uint64_t inSeq,
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irqLock = frg::guard(&irqMutex());
-		Universe::Guard universeGuard(thisUniverse->lock);
 
-		auto threadWrapper = thisUniverse->getDescriptor(universeGuard, handle);
+		auto threadWrapper = thisUniverse->getDescriptor(handle);
 		if(!threadWrapper)
 			return kHelErrNoDescriptor;
 		if(!threadWrapper->is<ThreadDescriptor>())
 			return kHelErrBadDescriptor;
 		thread = remove_tag_cast(threadWrapper->get<ThreadDescriptor>().thread);
 
-		auto queueWrapper = thisUniverse->getDescriptor(universeGuard, queueHandle);
+		auto queueWrapper = thisUniverse->getDescriptor(queueHandle);
 		if(!queueWrapper)
 			return kHelErrNoDescriptor;
 		if(!queueWrapper->is<QueueDescriptor>())
@@ -1825,9 +1887,8 @@ HelError helKillThread(HelHandle handle) {
 	smarter::shared_ptr<Thread> thread;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto thread_wrapper = this_universe->getDescriptor(handle);
 		if(!thread_wrapper)
 			return kHelErrNoDescriptor;
 		if(!thread_wrapper->is<ThreadDescriptor>())
@@ -1847,9 +1908,8 @@ HelError helInterruptThread(HelHandle handle) {
 	smarter::shared_ptr<Thread> thread;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto thread_wrapper = this_universe->getDescriptor(handle);
 		if(!thread_wrapper)
 			return kHelErrNoDescriptor;
 		if(!thread_wrapper->is<ThreadDescriptor>())
@@ -1869,9 +1929,8 @@ HelError helResume(HelHandle handle) {
 	smarter::shared_ptr<Thread> thread;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto thread_wrapper = this_universe->getDescriptor(handle);
 		if(!thread_wrapper)
 			return kHelErrNoDescriptor;
 		if(!thread_wrapper->is<ThreadDescriptor>())
@@ -1897,9 +1956,8 @@ HelError helLoadRegisters(HelHandle handle, int set, void *image) {
 	VirtualizedCpuDescriptor vcpu;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto thread_wrapper = this_universe->getDescriptor(handle);
 		if(!thread_wrapper)
 			return kHelErrNoDescriptor;
 		if(thread_wrapper->is<ThreadDescriptor>()) {
@@ -2074,9 +2132,8 @@ HelError helStoreRegisters(HelHandle handle, int set, const void *image) {
 		thread = this_thread.lock();
 	}else{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto thread_wrapper = this_universe->getDescriptor(handle);
 		if(!thread_wrapper)
 			return kHelErrNoDescriptor;
 		if(thread_wrapper->is<ThreadDescriptor>()) {
@@ -2304,11 +2361,17 @@ HelError helGetClock(uint64_t *counter) {
 
 HelError helSubmitAwaitClock(uint64_t counter, HelHandle queue_handle, uintptr_t context,
 		uint64_t *async_id) {
+	return helSubmitAwaitClockWithSlack(counter, 0, queue_handle, context, async_id);
+}
+
+HelError helSubmitAwaitClockWithSlack(uint64_t counter, uint64_t slack,
+		HelHandle queue_handle, uintptr_t context, uint64_t *async_id) {
 	struct Closure final : CancelNode, PrecisionTimerNode, IpcNode {
-		static void issue(uint64_t nanos, smarter::shared_ptr<IpcQueue> queue,
+		static void issue(uint64_t nanos, uint64_t slack, smarter::shared_ptr<IpcQueue> queue,
 				uintptr_t context, uint64_t *async_id) {
 			auto closure = frg::construct<Closure>(*kernelAlloc, nanos,
 					std::move(queue), context);
+			closure->setSlack(slack);
 			closure->queue->registerNode(closure);
 			*async_id = closure->asyncId();
 			generalTimerEngine()->installTimer(closure);
@@ -2355,9 +2418,8 @@ HelError helSubmitAwaitClock(uint64_t counter, HelHandle queue_handle, uintptr_t
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto queue_wrapper = this_universe->getDescriptor(universe_guard, queue_handle);
+		auto queue_wrapper = this_universe->getDescriptor(queue_handle);
 		if(!queue_wrapper)
 			return kHelErrNoDescriptor;
 		if(!queue_wrapper->is<QueueDescriptor>())
@@ -2368,7 +2430,7 @@ HelError helSubmitAwaitClock(uint64_t counter, HelHandle queue_handle, uintptr_t
 	if(!queue->validSize(ipcSourceSize(sizeof(HelSimpleResult))))
 		return kHelErrQueueTooSmall;
 
-	Closure::issue(counter, std::move(queue), context, async_id);
+	Closure::issue(counter, slack, std::move(queue), context, async_id);
 
 	return kHelErrNone;
 }
@@ -2382,10 +2444,18 @@ HelError helCreateStream(HelHandle *lane1_handle, HelHandle *lane2_handle, uint3
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*lane1_handle = this_universe->attachDescriptor(universe_guard,
+		auto lane1Outcome = this_universe->attachDescriptor(universe_guard,
 				LaneDescriptor(std::move(lanes.get<0>())));
-		*lane2_handle = this_universe->attachDescriptor(universe_guard,
+		if(!lane1Outcome)
+			return translateError(lane1Outcome.error());
+		auto lane2Outcome = this_universe->attachDescriptor(universe_guard,
 				LaneDescriptor(std::move(lanes.get<1>())));
+		if(!lane2Outcome) {
+			this_universe->detachDescriptor(universe_guard, lane1Outcome.value());
+			return translateError(lane2Outcome.error());
+		}
+		*lane1_handle = lane1Outcome.value();
+		*lane2_handle = lane2Outcome.value();
 	}
 
 	return kHelErrNone;
@@ -2405,9 +2475,8 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(thisUniverse->lock);
 
-		auto wrapper = thisUniverse->getDescriptor(universe_guard, handle);
+		auto wrapper = thisUniverse->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		if(wrapper->is<LaneDescriptor>()) {
@@ -2416,7 +2485,7 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 			return kHelErrBadDescriptor;
 		}
 
-		auto queueWrapper = thisUniverse->getDescriptor(universe_guard, queueHandle);
+		auto queueWrapper = thisUniverse->getDescriptor(queueHandle);
 		if(!queueWrapper)
 			return kHelErrNoDescriptor;
 		if(!queueWrapper->is<QueueDescriptor>())
@@ -2439,7 +2508,211 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 		};
 	};
 
-	frg::dyn_array<Item, KernelAlloc> items{count, *kernelAlloc};
+	struct Closure final : StreamPacket, IpcNode {
+		static void transmitted(Closure *closure) {
+			QueueSource *tail = nullptr;
+			auto link = [&] (QueueSource *source) {
+				if(tail)
+					tail->link = source;
+				tail = source;
+			};
+
+			for(size_t i = 0; i < closure->count; i++) {
+				auto item = &closure->items[i];
+				HelAction *recipe = &item->recipe;
+				auto node = &item->transmit;
+
+				if(recipe->type == kHelActionDismiss) {
+					item->helSimpleResult = {translateError(node->error()), 0};
+					item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
+					link(&item->mainSource);
+				}else if(recipe->type == kHelActionOffer) {
+					Error error = node->error();
+					HelHandle handle = kHelNullHandle;
+
+					if(node->error() == Error::success
+							&& (recipe->flags & kHelItemWantLane)) {
+						auto universe = closure->weakUniverse.lock();
+						if (!universe) {
+							item->helHandleResult = {kHelErrBadDescriptor, 0, handle};
+							item->mainSource.setup(&item->helHandleResult, sizeof(HelHandleResult));
+							link(&item->mainSource);
+							continue;
+						}
+						assert(universe);
+
+						auto irq_lock = frg::guard(&irqMutex());
+						Universe::Guard lock(universe->lock);
+
+						auto attachOutcome = universe->attachDescriptor(lock,
+								LaneDescriptor{node->lane()});
+						if(attachOutcome)
+							handle = attachOutcome.value();
+						else
+							error = attachOutcome.error();
+					}
+
+					item->helHandleResult = {translateError(error), 0, handle};
+					item->mainSource.setup(&item->helHandleResult, sizeof(HelHandleResult));
+					link(&item->mainSource);
+				}else if(recipe->type == kHelActionAccept) {
+					// TODO: This condition should be replaced. Just test if lane is valid.
+					Error error = node->error();
+					HelHandle handle = kHelNullHandle;
+					if(node->error() == Error::success) {
+						auto universe = closure->weakUniverse.lock();
+						assert(universe);
+
+						auto irq_lock = frg::guard(&irqMutex());
+						Universe::Guard lock(universe->lock);
+
+						auto attachOutcome = universe->attachDescriptor(lock,
+								LaneDescriptor{node->lane()});
+						if(attachOutcome)
+							handle = attachOutcome.value();
+						else
+							error = attachOutcome.error();
+					}
+
+					item->helHandleResult = {translateError(error), 0, handle};
+					item->mainSource.setup(&item->helHandleResult, sizeof(HelHandleResult));
+					link(&item->mainSource);
+				}else if(recipe->type == kHelActionImbueCredentials) {
+					item->helSimpleResult = {translateError(node->error()), 0};
+					item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
+					link(&item->mainSource);
+				}else if(recipe->type == kHelActionExtractCredentials) {
+					item->helCredentialsResult = {.error = translateError(node->error()), .reserved = {}, .credentials = {}};
+					memcpy(item->helCredentialsResult.credentials,
+							node->credentials().data(), 16);
+					item->mainSource.setup(&item->helCredentialsResult,
+							sizeof(HelCredentialsResult));
+					link(&item->mainSource);
+				}else if(recipe->type == kHelActionSendFromBuffer
+						|| recipe->type == kHelActionSendFromBufferSg
+						|| recipe->type == kHelActionSendFromMemory) {
+					item->helSimpleResult = {translateError(node->error()), 0};
+					item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
+					link(&item->mainSource);
+				}else if(recipe->type == kHelActionRecvInline) {
+					item->helInlineResult = {translateError(node->error()),
+							0, node->_transmitBuffer.size()};
+					item->mainSource.setup(&item->helInlineResult, sizeof(HelInlineResultNoFlex));
+					item->dataSource.setup(node->_transmitBuffer.data(),
+							node->_transmitBuffer.size());
+					link(&item->mainSource);
+					link(&item->dataSource);
+				}else if(recipe->type == kHelActionRecvToBuffer
+						|| recipe->type == kHelActionRecvToMemory) {
+					item->helLengthResult = {translateError(node->error()),
+							0, node->actualLength()};
+					item->mainSource.setup(&item->helLengthResult, sizeof(HelLengthResult));
+					link(&item->mainSource);
+				}else if(recipe->type == kHelActionPushDescriptor) {
+					item->helSimpleResult = {translateError(node->error()), 0};
+					item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
+					link(&item->mainSource);
+				}else if(recipe->type == kHelActionPullDescriptor) {
+					// TODO: This condition should be replaced. Just test if lane is valid.
+					Error error = node->error();
+					HelHandle handle = kHelNullHandle;
+					if(node->error() == Error::success) {
+						auto universe = closure->weakUniverse.lock();
+						assert(universe);
+
+						auto irq_lock = frg::guard(&irqMutex());
+						Universe::Guard lock(universe->lock);
+
+						auto attachOutcome = universe->attachDescriptor(lock, node->descriptor());
+						if(attachOutcome)
+							handle = attachOutcome.value();
+						else
+							error = attachOutcome.error();
+					}
+
+					item->helHandleResult = {translateError(error), 0, handle};
+					item->mainSource.setup(&item->helHandleResult, sizeof(HelHandleResult));
+					link(&item->mainSource);
+				}else{
+					// This cannot happen since we validate recipes at submit time.
+					__builtin_trap();
+				}
+			}
+
+			closure->setupSource(&closure->items[0].mainSource);
+			closure->ipcQueue->submit(closure);
+		}
+
+		static Closure *allocate(size_t count) {
+			void *memory = nullptr;
+			{
+				auto irqLock = frg::guard(&irqMutex());
+
+				auto &cache = submitClosureCache.get();
+				if(cache.numClosures)
+					memory = cache.closures[--cache.numClosures];
+			}
+			if(!memory)
+				memory = kernelAlloc->allocate(sizeof(Closure));
+
+			auto closure = new (memory) Closure;
+			closure->count = count;
+			if(count <= numInlineSubmitItems) {
+				closure->items = reinterpret_cast<Item *>(closure->inlineItems);
+			}else{
+				closure->items = static_cast<Item *>(kernelAlloc->allocate(count * sizeof(Item)));
+			}
+			for(size_t i = 0; i < count; i++)
+				new (&closure->items[i]) Item;
+			return closure;
+		}
+
+		static void release(Closure *closure) {
+			for(size_t i = 0; i < closure->count; i++)
+				closure->items[i].~Item();
+			if(closure->count > numInlineSubmitItems)
+				kernelAlloc->deallocate(closure->items, closure->count * sizeof(Item));
+			closure->~Closure();
+
+			{
+				auto irqLock = frg::guard(&irqMutex());
+
+				auto &cache = submitClosureCache.get();
+				if(cache.numClosures < submitClosureCacheSize) {
+					cache.closures[cache.numClosures++] = closure;
+					return;
+				}
+			}
+			kernelAlloc->deallocate(closure, sizeof(Closure));
+		}
+
+		void completePacket() override {
+			transmitted(this);
+		}
+
+		void complete() override {
+			release(this);
+		}
+
+		size_t count = 0;
+		smarter::weak_ptr<Universe> weakUniverse;
+		smarter::shared_ptr<IpcQueue> ipcQueue;
+		Item *items = nullptr;
+		alignas(Item) char inlineItems[numInlineSubmitItems * sizeof(Item)];
+	};
+
+	auto closure = Closure::allocate(count);
+	auto items = closure->items;
+
+	// Releases the closure if we fail before it is submitted.
+	struct ReleaseOnError {
+		~ReleaseOnError() {
+			if(closure)
+				Closure::release(closure);
+		}
+
+		Closure *closure;
+	} releaseOnError{closure};
 
 	// Identifies the root chain on the stack below.
 	constexpr size_t noIndex = static_cast<size_t>(-1);
@@ -2477,9 +2750,8 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 					creds = thisThread->credentials();
 				} else {
 					auto irq_lock = frg::guard(&irqMutex());
-					Universe::Guard universe_guard(thisUniverse->lock);
 
-					auto wrapper = thisUniverse->getDescriptor(universe_guard, recipe->handle);
+					auto wrapper = thisUniverse->getDescriptor(recipe->handle);
 					if(!wrapper) {
 						return kHelErrNoDescriptor;
 					}
@@ -2556,13 +2828,44 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 				++numFlows;
 				ipcSize += ipcSourceSize(sizeof(HelLengthResult));
 				break;
+			case kHelActionSendFromMemory:
+			case kHelActionRecvToMemory: {
+				smarter::shared_ptr<MemoryView> view;
+				{
+					auto irq_lock = frg::guard(&irqMutex());
+
+					auto wrapper = thisUniverse->getDescriptor(recipe->handle);
+					if(!wrapper)
+						return kHelErrNoDescriptor;
+					if(!wrapper->is<MemoryViewDescriptor>())
+						return kHelErrBadDescriptor;
+					view = wrapper->get<MemoryViewDescriptor>().memory;
+				}
+
+				uintptr_t limit;
+				if(__builtin_add_overflow(recipe->offset, recipe->length, &limit)
+						|| limit > view->getLength())
+					return kHelErrIllegalArgs;
+
+				if(recipe->type == kHelActionSendFromMemory) {
+					node->_tag = kTagSendFlow;
+					ipcSize += ipcSourceSize(sizeof(HelSimpleResult));
+				}else{
+					node->_tag = kTagRecvFlow;
+					ipcSize += ipcSourceSize(sizeof(HelLengthResult));
+				}
+				node->_maxLength = recipe->length;
+				node->_inMemory = std::move(view);
+				node->_inMemoryOffset = recipe->offset;
+				++numFlows;
+				break;
+			}
 			case kHelActionPushDescriptor: {
 				AnyDescriptor operand;
 				{
 					auto irq_lock = frg::guard(&irqMutex());
-					Universe::Guard universe_guard(thisUniverse->lock);
 
-					auto wrapper = thisUniverse->getDescriptor(universe_guard, recipe->handle);
+					auto wrapper = thisUniverse->getDescriptor(recipe->handle);
 					if(!wrapper)
 						return kHelErrNoDescriptor;
 					operand = *wrapper;
@@ -2602,146 +2905,12 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 
 	// From this point on, the function must not fail, since we now link our items
 	// into intrusive linked lists.
+	releaseOnError.closure = nullptr;
 
-	struct Closure final : StreamPacket, IpcNode {
-		static void transmitted(Closure *closure) {
-			QueueSource *tail = nullptr;
-			auto link = [&] (QueueSource *source) {
-				if(tail)
-					tail->link = source;
-				tail = source;
-			};
-
-			for(size_t i = 0; i < closure->count; i++) {
-				auto item = &closure->items[i];
-				HelAction *recipe = &item->recipe;
-				auto node = &item->transmit;
-
-				if(recipe->type == kHelActionDismiss) {
-					item->helSimpleResult = {translateError(node->error()), 0};
-					item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
-					link(&item->mainSource);
-				}else if(recipe->type == kHelActionOffer) {
-					HelHandle handle = kHelNullHandle;
-
-					if(node->error() == Error::success
-							&& (recipe->flags & kHelItemWantLane)) {
-						auto universe = closure->weakUniverse.lock();
-						if (!universe) {
-							item->helHandleResult = {kHelErrBadDescriptor, 0, handle};
-							item->mainSource.setup(&item->helHandleResult, sizeof(HelHandleResult));
-							link(&item->mainSource);
-							continue;
-						}
-						assert(universe);
-
-						auto irq_lock = frg::guard(&irqMutex());
-						Universe::Guard lock(universe->lock);
-
-						handle = universe->attachDescriptor(lock,
-								LaneDescriptor{node->lane()});
-					}
-
-					item->helHandleResult = {translateError(node->error()), 0, handle};
-					item->mainSource.setup(&item->helHandleResult, sizeof(HelHandleResult));
-					link(&item->mainSource);
-				}else if(recipe->type == kHelActionAccept) {
-					// TODO: This condition should be replaced. Just test if lane is valid.
-					HelHandle handle = kHelNullHandle;
-					if(node->error() == Error::success) {
-						auto universe = closure->weakUniverse.lock();
-						assert(universe);
-
-						auto irq_lock = frg::guard(&irqMutex());
-						Universe::Guard lock(universe->lock);
-
-						handle = universe->attachDescriptor(lock,
-								LaneDescriptor{node->lane()});
-					}
-
-					item->helHandleResult = {translateError(node->error()), 0, handle};
-					item->mainSource.setup(&item->helHandleResult, sizeof(HelHandleResult));
-					link(&item->mainSource);
-				}else if(recipe->type == kHelActionImbueCredentials) {
-					item->helSimpleResult = {translateError(node->error()), 0};
-					item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
-					link(&item->mainSource);
-				}else if(recipe->type == kHelActionExtractCredentials) {
-					item->helCredentialsResult = {.error = translateError(node->error()), .reserved = {}, .credentials = {}};
-					memcpy(item->helCredentialsResult.credentials,
-							node->credentials().data(), 16);
-					item->mainSource.setup(&item->helCredentialsResult,
-							sizeof(HelCredentialsResult));
-					link(&item->mainSource);
-				}else if(recipe->type == kHelActionSendFromBuffer
-						|| recipe->type == kHelActionSendFromBufferSg) {
-					item->helSimpleResult = {translateError(node->error()), 0};
-					item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
-					link(&item->mainSource);
-				}else if(recipe->type == kHelActionRecvInline) {
-					item->helInlineResult = {translateError(node->error()),
-							0, node->_transmitBuffer.size()};
-					item->mainSource.setup(&item->helInlineResult, sizeof(HelInlineResultNoFlex));
-					item->dataSource.setup(node->_transmitBuffer.data(),
-							node->_transmitBuffer.size());
-					link(&item->mainSource);
-					link(&item->dataSource);
-				}else if(recipe->type == kHelActionRecvToBuffer) {
-					item->helLengthResult = {translateError(node->error()),
-							0, node->actualLength()};
-					item->mainSource.setup(&item->helLengthResult, sizeof(HelLengthResult));
-					link(&item->mainSource);
-				}else if(recipe->type == kHelActionPushDescriptor) {
-					item->helSimpleResult = {translateError(node->error()), 0};
-					item->mainSource.setup(&item->helSimpleResult, sizeof(HelSimpleResult));
-					link(&item->mainSource);
-				}else if(recipe->type == kHelActionPullDescriptor) {
-					// TODO: This condition should be replaced. Just test if lane is valid.
-					HelHandle handle = kHelNullHandle;
-					if(node->error() == Error::success) {
-						auto universe = closure->weakUniverse.lock();
-						assert(universe);
-
-						auto irq_lock = frg::guard(&irqMutex());
-						Universe::Guard lock(universe->lock);
-
-						handle = universe->attachDescriptor(lock, node->descriptor());
-					}
-
-					item->helHandleResult = {translateError(node->error()), 0, handle};
-					item->mainSource.setup(&item->helHandleResult, sizeof(HelHandleResult));
-					link(&item->mainSource);
-				}else{
-					// This cannot happen since we validate recipes at submit time.
-					__builtin_trap();
-				}
-			}
-
-			closure->setupSource(&closure->items[0].mainSource);
-			closure->ipcQueue->submit(closure);
-		}
-
-		Closure(frg::dyn_array<Item, KernelAlloc> items_)
-		: items{std::move(items_)} { }
-
-		void completePacket() override {
-			transmitted(this);
-		}
-
-		void complete() override {
-			frg::destruct(*kernelAlloc, this);
-		}
-
-		size_t count;
-		smarter::weak_ptr<Universe> weakUniverse;
-		smarter::shared_ptr<IpcQueue> ipcQueue;
-		frg::dyn_array<Item, KernelAlloc> items;
-	} *closure = frg::construct<Closure>(*kernelAlloc, std::move(items));
-
-	closure->count = count;
 	closure->weakUniverse = thisUniverse.lock();
 	closure->ipcQueue = std::move(queue);
 
+
 	closure->setup(count);
 	closure->setupContext(context);
 
@@ -2793,8 +2962,7 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 				continue;
 			}
 
-			if(recipe->type == kHelActionSendFromBuffer
-					&& node->tag() == kTagSendFlow
+			if(node->tag() == kTagSendFlow
 					&& peer->tag() == kTagRecvKernelBuffer) {
 				frg::unique_memory<KernelAlloc> buffer(*kernelAlloc, recipe->length);
 
@@ -2807,7 +2975,14 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 					continue;
 				}
 
-				auto outcome = readUserMemory(buffer.data(), recipe->buffer, recipe->length);
+				bool outcome;
+				if(node->_inMemory) {
+					auto copyOutcome = co_await node->_inMemory->copyFrom(node->_inMemoryOffset,
+							buffer.data(), recipe->length, thread->mainWorkQueue()->take());
+					outcome = static_cast<bool>(copyOutcome);
+				}else{
+					outcome = readUserMemory(buffer.data(), recipe->buffer, recipe->length);
+				}
 				if(!outcome) {
 					// We complete with fault; the remote with success.
 					// TODO: it probably makes sense to introduce a "remote fault" error.
@@ -2822,12 +2997,45 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 				peer->_transmitBuffer = std::move(buffer);
 				peer->complete();
 				node->complete();
-			}else if(recipe->type == kHelActionSendFromBuffer
-					&& node->tag() == kTagSendFlow
+			}else if(node->tag() == kTagSendFlow
 					&& peer->tag() == kTagRecvFlow) {
 				// Empty packets are handled by the generic stream code.
 				assert(recipe->length);
 
+				if(recipe->length >= directFlowThreshold
+						&& !node->_inMemory && !peer->_inMemory) {
+					// Let the receiver copy directly from our address space.
+					// This avoids the intermediate copy to xferBuffers.
+					auto space = thread->getAddressSpace().lock();
+					if(!space) {
+						peer->flowQueue.put({ .terminate = true, .fault = true });
+						auto ackPacket = co_await node->flowQueue.async_get();
+						assert(ackPacket);
+						node->_error = Error::threadExited;
+						node->complete();
+						continue;
+					}
+
+					// Send the packet (may deallocate the peer!).
+					peer->flowQueue.put({
+						.data = recipe->buffer,
+						.size = recipe->length,
+						.space = space.get(),
+						.terminate = true
+					});
+					auto ackPacket = co_await node->flowQueue.async_get();
+					assert(ackPacket);
+					if(ackPacket->sourceFault) {
+						node->_error = Error::fault;
+					}else if(ackPacket->fault) {
+						node->_error = Error::remoteFault;
+					}else{
+						node->_error = Error::success;
+					}
+					node->complete();
+					continue;
+				}
+
 				size_t progress = 0;
 				size_t numSent = 0;
 				size_t numAcked = 0;
@@ -2900,8 +3108,16 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 						break;
 					}
 
-					auto outcome = readUserMemory(xb.data(),
-							reinterpret_cast<std::byte *>(recipe->buffer) + progress, chunkSize);
+					bool outcome;
+					if(node->_inMemory) {
+						auto copyOutcome = co_await node->_inMemory->copyFrom(
+								node->_inMemoryOffset + progress, xb.data(), chunkSize,
+								thread->mainWorkQueue()->take());
+						outcome = static_cast<bool>(copyOutcome);
+					}else{
+						outcome = readUserMemory(xb.data(),
+								reinterpret_cast<std::byte *>(recipe->buffer) + progress, chunkSize);
+					}
 					if(!outcome) {
 						// Send the packet (may deallocate the peer!).
 						peer->flowQueue.put({ .terminate = true, .fault = true });
@@ -2931,7 +3147,7 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 				}
 
 				node->complete();
-			}else if(recipe->type == kHelActionRecvToBuffer
+			}else if(node->tag() == kTagRecvFlow
 					&& peer->tag() == kTagSendKernelBuffer) {
 				auto res = co_await thread->mainWorkQueue()->enter();
 				if (!res) {
@@ -2941,8 +3157,16 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 					node->complete();
 					continue;
 				}
-				auto outcome = writeUserMemory(recipe->buffer,
-						peer->_inBuffer.data(), peer->_inBuffer.size());
+				bool outcome;
+				if(node->_inMemory) {
+					auto copyOutcome = co_await node->_inMemory->copyTo(node->_inMemoryOffset,
+							peer->_inBuffer.data(), peer->_inBuffer.size(),
+							thread->mainWorkQueue()->take());
+					outcome = static_cast<bool>(copyOutcome);
+				}else{
+					outcome = writeUserMemory(recipe->buffer,
+							peer->_inBuffer.data(), peer->_inBuffer.size());
+				}
 				if(!outcome) {
 					// We complete with fault; the remote with success.
 					// TODO: it probably makes sense to introduce a "remote fault" error.
@@ -2958,7 +3182,7 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 				peer->complete();
 				node->complete();
 			}else{
-				assert(recipe->type == kHelActionRecvToBuffer
+				assert(node->tag() == kTagRecvFlow
 						&& peer->tag() == kTagSendFlow);
 
 				size_t progress = 0;
@@ -2968,14 +3192,54 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 					auto xferPacket = co_await node->flowQueue.async_get();
 					assert(xferPacket);
 
+					if(xferPacket->space) {
+						// Direct transfers consist of a single packet.
+						assert(xferPacket->terminate);
+						assert(xferPacket->size <= recipe->length);
+
+						auto wq = thread->mainWorkQueue()->take();
+						if(!wq) {
+							// Ack the packet (may deallocate the peer!).
+							peer->flowQueue.put({ .terminate = true, .fault = true });
+							node->_error = Error::threadExited;
+							break;
+						}
+
+						bool userFault;
+						auto copied = co_await xferPacket->space->readPartialSpaceToUser(
+								reinterpret_cast<uintptr_t>(xferPacket->data),
+								recipe->buffer, xferPacket->size, userFault, std::move(wq));
+						if(copied == xferPacket->size) {
+							// Ack the packet (may deallocate the peer!).
+							peer->flowQueue.put({ .terminate = true });
+							node->_actualLength = copied;
+						}else if(userFault) {
+							peer->flowQueue.put({ .terminate = true, .fault = true });
+							node->_error = Error::fault;
+						}else{
+							peer->flowQueue.put({ .terminate = true, .sourceFault = true });
+							node->_error = Error::remoteFault;
+						}
+						break;
+					}
+
 					if(xferPacket->data && !didFault) {
 						// Otherwise, there would have been a transmission error.
 						assert(progress + xferPacket->size <= recipe->length);
 
 						co_await thread->mainWorkQueue()->enter();
-						auto outcome = writeUserMemory(
-								reinterpret_cast<std::byte *>(recipe->buffer) + progress,
-								xferPacket->data, xferPacket->size);
+						bool outcome;
+						if(node->_inMemory) {
+							auto copyOutcome = co_await node->_inMemory->copyTo(
+									node->_inMemoryOffset + progress,
+									xferPacket->data, xferPacket->size,
+									thread->mainWorkQueue()->take());
+							outcome = static_cast<bool>(copyOutcome);
+						}else{
+							outcome = writeUserMemory(
+									reinterpret_cast<std::byte *>(recipe->buffer) + progress,
+									xferPacket->data, xferPacket->size);
+						}
 						if(outcome) {
 							progress += xferPacket->size;
 						}else{
@@ -3022,7 +3286,11 @@ HelError helSubmitAsync(HelHandle handle, const HelAction *actions, size_t count
 	if(numFlows)
 		handleFlow(closure, numFlows, thisThread.lock());
 
-	Stream::transmit(lane, rootChain);
+	{
+		// Transmitting can complete a peer's receive and thereby wake up the peer.
+		Scheduler::HandoffWindow handoffWindow{true};
+		Stream::transmit(lane, rootChain);
+	}
 
 	return kHelErrNone;
 }
@@ -3034,9 +3302,8 @@ HelError helShutdownLane(HelHandle handle) {
 	LaneHandle lane;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto wrapper = this_universe->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		if(!wrapper->is<LaneDescriptor>())
@@ -3108,6 +3375,45 @@ HelError helFutexWake(int *pointer) {
 	return kHelErrNone;
 }
 
+HelError helFutexWakeSome(int *pointer, unsigned int count, unsigned int *woken) {
+	auto thisThread = getCurrentThread();
+	auto space = thisThread->getAddressSpace();
+
+	auto identityOrError = space->resolveGlobalFutex(reinterpret_cast<uintptr_t>(pointer));
+	if(!identityOrError)
+		return kHelErrFault;
+	*woken = getGlobalFutexRealm()->wake(identityOrError.value(), count);
+
+	return kHelErrNone;
+}
+
+HelError helFutexRequeue(int *pointer, int expected, int *target,
+		unsigned int wakeCount, unsigned int requeueCount) {
+	auto thisThread = getCurrentThread();
+	auto space = thisThread->getAddressSpace();
+
+	auto targetOrError = space->resolveGlobalFutex(reinterpret_cast<uintptr_t>(target));
+	if(!targetOrError)
+		return kHelErrFault;
+
+	// The futex is grabbed (and not only resolved) since requeue() needs to read it.
+	auto futexOrError = Thread::asyncBlockCurrent(
+			space->grabGlobalFutex(reinterpret_cast<uintptr_t>(pointer),
+					thisThread->mainWorkQueue()->take()));
+	if(!futexOrError)
+		return kHelErrFault;
+	GlobalFutex futex = std::move(futexOrError.value());
+
+	auto outcome = getGlobalFutexRealm()->requeue(std::move(futex), expected,
+			targetOrError.value(), wakeCount, requeueCount);
+	if(!outcome) {
+		assert(outcome.error() == Error::futexRace);
+		return kHelErrIllegalState;
+	}
+
+	return kHelErrNone;
+}
+
 HelError helCreateOneshotEvent(HelHandle *handle) {
 	auto this_thread = getCurrentThread();
 	auto this_universe = this_thread->getUniverse();
@@ -3118,8 +3424,11 @@ HelError helCreateOneshotEvent(HelHandle *handle) {
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				OneshotEventDescriptor(std::move(event)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -3135,8 +3444,11 @@ HelError helCreateBitsetEvent(HelHandle *handle) {
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				BitsetEventDescriptor(std::move(event)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -3149,9 +3461,8 @@ HelError helRaiseEvent(HelHandle handle) {
 	AnyDescriptor descriptor;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto wrapper = this_universe->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		descriptor = *wrapper;
@@ -3180,8 +3491,11 @@ HelError helAccessIrq(int number, HelHandle *handle) {
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				IrqDescriptor(std::move(irq)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -3206,9 +3520,8 @@ HelError helAcknowledgeIrq(HelHandle handle, uint32_t flags, uint64_t sequence)
 	smarter::shared_ptr<IrqObject> irq;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto irq_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto irq_wrapper = this_universe->getDescriptor(handle);
 		if(!irq_wrapper)
 			return kHelErrNoDescriptor;
 		if(!irq_wrapper->is<IrqDescriptor>())
@@ -3353,14 +3666,13 @@ HelError helSubmitAwaitEvent(HelHandle handle, uint64_t sequence,
 	smarter::shared_ptr<IpcQueue> queue;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto wrapper = this_universe->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		descriptor = *wrapper;
 
-		auto queue_wrapper = this_universe->getDescriptor(universe_guard, queue_handle);
+		auto queue_wrapper = this_universe->getDescriptor(queue_handle);
 		if(!queue_wrapper)
 			return kHelErrNoDescriptor;
 		if(!queue_wrapper->is<QueueDescriptor>())
@@ -3400,16 +3712,15 @@ HelError helAutomateIrq(HelHandle handle, uint32_t flags, HelHandle kernlet_hand
 	smarter::shared_ptr<BoundKernlet> kernlet;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto irq_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto irq_wrapper = this_universe->getDescriptor(handle);
 		if(!irq_wrapper)
 			return kHelErrNoDescriptor;
 		if(!irq_wrapper->is<IrqDescriptor>())
 			return kHelErrBadDescriptor;
 		irq = irq_wrapper->get<IrqDescriptor>().irq;
 
-		auto kernlet_wrapper = this_universe->getDescriptor(universe_guard, kernlet_handle);
+		auto kernlet_wrapper = this_universe->getDescriptor(kernlet_handle);
 		if(!kernlet_wrapper)
 			return kHelErrNoDescriptor;
 		if(!kernlet_wrapper->is<BoundKernletDescriptor>())
@@ -3439,8 +3750,11 @@ HelError helAccessIo(uintptr_t *port_array, size_t num_ports,
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				IoDescriptor(std::move(io_space)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -3454,9 +3768,8 @@ HelError helEnableIo(HelHandle handle) {
 	smarter::shared_ptr<IoSpace> io_space;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto wrapper = this_universe->getDescriptor(handle);
 		if(!wrapper)
 			return kHelErrNoDescriptor;
 		if(!wrapper->is<IoDescriptor>())
@@ -3494,9 +3807,8 @@ HelError helBindKernlet(HelHandle handle, const HelKernletData *data, size_t num
 	smarter::shared_ptr<KernletObject> kernlet;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto kernlet_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto kernlet_wrapper = this_universe->getDescriptor(handle);
 		if(!kernlet_wrapper)
 			return kHelErrNoDescriptor;
 		if(!kernlet_wrapper->is<KernletObjectDescriptor>())
@@ -3522,9 +3834,8 @@ HelError helBindKernlet(HelHandle handle, const HelKernletData *data, size_t num
 			smarter::shared_ptr<MemoryView> memory;
 			{
 				auto irq_lock = frg::guard(&irqMutex());
-				Universe::Guard universe_guard(this_universe->lock);
 
-				auto wrapper = this_universe->getDescriptor(universe_guard, d.handle);
+				auto wrapper = this_universe->getDescriptor(d.handle);
 				if(!wrapper)
 					return kHelErrNoDescriptor;
 				if(!wrapper->is<MemoryViewDescriptor>())
@@ -3549,9 +3860,8 @@ HelError helBindKernlet(HelHandle handle, const HelKernletData *data, size_t num
 			smarter::shared_ptr<BitsetEvent> event;
 			{
 				auto irq_lock = frg::guard(&irqMutex());
-				Universe::Guard universe_guard(this_universe->lock);
 
-				auto wrapper = this_universe->getDescriptor(universe_guard, d.handle);
+				auto wrapper = this_universe->getDescriptor(d.handle);
 				if(!wrapper)
 					return kHelErrNoDescriptor;
 				if(!wrapper->is<BitsetEventDescriptor>())
@@ -3567,8 +3877,11 @@ HelError helBindKernlet(HelHandle handle, const HelKernletData *data, size_t num
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universe_guard(this_universe->lock);
 
-		*bound_handle = this_universe->attachDescriptor(universe_guard,
+		auto attachOutcome = this_universe->attachDescriptor(universe_guard,
 				BoundKernletDescriptor(std::move(bound)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*bound_handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
@@ -3585,9 +3898,8 @@ HelError helGetAffinity(HelHandle handle, uint8_t *mask, size_t size, size_t *ac
 	smarter::borrowed_ptr<Thread> thread;
 	{
 		auto irq_lock = frg::guard(&irqMutex());
-		Universe::Guard universe_guard(this_universe->lock);
 
-		auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+		auto thread_wrapper = this_universe->getDescriptor(handle);
 		if(!thread_wrapper)
 			return kHelErrNoDescriptor;
 		if(!thread_wrapper->is<ThreadDescriptor>())
@@ -3640,9 +3952,8 @@ HelError helSetAffinity(HelHandle handle, uint8_t *mask, size_t size) {
 		smarter::borrowed_ptr<Thread> thread;
 		{
 			auto irq_lock = frg::guard(&irqMutex());
-			Universe::Guard universe_guard(this_universe->lock);
 
-			auto thread_wrapper = this_universe->getDescriptor(universe_guard, handle);
+			auto thread_wrapper = this_universe->getDescriptor(handle);
 			if(!thread_wrapper)
 				return kHelErrNoDescriptor;
 			if(!thread_wrapper->is<ThreadDescriptor>())
@@ -3748,8 +4059,11 @@ HelError helCreateToken(HelHandle *handle) {
 		auto irq_lock = frg::guard(&irqMutex());
 		Universe::Guard universeGuard(thisUniverse->lock);
 
-		*handle = thisUniverse->attachDescriptor(universeGuard,
+		auto attachOutcome = thisUniverse->attachDescriptor(universeGuard,
 				TokenDescriptor(std::move(creds)));
+		if(!attachOutcome)
+			return translateError(attachOutcome.error());
+		*handle = attachOutcome.value();
 	}
 
 	return kHelErrNone;
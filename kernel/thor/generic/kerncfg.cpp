@@ -29,6 +29,52 @@ extern frg::manual_box<LogRingBuffer> allocLog;
 
 namespace {
 
+// Protects the data structures below.
+constinit frg::ticket_spinlock statisticsMutex;
+
+frg::manual_box<frg::intrusive_list<
+	StatisticsSource,
+	frg::locate_member<
+		StatisticsSource,
+		frg::default_list_hook<StatisticsSource>,
+		&StatisticsSource::hook
+	>
+>> statisticsSources;
+
+struct ResponseStatisticsSink final : StatisticsSink {
+	ResponseStatisticsSink(managarm::kerncfg::GetStatisticsResponse<KernelAlloc> &resp)
+	: resp_{resp} { }
+
+	void emit(frg::string_view prefix, frg::string_view name, uint64_t value) override {
+		resp_.add_names(frg::string<KernelAlloc>{*kernelAlloc, prefix}
+				+ frg::string<KernelAlloc>{*kernelAlloc, name});
+		resp_.add_values(value);
+	}
+
+private:
+	managarm::kerncfg::GetStatisticsResponse<KernelAlloc> &resp_;
+};
+
+} // anonymous namespace
+
+void StatisticsSink::emitIndexed(frg::string_view prefix, size_t index,
+		frg::string_view name, uint64_t value) {
+	auto indexed = frg::string<KernelAlloc>{*kernelAlloc, prefix}
+		+ frg::to_allocated_string(*kernelAlloc, index);
+	emit(frg::string_view{indexed.data(), indexed.size()}, name, value);
+}
+
+void registerStatisticsSource(StatisticsSource *source) {
+	auto irqLock = frg::guard(&irqMutex());
+	auto lock = frg::guard(&statisticsMutex);
+
+	if(!statisticsSources)
+		statisticsSources.initialize();
+	statisticsSources->push_back(source);
+}
+
+namespace {
+
 struct KerncfgBusObject : private KernelBusObject {
 	coroutine<void> run() {
 		Properties properties;
@@ -107,6 +153,36 @@ private:
 			if(respError != Error::success) {
 				co_return respError;
 			}
+		}else if(preamble.id() == bragi::message_id<managarm::kerncfg::GetStatisticsRequest>) {
+			auto req = bragi::parse_head_only<managarm::kerncfg::GetStatisticsRequest>(reqBuffer, *kernelAlloc);
+
+			if (!req)
+				co_return Error::protocolViolation;
+
+			managarm::kerncfg::GetStatisticsResponse<KernelAlloc> resp(*kernelAlloc);
+			resp.set_error(managarm::kerncfg::Error::SUCCESS);
+
+			{
+				auto irqLock = frg::guard(&irqMutex());
+				auto lock = frg::guard(&statisticsMutex);
+
+				ResponseStatisticsSink sink{resp};
+				if(statisticsSources) {
+					for(auto source : *statisticsSources)
+						source->collectStatistics(sink);
+				}
+			}
+
+			frg::unique_memory<KernelAlloc> respHeadBuffer{*kernelAlloc, resp.head_size};
+			frg::unique_memory<KernelAlloc> respTailBuffer{*kernelAlloc, resp.size_of_tail()};
+			bragi::write_head_tail(resp, respHeadBuffer, respTailBuffer);
+
+			auto respHeadError = co_await SendBufferSender{lane, std::move(respHeadBuffer)};
+			if(respHeadError != Error::success)
+				co_return respHeadError;
+			auto respTailError = co_await SendBufferSender{lane, std::move(respTailBuffer)};
+			if(respTailError != Error::success)
+				co_return respTailError;
 		}else{
 			managarm::kerncfg::SvrResponse<KernelAlloc> resp(*kernelAlloc);
 			resp.set_error(managarm::kerncfg::Error::ILLEGAL_REQUEST);
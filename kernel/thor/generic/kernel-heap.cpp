@@ -0,0 +1,318 @@
+#include <new>
+#include <utility>
+
+#include <frg/string.hpp>
+#include <initgraph.hpp>
+#include <thor-internal/cpu-data.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
+#include <thor-internal/kernel_heap.hpp>
+#include <thor-internal/main.hpp>
+
+namespace thor {
+
+namespace {
+
+// KASAN and allocation logging need to observe every allocation and free,
+// hence we bypass the caches in these configurations.
+#if defined(THOR_KASAN) || defined(KERNEL_LOG_ALLOCATIONS)
+constexpr bool useHeapCache = false;
+#else
+constexpr bool useHeapCache = true;
+#endif
+
+// Number of objects that are taken from the slab pool when a CPU misses.
+constexpr size_t heapRefillBatch = heapMagazineRounds / 2;
+
+static_assert(sizeof(HeapMagazine) == 256);
+
+// Global store of magazines for a single size class.
+// Magazines on the filled list are non-empty but not necessarily full.
+struct HeapDepot {
+	HeapMagazine *takeFilled() {
+		auto lock = frg::guard(&mutex);
+		auto magazine = filled;
+		if(magazine) {
+			filled = magazine->next;
+			--numFilled;
+		}
+		return magazine;
+	}
+
+	bool putFilled(HeapMagazine *magazine) {
+		auto lock = frg::guard(&mutex);
+		if(numFilled >= heapDepotLimit)
+			return false;
+		magazine->next = filled;
+		filled = magazine;
+		++numFilled;
+		return true;
+	}
+
+	HeapMagazine *takeEmpty() {
+		auto lock = frg::guard(&mutex);
+		auto magazine = empty;
+		if(magazine) {
+			empty = magazine->next;
+			--numEmpty;
+		}
+		return magazine;
+	}
+
+	bool putEmpty(HeapMagazine *magazine) {
+		auto lock = frg::guard(&mutex);
+		if(numEmpty >= heapDepotLimit)
+			return false;
+		magazine->next = empty;
+		empty = magazine;
+		++numEmpty;
+		return true;
+	}
+
+	ClassIrqSpinlock<"kernel-heap-depot"> mutex;
+	HeapMagazine *filled{nullptr};
+	HeapMagazine *empty{nullptr};
+	size_t numFilled{0};
+	size_t numEmpty{0};
+};
+
+constinit HeapDepot heapDepots[heapCacheNumClasses];
+
+// Returns the size class of an allocation or -1 if the allocation is not cached.
+int sizeToClass(size_t size) {
+	if(size > (size_t{1} << heapCacheMaxShift))
+		return -1;
+	if(size <= (size_t{1} << heapCacheMinShift))
+		return 0;
+	int shift = 64 - __builtin_clzll(size - 1);
+	return shift - heapCacheMinShift;
+}
+
+HeapMagazine *allocateMagazine() {
+	auto memory = kernelHeap->allocate(sizeof(HeapMagazine));
+	if(!memory)
+		return nullptr;
+	return new (memory) HeapMagazine{};
+}
+
+// Must be called with IRQs disabled. Returns nullptr on miss.
+void *allocateFromMagazines(HeapClassCache &cc, HeapDepot &depot) {
+	if(cc.loaded->rounds)
+		return cc.loaded->objects[--cc.loaded->rounds];
+
+	if(cc.previous->rounds) {
+		std::swap(cc.loaded, cc.previous);
+		return cc.loaded->objects[--cc.loaded->rounds];
+	}
+
+	// Both magazines are empty: exchange one of them for a filled one.
+	auto magazine = depot.takeFilled();
+	if(!magazine)
+		return nullptr;
+	cc.stats.depotRefills.bump();
+	if(!depot.putEmpty(cc.previous)) {
+		// This is rare; the magazine is empty, so we do not lose any objects.
+		kernelHeap->free(cc.previous);
+	}
+	cc.previous = cc.loaded;
+	cc.loaded = magazine;
+	return cc.loaded->objects[--cc.loaded->rounds];
+}
+
+// Must be called with IRQs disabled. Returns false on miss.
+// If the depot cannot take another filled magazine, it is returned in overflow
+// and needs to be flushed to the slab pool by the caller.
+bool freeToMagazines(HeapClassCache &cc, HeapDepot &depot, void *pointer,
+		HeapMagazine *&overflow) {
+	if(cc.loaded->rounds < heapMagazineRounds) {
+		cc.loaded->objects[cc.loaded->rounds++] = pointer;
+		return true;
+	}
+
+	if(cc.previous->rounds < heapMagazineRounds) {
+		std::swap(cc.loaded, cc.previous);
+		cc.loaded->objects[cc.loaded->rounds++] = pointer;
+		return true;
+	}
+
+	// Both magazines are full: exchange one of them for an empty one.
+	auto magazine = depot.takeEmpty();
+	if(!magazine)
+		return false;
+	if(!depot.putFilled(cc.previous))
+		overflow = cc.previous;
+	cc.previous = cc.loaded;
+	cc.loaded = magazine;
+	cc.loaded->objects[cc.loaded->rounds++] = pointer;
+	return true;
+}
+
+// Returns all objects of a magazine to the slab pool.
+void flushMagazine(HeapMagazine *magazine, HeapDepot &depot) {
+	for(size_t i = 0; i < magazine->rounds; ++i)
+		kernelHeap->free(magazine->objects[i]);
+	magazine->rounds = 0;
+	if(!depot.putEmpty(magazine))
+		kernelHeap->free(magazine);
+}
+
+} // anonymous namespace
+
+THOR_DEFINE_PERCPU(kernelHeapCache);
+
+KernelHeapCache::KernelHeapCache() {
+	if(!useHeapCache)
+		return;
+
+	for(auto &cc : classes) {
+		cc.loaded = allocateMagazine();
+		cc.previous = allocateMagazine();
+		assert(cc.loaded && cc.previous && "OOM");
+	}
+	enabled = true;
+}
+
+void *KernelAlloc::allocate(size_t size) {
+	auto sizeClass = sizeToClass(size);
+	if(sizeClass < 0)
+		return pool_->allocate(size);
+	// Always allocate the full class size such that objects can be cached
+	// independently of the size that they were requested with.
+	auto classSize = size_t{1} << (sizeClass + heapCacheMinShift);
+	auto &depot = heapDepots[sizeClass];
+
+	bool refill = false;
+	if constexpr (useHeapCache) {
+		auto irqLock = frg::guard(&irqMutex());
+
+		auto cache = &kernelHeapCache.get();
+		if(cache->enabled) {
+			auto &cc = cache->classes[sizeClass];
+			if(auto pointer = allocateFromMagazines(cc, depot); pointer) {
+				cc.stats.allocHits.bump();
+				return pointer;
+			}
+			cc.stats.allocMisses.bump();
+			refill = true;
+		}
+	}
+
+	auto pointer = pool_->allocate(classSize);
+	if(!refill || !pointer)
+		return pointer;
+
+	// Take a batch of objects from the slab pool such that the next allocations
+	// (on this or another CPU) can be served from the depot.
+	auto magazine = allocateMagazine();
+	if(!magazine)
+		return pointer;
+	while(magazine->rounds < heapRefillBatch) {
+		auto object = pool_->allocate(classSize);
+		if(!object)
+			break;
+		magazine->objects[magazine->rounds++] = object;
+	}
+	if(!magazine->rounds || !depot.putFilled(magazine))
+		flushMagazine(magazine, depot);
+	return pointer;
+}
+
+void KernelAlloc::deallocate(void *pointer, size_t size) {
+	if(!pointer)
+		return;
+
+	auto sizeClass = sizeToClass(size);
+	if(sizeClass < 0) {
+		pool_->free(pointer);
+		return;
+	}
+	auto &depot = heapDepots[sizeClass];
+
+	if constexpr (useHeapCache) {
+		// Magazines are per size class; caching an object under the wrong class would
+		// hand it out for larger allocations later. The lookup is omitted if NDEBUG is set.
+		assert(sizeToClass(pool_->get_size(pointer)) == sizeClass
+				&& "Size passed to KernelAlloc::deallocate() does not match the allocation");
+
+		HeapMagazine *overflow = nullptr;
+		bool cached = false;
+		bool missed = false;
+		{
+			auto irqLock = frg::guard(&irqMutex());
+
+			auto cache = &kernelHeapCache.get();
+			if(cache->enabled) {
+				auto &cc = cache->classes[sizeClass];
+				if(freeToMagazines(cc, depot, pointer, overflow)) {
+					cc.stats.freeHits.bump();
+					if(overflow)
+						cc.stats.depotFlushes.bump();
+					cached = true;
+				}else{
+					cc.stats.freeMisses.bump();
+					missed = true;
+				}
+			}
+		}
+
+		if(overflow)
+			flushMagazine(overflow, depot);
+		if(cached)
+			return;
+
+		// Provide an empty magazine such that the next free can be cached.
+		if(missed) {
+			auto magazine = allocateMagazine();
+			if(magazine && !depot.putEmpty(magazine))
+				pool_->free(magazine);
+		}
+	}
+
+	pool_->free(pointer);
+}
+
+HeapCacheSummary getHeapCacheSummary(int sizeClass) {
+	assert(sizeClass >= 0 && sizeClass < heapCacheNumClasses);
+
+	HeapCacheSummary summary;
+	for(size_t i = 0; i < getCpuCount(); ++i) {
+		auto &stats = kernelHeapCache.getFor(i).classes[sizeClass].stats;
+		summary.allocHits += stats.allocHits.load();
+		summary.allocMisses += stats.allocMisses.load();
+		summary.freeHits += stats.freeHits.load();
+		summary.freeMisses += stats.freeMisses.load();
+		summary.depotRefills += stats.depotRefills.load();
+		summary.depotFlushes += stats.depotFlushes.load();
+	}
+	return summary;
+}
+
+namespace {
+
+struct HeapCacheStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		for(int i = 0; i < heapCacheNumClasses; ++i) {
+			auto summary = getHeapCacheSummary(i);
+			auto size = size_t{1} << (i + heapCacheMinShift);
+			sink.emitIndexed("heap-cache.", size, ".alloc-hits", summary.allocHits);
+			sink.emitIndexed("heap-cache.", size, ".alloc-misses", summary.allocMisses);
+			sink.emitIndexed("heap-cache.", size, ".free-hits", summary.freeHits);
+			sink.emitIndexed("heap-cache.", size, ".free-misses", summary.freeMisses);
+			sink.emitIndexed("heap-cache.", size, ".depot-refills", summary.depotRefills);
+			sink.emitIndexed("heap-cache.", size, ".depot-flushes", summary.depotFlushes);
+		}
+	}
+};
+
+constinit HeapCacheStatisticsSource heapCacheStatisticsSource;
+
+initgraph::Task initHeapCacheStatistics{&globalInitEngine, "generic.init-heap-cache-statistics",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		registerStatisticsSource(&heapCacheStatisticsSource);
+	}
+};
+
+} // anonymous namespace
+
+} // namespace thor
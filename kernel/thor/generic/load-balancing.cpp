@@ -1,5 +1,11 @@
+#include <frg/string.hpp>
 #include <frg/unique.hpp>
+#include <initgraph.hpp>
+#include <thor-internal/arch-generic/ints.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
 #include <thor-internal/load-balancing.hpp>
+#include <thor-internal/main.hpp>
 #include <thor-internal/timer.hpp>
 
 namespace thor {
@@ -12,10 +18,32 @@ constexpr bool debugLb = false;
 constexpr bool enableLb = true;
 constexpr uint64_t lbInterval = 100'000'000;
 
+// Minimal time between two attempts of an idle CPU to steal tasks.
+constexpr uint64_t lbIdleInterval = 1'000'000;
+
 // Load decay factor (scale is hardcoded to 8 below) and decay interval.
 constexpr uint64_t lbDecay = 184;
 constexpr uint64_t lbDecayInterval = 1'000'000'000;
 
+// Balancing domains, from the innermost to the outermost domain:
+// level 0 contains SMT siblings, level 1 contains CPUs in the same package,
+// level 2 contains all CPUs. Level n is balanced every 2^n rounds since moving
+// tasks across larger domains is more expensive (e.g., due to cold caches).
+constexpr int numLbLevels = 3;
+
+bool inDomain(int level, CpuData *a, CpuData *b) {
+	if(a == b)
+		return true;
+	switch(level) {
+	case 0:
+		return a->coreId >= 0 && a->coreId == b->coreId && a->packageId == b->packageId;
+	case 1:
+		return a->packageId == b->packageId;
+	default:
+		return true;
+	}
+}
+
 frg::eternal<LoadBalancer> loadBalancer;
 
 } // namespace
@@ -26,8 +54,7 @@ LoadBalancer &LoadBalancer::singleton() {
 	return loadBalancer.get();
 }
 
-LoadBalancer::LoadBalancer()
-: barrier_{0} {}
+LoadBalancer::LoadBalancer() = default;
 
 void LoadBalancer::setOnline(CpuData *cpu) {
 	auto *node = &lbNode.get(cpu);
@@ -52,23 +79,52 @@ void LoadBalancer::connect(Thread *thread, CpuData *cpu) {
 	}
 }
 
+void LoadBalancer::stealOnIdle(CpuData *cpu) {
+	assert(!intsAreEnabled());
+	if(!enableLb)
+		return;
+
+	auto *thisNode = &lbNode.get(cpu);
+	if(!thisNode->cpu)
+		return;
+
+	// Going idle can happen very frequently; avoid scanning other CPUs each time.
+	auto now = getClockNanos();
+	if(now - thisNode->lastIdleSteal < lbIdleInterval)
+		return;
+	thisNode->lastIdleSteal = now;
+
+	for(int level = 0; level < numLbLevels; ++level) {
+		auto *srcNode = balanceDomain_(thisNode, level, true);
+		if(!srcNode)
+			continue;
+
+		thisNode->numIdleSteals.store(thisNode->numIdleSteals.load(std::memory_order_relaxed) + 1,
+				std::memory_order_relaxed);
+
+		// The task only migrates once it passes through the kernel on its current CPU.
+		// Force a preemption check on that CPU instead of waiting for the end of its time slice.
+		sendPingIpi(srcNode->cpu);
+		return;
+	}
+}
+
 coroutine<void> LoadBalancer::run_(CpuData *cpu) {
 	auto *thisNode = &lbNode.get(cpu);
 
-	bool joined = false;
+	// Enter our own WorkQueue such that all CPUs can balance in parallel.
+	// Timers that we start below also complete on this WorkQueue.
+	co_await cpu->generalWorkQueue->enter();
+
+	// CPUs balance independently of each other. Stagger the rounds of different CPUs
+	// to avoid contention on the LbNodes.
+	co_await generalTimerEngine()->sleep(getClockNanos()
+			+ lbInterval / 16 * (cpu->cpuIndex % 16));
+
 	uint64_t lastDecay = getClockNanos();
+	uint64_t round = 0;
 
 	while(true) {
-		// Global barrier to wait for initiation of load balancing.
-		async::barrier::arrival_token token;
-		if (!joined) {
-			token = barrier_.arrive_and_join();
-			joined = true;
-		} else {
-			token = barrier_.arrive();
-		}
-		co_await barrier_.async_wait(token);
-
 		if (debugLb)
 			infoLogger() << "CPU #" << cpu->cpuIndex << " enters load balancing" << frg::endlog;
 
@@ -79,80 +135,111 @@ coroutine<void> LoadBalancer::run_(CpuData *cpu) {
 			lastDecay = now;
 		}
 
-		// On this CPU, estimate the load.
-		uint64_t load = 0;
-		{
-			auto irqLock = frg::guard(&irqMutex());
-			auto lock = frg::guard(&thisNode->mutex);
+		updateLoad_(thisNode, applyDecay);
 
-			auto it = thisNode->tasks.begin();
-			while (it != thisNode->tasks.end()) {
-				auto currentIt = it;
-				auto *cb = *currentIt;
-				++it;
+		if (debugLb)
+			infoLogger() << "CPU #" << cpu->cpuIndex << " has load "
+					<< thisNode->currentLoad.load(std::memory_order_relaxed) << frg::endlog;
 
-				// cb is owned by thisNode.
-				// We deallocate the control block once the thread has been destroyed.
-				auto thread = cb->thread_.lock();
-				if (!thread) {
-					thisNode->tasks.erase(currentIt);
-					frg::destruct(*kernelAlloc, cb);
+		if (enableLb) {
+			for (int level = 0; level < numLbLevels; ++level) {
+				if (round & ((uint64_t{1} << level) - 1))
 					continue;
-				}
-
-				thread->updateLoad();
-				if (applyDecay)
-					thread->decayLoad(lbDecay, 8);
-				cb->load_ = thread->loadLevel();
-				load += cb->load_;
+				balanceDomain_(thisNode, level, false);
 			}
 		}
+		++round;
 
-		thisNode->totalLoad = load;
-		thisNode->currentLoad = load;
+		// Balance load again after some time has passed.
+		co_await generalTimerEngine()->sleep(getClockNanos() + lbInterval);
+	}
 
-		if (debugLb)
-			infoLogger() << "CPU #" << cpu->cpuIndex << " has load " << load << frg::endlog;
+	co_return;
+}
 
-		// Global barrier to wait until all CPUs know their load level.
-		co_await barrier_.async_wait(barrier_.arrive());
+void LoadBalancer::updateLoad_(LbNode *node, bool applyDecay) {
+	auto irqLock = frg::guard(&irqMutex());
+	auto lock = frg::guard(&node->mutex);
+
+	uint64_t load = 0;
+	auto it = node->tasks.begin();
+	while (it != node->tasks.end()) {
+		auto currentIt = it;
+		auto *cb = *currentIt;
+		++it;
+
+		// cb is owned by node.
+		// We deallocate the control block once the thread has been destroyed.
+		auto thread = cb->thread_.lock();
+		if (!thread) {
+			node->tasks.erase(currentIt);
+			frg::destruct(*kernelAlloc, cb);
+			continue;
+		}
 
-		// Enter our own WorkQueue such that all CPUs can balance in parallel.
-		co_await cpu->generalWorkQueue->enter();
+		thread->updateLoad();
+		if (applyDecay)
+			thread->decayLoad(lbDecay, 8);
+		cb->load_ = thread->loadLevel();
+		load += cb->load_;
+	}
 
-		// Sum load of all CPUs.
-		// TODO: Doing this on all CPUs is unnecessary. However, it is also reasonably fast
-		//       and might be preferable over synchronization overhead.
-		uint64_t systemLoad = 0;
-		for (size_t i = 0; i < getCpuCount(); ++i)
-			systemLoad += lbNode.getFor(i).totalLoad;
-		uint64_t idealLoad = systemLoad / getCpuCount();
-		if (debugLb && cpu == getCpuData(0))
-			infoLogger() << "Total system load is " << systemLoad
-					<< " (ideal load: " << idealLoad << ")" << frg::endlog;
+	node->currentLoad.store(load, std::memory_order_relaxed);
+}
 
-		if (enableLb) {
-			// Distribute load from other CPUs to this CPU.
-			// TODO: This loop probably does not scale very well since all CPUs try to pull from
-			//       all other CPUs in the same order (and this can cause lock contention).
-			uint64_t newLoad = thisNode->totalLoad;
-			for (size_t i = 0; i < getCpuCount(); ++i) {
-				auto *toCpu = getCpuData(i);
-				if (cpu != toCpu)
-					balanceBetween_(&lbNode.get(toCpu), thisNode, newLoad, idealLoad);
-			}
+LbNode *LoadBalancer::balanceDomain_(LbNode *thisNode, int level, bool idle) {
+	auto *cpu = thisNode->cpu;
+	auto numCpus = getCpuCount();
+
+	// Determine the ideal load within the domain.
+	// Loads of other CPUs can change concurrently, hence this is only an estimate.
+	uint64_t domainLoad = 0;
+	size_t domainSize = 0;
+	for (size_t i = 0; i < numCpus; ++i) {
+		auto *node = &lbNode.getFor(i);
+		if (!node->cpu || !inDomain(level, cpu, node->cpu))
+			continue;
+		domainLoad += node->currentLoad.load(std::memory_order_relaxed);
+		++domainSize;
+	}
+	if (domainSize < 2)
+		return nullptr;
+	uint64_t idealLoad = domainLoad / domainSize;
+
+	// Only pull tasks if we are undersubscribed; overloaded CPUs are drained by others.
+	uint64_t newLoad = thisNode->currentLoad.load(std::memory_order_relaxed);
+	if (!idle && newLoad >= idealLoad)
+		return nullptr;
+
+	if (debugLb)
+		infoLogger() << "CPU #" << cpu->cpuIndex << " balances level " << level
+				<< " (ideal load: " << idealLoad << ")" << frg::endlog;
+
+	// Start scanning after our own index such that not all CPUs pull from the same CPUs.
+	LbNode *srcNode = nullptr;
+	for (size_t k = 1; k < numCpus; ++k) {
+		auto *node = &lbNode.getFor((cpu->cpuIndex + k) % numCpus);
+		if (!node->cpu || !inDomain(level, cpu, node->cpu))
+			continue;
+		if (node->currentLoad.load(std::memory_order_relaxed) <= idealLoad)
+			continue;
+
+		// Idle CPUs only steal a single task to avoid overshooting.
+		// They also only steal runnable tasks since blocked tasks would not give them work.
+		if (balanceBetween_(node, thisNode, newLoad, idealLoad,
+				idle ? 1 : static_cast<size_t>(-1), idle)) {
+			srcNode = node;
+			if (idle)
+				break;
 		}
-
-		// Balance load again after some time has passed.
-		// Note that we only wait on CPU zero. All other CPUs wait on the barrier instead.
-		if (!cpu->cpuIndex)
-			co_await generalTimerEngine()->sleep(getClockNanos() + lbInterval);
+		if (newLoad >= idealLoad)
+			break;
 	}
-
-	co_return;
+	return srcNode;
 }
 
-void LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &newLoad, uint64_t idealLoad) {
+size_t LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &newLoad, uint64_t idealLoad,
+		size_t maxTasks, bool runnableOnly) {
 	auto improvesBalance = [] (uint64_t srcLoad, uint64_t dstLoad, uint64_t stolenLoad) -> bool {
 		uint64_t srcLoadPostMove = srcLoad - stolenLoad;
 		uint64_t dstLoadPostMove = dstLoad + stolenLoad;
@@ -171,12 +258,14 @@ void LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &n
 			&LbControlBlock::hook_
 		>
 	> stolenTasks;
+	size_t numStolen = 0;
 	{
 		auto irqLock = frg::guard(&irqMutex());
 		auto lock = frg::guard(&srcNode->mutex);
 
+		auto srcLoad = srcNode->currentLoad.load(std::memory_order_relaxed);
 		auto it = srcNode->tasks.begin();
-		while (it != srcNode->tasks.end()) {
+		while (it != srcNode->tasks.end() && numStolen < maxTasks) {
 			auto currentIt = it;
 			auto *cb = *currentIt;
 			++it;
@@ -184,7 +273,7 @@ void LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &n
 			// Do not attempt to do load balancing if source and destination are both
 			// undersubscribed. While it may still be possible to improve the balance,
 			// it is probably not worth it in terms of effort and cache degradation.
-			if (srcNode->currentLoad < idealLoad && newLoad < idealLoad)
+			if (srcLoad < idealLoad && newLoad < idealLoad)
 				break;
 
 			// Do not move threads with tiny contributions to the total load.
@@ -194,9 +283,17 @@ void LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &n
 			if (!cb->inAffinityMask(dstNode->cpu->cpuIndex))
 				continue;
 
-			if (!improvesBalance(srcNode->currentLoad, newLoad, cb->load_))
+			if (!improvesBalance(srcLoad, newLoad, cb->load_))
 				continue;
 
+			// The thread's run state is checked last since it requires taking the thread's lock.
+			// Note that LbNode::mutex is always taken before Thread::_mutex (see updateLoad_()).
+			if (runnableOnly) {
+				auto thread = cb->thread_.lock();
+				if (!thread || !thread->isRunnable())
+					continue;
+			}
+
 			if (debugLb)
 				infoLogger() << "Moving thread with load " << cb->load_
 						<< " from CPU " << srcNode->cpu->cpuIndex
@@ -208,19 +305,55 @@ void LoadBalancer::balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &n
 			cb->node_ = dstNode;
 			cb->_assignedCpu.store(dstNode->cpu, std::memory_order_relaxed);
 			stolenTasks.push_back(cb);
+			++numStolen;
 
-			srcNode->currentLoad -= cb->load_;
+			srcLoad -= cb->load_;
 			newLoad += cb->load_;
 		}
+
+		srcNode->currentLoad.store(srcLoad, std::memory_order_relaxed);
 	}
 
+	if (!numStolen)
+		return 0;
+
 	// Add tasks from temporary list to dstNode.
 	{
 		auto irqLock = frg::guard(&irqMutex());
 		auto lock = frg::guard(&dstNode->mutex);
 
 		dstNode->tasks.splice(dstNode->tasks.end(), stolenTasks);
+		dstNode->currentLoad.store(newLoad, std::memory_order_relaxed);
+		dstNode->numPulled.store(dstNode->numPulled.load(std::memory_order_relaxed) + numStolen,
+				std::memory_order_relaxed);
 	}
+
+	return numStolen;
 }
 
+namespace {
+
+struct LbStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		for (size_t i = 0; i < getCpuCount(); ++i) {
+			auto &node = lbNode.getFor(i);
+			sink.emitIndexed("lb.cpu", i, ".load", node.currentLoad.load(std::memory_order_relaxed));
+			sink.emitIndexed("lb.cpu", i, ".pulled", node.numPulled.load(std::memory_order_relaxed));
+			sink.emitIndexed("lb.cpu", i, ".idle-steals",
+					node.numIdleSteals.load(std::memory_order_relaxed));
+		}
+	}
+};
+
+constinit LbStatisticsSource lbStatisticsSource;
+
+initgraph::Task initLbStatistics{&globalInitEngine, "generic.init-lb-statistics",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		registerStatisticsSource(&lbStatisticsSource);
+	}
+};
+
+} // anonymous namespace
+
 } // namespace thor
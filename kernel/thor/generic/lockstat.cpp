@@ -0,0 +1,61 @@
+#include <thor-internal/lockstat.hpp>
+
+#ifdef THOR_LOCKSTAT
+#include <frg/string.hpp>
+#include <initgraph.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
+#include <thor-internal/kernel_heap.hpp>
+#include <thor-internal/main.hpp>
+#endif
+
+namespace thor {
+
+#ifdef THOR_LOCKSTAT
+namespace {
+
+// Classes are only ever added to this list (and never removed).
+constinit std::atomic<LockClassStats *> lockClassList{nullptr};
+
+struct LockStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		auto stats = lockClassList.load(std::memory_order_acquire);
+		while(stats) {
+			auto prefix = frg::string<KernelAlloc>{*kernelAlloc, "lockstat."}
+				+ frg::string<KernelAlloc>{*kernelAlloc, stats->name};
+			frg::string_view prefixView{prefix.data(), prefix.size()};
+			sink.emit(prefixView, ".acquires",
+					stats->numAcquires.load(std::memory_order_relaxed));
+			sink.emit(prefixView, ".contended",
+					stats->numContended.load(std::memory_order_relaxed));
+			sink.emit(prefixView, ".wait-ticks",
+					stats->waitTicks.load(std::memory_order_relaxed));
+			sink.emit(prefixView, ".max-hold-ticks",
+					stats->maxHoldTicks.load(std::memory_order_relaxed));
+			stats = stats->next;
+		}
+	}
+};
+
+constinit LockStatisticsSource lockStatisticsSource;
+
+initgraph::Task initLockStatistics{&globalInitEngine, "generic.init-lock-statistics",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		registerStatisticsSource(&lockStatisticsSource);
+	}
+};
+
+} // anonymous namespace
+
+void registerLockClass(LockClassStats *stats) {
+	// This can be called from any context (including the kernel heap); hence, it does not lock.
+	auto head = lockClassList.load(std::memory_order_relaxed);
+	do {
+		stats->next = head;
+	} while(!lockClassList.compare_exchange_weak(head, stats,
+			std::memory_order_release, std::memory_order_relaxed));
+}
+#endif // THOR_LOCKSTAT
+
+} // namespace thor
@@ -292,6 +292,10 @@ extern "C" void thorMain() {
 			auto p = base;
 			auto limit = base + modules[0].length;
 			while(true) {
+				// gen-initrd.py inserts NUL padding between entries to page-align file data.
+				while(p + 4 <= limit && !p[0])
+					p += 4;
+
 				Header header;
 				assert(p + sizeof(Header) <= limit);
 				memcpy(&header, p, sizeof(Header));
@@ -336,13 +340,25 @@ extern "C" void thorMain() {
 	//				if(logInitialization)
 						debugLogger() << "thor: initrd file " << path << frg::endlog;
 
-					auto memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc,
-							(file_size + (kPageSize - 1)) & ~size_t{kPageSize - 1});
-					memory->selfPtr = memory;
-					auto copyOutcome = KernelFiber::asyncBlockCurrent(memory->copyTo(0,
-							data, file_size,
-							thisFiber()->associatedWorkQueue()->take()));
-					assert(copyOutcome);
+					// If the file data is page-aligned, we map it directly from the initrd.
+					// gen-initrd.py pads the data with zeros up to the next page boundary.
+					smarter::shared_ptr<MemoryView> memory;
+					auto dataPhysical = modules[0].physicalBase + (data - base);
+					auto dataLength = (file_size + (kPageSize - 1)) & ~size_t{kPageSize - 1};
+					if(file_size && !(dataPhysical & (kPageSize - 1))
+							&& data + dataLength <= limit) {
+						memory = smarter::allocate_shared<HardwareMemory>(*kernelAlloc,
+								dataPhysical, dataLength, CachingMode::null);
+					}else{
+						auto allocated = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc,
+								dataLength);
+						allocated->selfPtr = allocated;
+						auto copyOutcome = KernelFiber::asyncBlockCurrent(allocated->copyTo(0,
+								data, file_size,
+								thisFiber()->associatedWorkQueue()->take()));
+						assert(copyOutcome);
+						memory = std::move(allocated);
+					}
 
 					auto name = frg::string<KernelAlloc>{*kernelAlloc,
 							path.sub_string(it - path.data(), end - it)};
@@ -533,7 +549,10 @@ void handleIrq(IrqImageAccessor image, IrqPin *irq) {
 	if(logEveryIrq)
 		infoLogger() << "thor: IRQ " << irq->name() << frg::endlog;
 
-	irq->raise();
+	{
+		Scheduler::HandoffWindow handoffWindow{false};
+		irq->raise();
+	}
 
 	// Inject IRQ timing entropy into the PRNG accumulator.
 	// Since we track the sequence number per CPU, we also include the CPU number.
@@ -806,6 +825,12 @@ void handleSyscall(SyscallImageAccessor image) {
 				(HelHandle)arg1, (uintptr_t)arg2, &async_id);
 		*image.out0() = async_id;
 	} break;
+	case kHelCallSubmitAwaitClockWithSlack: {
+		uint64_t async_id;
+		*image.error() = helSubmitAwaitClockWithSlack((uint64_t)arg0, (uint64_t)arg1,
+				(HelHandle)arg2, (uintptr_t)arg3, &async_id);
+		*image.out0() = async_id;
+	} break;
 
 	case kHelCallCreateStream: {
 		HelHandle lane1;
@@ -828,6 +853,15 @@ void handleSyscall(SyscallImageAccessor image) {
 	case kHelCallFutexWake: {
 		*image.error() = helFutexWake((int *)arg0);
 	} break;
+	case kHelCallFutexWakeSome: {
+		unsigned int woken;
+		*image.error() = helFutexWakeSome((int *)arg0, (unsigned int)arg1, &woken);
+		*image.out0() = woken;
+	} break;
+	case kHelCallFutexRequeue: {
+		*image.error() = helFutexRequeue((int *)arg0, (int)arg1, (int *)arg2,
+				(unsigned int)arg3, (unsigned int)arg4);
+	} break;
 
 	case kHelCallCreateOneshotEvent: {
 		HelHandle handle;
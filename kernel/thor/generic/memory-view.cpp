@@ -1,6 +1,7 @@
 #include <thor-internal/address-space.hpp>
 #include <thor-internal/coroutine.hpp>
 #include <thor-internal/fiber.hpp>
+#include <thor-internal/lockstat.hpp>
 #include <thor-internal/main.hpp>
 #include <thor-internal/memory-view.hpp>
 #include <thor-internal/physical.hpp>
@@ -21,41 +22,71 @@ namespace {
 // Reclaim implementation.
 // --------------------------------------------------------
 
+namespace {
+
+using CachePageList = frg::intrusive_list<
+	CachePage,
+	frg::locate_member<
+		CachePage,
+		frg::default_list_hook<CachePage>,
+		&CachePage::listHook
+	>
+>;
+
+// Maximal number of pages in a per-CPU add batch.
+constexpr size_t reclaimBatchSize = 15;
+// Maximal number of pages that are moved between the LRU lists per scan.
+constexpr size_t reclaimScanBatch = 32;
+
+// Pages are collected in per-CPU batches before they are added to the global LRU lists.
+// This avoids taking the reclaimer's lock on every lock/unlock cycle of a page.
+struct ReclaimBatch {
+	frg::ticket_spinlock mutex;
+	CachePageList pages;
+	size_t numPages = 0;
+};
+
+} // anonymous namespace
+
+extern PerCpu<ReclaimBatch> reclaimBatch;
+THOR_DEFINE_PERCPU(reclaimBatch);
+
+// Pages enter the inactive list. Pages that are accessed again while they are on the
+// inactive list are promoted to the active list, such that pages that are only
+// accessed once (e.g., by large sequential reads) do not evict the working set.
+// Accesses only set CachePage::referenced; the lists are updated lazily during scans.
 struct MemoryReclaimer {
 	void addPage(CachePage *page) {
 		auto irqLock = frg::guard(&irqMutex());
-		auto lock = frg::guard(&_mutex);
-
-		assert(!(page->flags & CachePage::reclaimRegistered));
-
-		_lruList.push_back(page);
-		page->flags |= CachePage::reclaimRegistered;
-		_cachedSize += kPageSize;
+		auto &batch = reclaimBatch.get();
+		auto lock = frg::guard(&batch.mutex);
+
+		assert(page->batchCpu.load(std::memory_order_relaxed) == -1);
+		batch.pages.push_back(page);
+		page->batchCpu.store(getCpuData()->cpuIndex, std::memory_order_relaxed);
+		if(++batch.numPages >= reclaimBatchSize)
+			_drainBatch(batch);
 	}
 
 	void removePage(CachePage *page) {
 		auto irqLock = frg::guard(&irqMutex());
-		auto lock = frg::guard(&_mutex);
 
-		assert(page->flags & CachePage::reclaimRegistered);
-
-		if(page->flags & CachePage::reclaimPosted) {
-			if(!(page->flags & CachePage::reclaimInflight)) {
-				auto it = page->bundle->_reclaimList.iterator_to(page);
-				page->bundle->_reclaimList.erase(it);
+		// Callers serialize addPage() and removePage() of the same page,
+		// hence the page cannot enter a batch concurrently.
+		if(auto cpu = page->batchCpu.load(std::memory_order_relaxed); cpu >= 0) {
+			auto &batch = reclaimBatch.getFor(cpu);
+			auto lock = frg::guard(&batch.mutex);
+
+			if(page->batchCpu.load(std::memory_order_relaxed) == cpu) {
+				auto it = batch.pages.iterator_to(page);
+				batch.pages.erase(it);
+				--batch.numPages;
+				page->batchCpu.store(-1, std::memory_order_relaxed);
+				return;
 			}
-
-			page->flags &= ~(CachePage::reclaimPosted | CachePage::reclaimInflight);
-		}else{
-			auto it = _lruList.iterator_to(page);
-			_lruList.erase(it);
-			_cachedSize -= kPageSize;
+			// Otherwise, the batch was drained in the meantime.
 		}
-		page->flags &= ~CachePage::reclaimRegistered;
-	}
 
-	void bumpPage(CachePage *page) {
-		auto irqLock = frg::guard(&irqMutex());
 		auto lock = frg::guard(&_mutex);
 
 		assert(page->flags & CachePage::reclaimRegistered);
@@ -67,13 +98,24 @@ struct MemoryReclaimer {
 			}
 
 			page->flags &= ~(CachePage::reclaimPosted | CachePage::reclaimInflight);
-			_cachedSize += kPageSize;
+		}else if(page->flags & CachePage::reclaimActive) {
+			auto it = _activeList.iterator_to(page);
+			_activeList.erase(it);
+			--_numActive;
+			_cachedSize -= kPageSize;
 		}else{
-			auto it = _lruList.iterator_to(page);
-			_lruList.erase(it);
+			auto it = _inactiveList.iterator_to(page);
+			_inactiveList.erase(it);
+			--_numInactive;
+			_cachedSize -= kPageSize;
 		}
+		page->flags &= ~(CachePage::reclaimRegistered | CachePage::reclaimActive);
+	}
 
-		_lruList.push_back(page);
+	// Does not take any locks; this is called on every access to a cached page.
+	void bumpPage(CachePage *page) {
+		if(!page->referenced.load(std::memory_order_relaxed))
+			page->referenced.store(true, std::memory_order_relaxed);
 	}
 
 	auto awaitReclaim(CacheBundle *bundle, async::cancellation_token ct = {}) {
@@ -82,8 +124,7 @@ struct MemoryReclaimer {
 				bundle->_reclaimEvent.async_wait(ct),
 				[] (auto) { }
 			),
-			// TODO: Use the reclaim fiber, not WorkQueue::generalQueue().
-			WorkQueue::generalQueue()->schedule()
+			_fiber->associatedWorkQueue()->schedule()
 		);
 	}
 
@@ -91,21 +132,32 @@ struct MemoryReclaimer {
 		auto irqLock = frg::guard(&irqMutex());
 		auto lock = frg::guard(&_mutex);
 
-		if(bundle->_reclaimList.empty())
-			return nullptr;
+		while(!bundle->_reclaimList.empty()) {
+			auto page = bundle->_reclaimList.pop_front();
 
-		auto page = bundle->_reclaimList.pop_front();
+			assert(page->flags & CachePage::reclaimRegistered);
+			assert(page->flags & CachePage::reclaimPosted);
+			assert(!(page->flags & CachePage::reclaimInflight));
 
-		assert(page->flags & CachePage::reclaimRegistered);
-		assert(page->flags & CachePage::reclaimPosted);
-		assert(!(page->flags & CachePage::reclaimInflight));
+			// The page was accessed after it was posted; keep it.
+			if(page->referenced.exchange(false, std::memory_order_relaxed)) {
+				page->flags &= ~CachePage::reclaimPosted;
+				page->flags |= CachePage::reclaimActive;
+				_activeList.push_back(page);
+				++_numActive;
+				_cachedSize += kPageSize;
+				continue;
+			}
 
-		page->flags |= CachePage::reclaimInflight;
+			page->flags |= CachePage::reclaimInflight;
+			return page;
+		}
 
-		return page;
+		return nullptr;
 	}
 
 	void runReclaimFiber() {
+		// Returns true if the fiber should continue to reclaim pages.
 		auto checkReclaim = [this] () -> bool {
 			if(disableUncaching)
 				return false;
@@ -113,7 +165,7 @@ struct MemoryReclaimer {
 			auto irqLock = frg::guard(&irqMutex());
 			auto lock = frg::guard(&_mutex);
 
-			if(_lruList.empty())
+			if(_inactiveList.empty() && _activeList.empty())
 				return false;
 
 			if(!tortureUncaching) {
@@ -129,7 +181,9 @@ struct MemoryReclaimer {
 				}
 			}
 
-			auto page = _lruList.pop_front();
+			auto page = _scanInactive();
+			if(!page)
+				return true;
 
 			assert(page->flags & CachePage::reclaimRegistered);
 			assert(!(page->flags & CachePage::reclaimPosted));
@@ -144,15 +198,19 @@ struct MemoryReclaimer {
 			return true;
 		};
 
-		KernelFiber::run([=, this] {
+		// Evictions are driven by the ManagedSpace coroutines that run on
+		// the work queue of this fiber (see awaitReclaim()).
+		_fiber = KernelFiber::post([=, this] {
 			while(true) {
 				if(logUncaching) {
 					auto irqLock = frg::guard(&irqMutex());
 					auto lock = frg::guard(&_mutex);
 					infoLogger() << "thor: " << (_cachedSize / 1024)
-							<< " KiB of cached pages" << frg::endlog;
+							<< " KiB of cached pages (" << _numActive << " active, "
+							<< _numInactive << " inactive)" << frg::endlog;
 				}
 
+				_drainAllBatches();
 				while(checkReclaim())
 					;
 				if(tortureUncaching) {
@@ -162,21 +220,88 @@ struct MemoryReclaimer {
 				}
 			}
 		});
+		Scheduler::resume(_fiber);
 	}
 
 private:
-	frg::ticket_spinlock _mutex;
+	// Must be called with IRQs disabled and the batch's lock held.
+	void _drainBatch(ReclaimBatch &batch) {
+		auto lock = frg::guard(&_mutex);
 
-	frg::intrusive_list<
-		CachePage,
-		frg::locate_member<
-			CachePage,
-			frg::default_list_hook<CachePage>,
-			&CachePage::listHook
-		>
-	> _lruList;
+		while(!batch.pages.empty()) {
+			auto page = batch.pages.pop_front();
+			page->batchCpu.store(-1, std::memory_order_relaxed);
+
+			assert(!(page->flags & CachePage::reclaimRegistered));
+			page->flags |= CachePage::reclaimRegistered;
+			_inactiveList.push_back(page);
+			++_numInactive;
+			_cachedSize += kPageSize;
+		}
+		batch.numPages = 0;
+	}
+
+	void _drainAllBatches() {
+		for(size_t i = 0; i < getCpuCount(); ++i) {
+			auto irqLock = frg::guard(&irqMutex());
+			auto &batch = reclaimBatch.getFor(i);
+			auto lock = frg::guard(&batch.mutex);
+			_drainBatch(batch);
+		}
+	}
+
+	// Demotes pages from the active list until it is not larger than the inactive list.
+	// Referenced pages get another round on the active list.
+	// Must be called with _mutex held.
+	void _balanceLists() {
+		for(size_t i = 0; i < reclaimScanBatch && _numActive > _numInactive; ++i) {
+			auto page = _activeList.pop_front();
+			if(page->referenced.exchange(false, std::memory_order_relaxed)) {
+				_activeList.push_back(page);
+				continue;
+			}
+
+			page->flags &= ~CachePage::reclaimActive;
+			--_numActive;
+			_inactiveList.push_back(page);
+			++_numInactive;
+		}
+	}
+
+	// Returns the least recently used page of the inactive list that was not referenced
+	// since the last scan. Returns nullptr if no such page was found within a bounded scan.
+	// Must be called with _mutex held.
+	CachePage *_scanInactive() {
+		_balanceLists();
+
+		for(size_t i = 0; i < reclaimScanBatch && !_inactiveList.empty(); ++i) {
+			auto page = _inactiveList.pop_front();
+			--_numInactive;
+
+			// This is the second access to the page: promote it.
+			if(page->referenced.exchange(false, std::memory_order_relaxed)) {
+				page->flags |= CachePage::reclaimActive;
+				_activeList.push_back(page);
+				++_numActive;
+				continue;
+			}
+
+			return page;
+		}
+
+		return nullptr;
+	}
+
+	ClassSpinlock<"memory-reclaimer"> _mutex;
+
+	CachePageList _activeList;
+	CachePageList _inactiveList;
+	size_t _numActive = 0;
+	size_t _numInactive = 0;
 
 	size_t _cachedSize = 0;
+
+	KernelFiber *_fiber = nullptr;
 };
 
 static frg::manual_box<MemoryReclaimer> globalReclaimer;
@@ -199,6 +324,14 @@ void MemoryView::resize(size_t newSize, async::any_receiver<void> receiver) {
 	panicLogger() << "MemoryView does not support resize!" << frg::endlog;
 }
 
+frg::tuple<PhysicalAddr, CachingMode> MemoryView::peekLargeRange(uintptr_t) {
+	return frg::tuple<PhysicalAddr, CachingMode>{PhysicalAddr(-1), CachingMode::null};
+}
+
+void MemoryView::markAccessed(uintptr_t, size_t) {
+	// Do nothing; only views that are subject to reclaim track accesses.
+}
+
 void MemoryView::fork(async::any_receiver<frg::tuple<Error, smarter::shared_ptr<MemoryView>>> receiver) {
 	receiver.set_value({Error::illegalObject, nullptr});
 }
@@ -445,12 +578,8 @@ ImmediateMemory::ImmediateMemory(size_t length)
 	auto numPages = (length + kPageSize - 1) >> kPageShift;
 	_physicalPages.resize(numPages);
 	for(size_t i = 0; i < numPages; ++i) {
-		auto physical = physicalAllocator->allocate(kPageSize, 64);
+		auto physical = allocateZeroedPage();
 		assert(physical != PhysicalAddr(-1) && "OOM when allocating ImmediateMemory");
-
-		PageAccessor accessor{physical};
-		memset(accessor.get(), 0, kPageSize);
-
 		_physicalPages[i] = physical;
 	}
 }
@@ -470,12 +599,8 @@ void ImmediateMemory::resize(size_t newSize, async::any_receiver<void> receiver)
 		assert(newNumPages >= currentNumPages);
 		_physicalPages.resize(newNumPages);
 		for(size_t i = currentNumPages; i < newNumPages; ++i) {
-			auto physical = physicalAllocator->allocate(kPageSize, 64);
+			auto physical = allocateZeroedPage();
 			assert(physical != PhysicalAddr(-1) && "OOM when allocating ImmediateMemory");
-
-			PageAccessor accessor{physical};
-			memset(accessor.get(), 0, kPageSize);
-
 			_physicalPages[i] = physical;
 		}
 	}
@@ -595,9 +720,9 @@ size_t HardwareMemory::getLength() {
 // --------------------------------------------------------
 
 AllocatedMemory::AllocatedMemory(size_t desiredLngth,
-		int addressBits, size_t desiredChunkSize, size_t chunkAlign)
-: _physicalChunks{*kernelAlloc},
-		_addressBits{addressBits}, _chunkAlign{chunkAlign} {
+		int addressBits, size_t desiredChunkSize, size_t chunkAlign, int numaNode)
+: _physicalChunks{*kernelAlloc}, _largeBlocks{*kernelAlloc},
+		_addressBits{addressBits}, _numaNode{numaNode}, _chunkAlign{chunkAlign} {
 	static_assert(sizeof(unsigned long) == sizeof(uint64_t), "Fix use of __builtin_clzl");
 	_chunkSize = size_t(1) << (64 - __builtin_clzl(desiredChunkSize - 1));
 	if(_chunkSize != desiredChunkSize)
@@ -614,6 +739,8 @@ AllocatedMemory::AllocatedMemory(size_t desiredLngth,
 	assert(_chunkAlign % kPageSize == 0);
 	assert(_chunkSize % _chunkAlign == 0);
 	_physicalChunks.resize(length / _chunkSize, PhysicalAddr(-1));
+	if(_chunkSize == kPageSize)
+		_largeBlocks.resize(length >> kLargePageShift, false);
 }
 
 AllocatedMemory::~AllocatedMemory() {
@@ -622,7 +749,13 @@ AllocatedMemory::~AllocatedMemory() {
 	if(logUsage)
 		infoLogger() << "thor: Releasing AllocatedMemory ("
 				<< (physicalAllocator->numUsedPages() * 4) << " KiB in use)" << frg::endlog;
+	constexpr size_t pagesPerBlock = kLargePageSize / kPageSize;
 	for(size_t i = 0; i < _physicalChunks.size(); ++i) {
+		if(i < _largeBlocks.size() * pagesPerBlock && _largeBlocks[i / pagesPerBlock]) {
+			physicalAllocator->free(_physicalChunks[i], kLargePageSize);
+			i += pagesPerBlock - 1;
+			continue;
+		}
 		if(_physicalChunks[i] != PhysicalAddr(-1))
 			physicalAllocator->free(_physicalChunks[i], _chunkSize);
 	}
@@ -640,6 +773,8 @@ void AllocatedMemory::resize(size_t newSize, async::any_receiver<void> receiver)
 		size_t num_chunks = newSize / _chunkSize;
 		assert(num_chunks >= _physicalChunks.size());
 		_physicalChunks.resize(num_chunks, PhysicalAddr(-1));
+		if(_chunkSize == kPageSize)
+			_largeBlocks.resize(newSize >> kLargePageShift, false);
 	}
 	receiver.set_value();
 }
@@ -675,8 +810,93 @@ frg::tuple<PhysicalAddr, CachingMode> AllocatedMemory::peekRange(uintptr_t offse
 			CachingMode::null};
 }
 
+frg::tuple<PhysicalAddr, CachingMode> AllocatedMemory::peekLargeRange(uintptr_t offset) {
+	assert(!(offset & (kLargePageSize - 1)));
+
+	auto irq_lock = frg::guard(&irqMutex());
+	auto lock = frg::guard(&_mutex);
+
+	auto block = offset >> kLargePageShift;
+	if(block >= _largeBlocks.size() || !_largeBlocks[block])
+		return frg::tuple<PhysicalAddr, CachingMode>{PhysicalAddr(-1), CachingMode::null};
+	return frg::tuple<PhysicalAddr, CachingMode>{_physicalChunks[offset / kPageSize],
+			CachingMode::null};
+}
+
+bool AllocatedMemory::_isLargeBlockUnpopulated(size_t block) {
+	constexpr size_t pagesPerBlock = kLargePageSize / kPageSize;
+	if(block >= _largeBlocks.size())
+		return false;
+
+	// We only use large frames for blocks that are not populated yet.
+	auto first = block * pagesPerBlock;
+	for(size_t i = 0; i < pagesPerBlock; ++i) {
+		if(_physicalChunks[first + i] != PhysicalAddr(-1))
+			return false;
+	}
+	return true;
+}
+
+PhysicalAddr AllocatedMemory::_allocateZeroedLargeFrame() {
+	auto physical = physicalAllocator->allocate(kLargePageSize, _addressBits, _numaNode);
+	if(physical == PhysicalAddr(-1))
+		return PhysicalAddr(-1);
+	if(physical & (kLargePageSize - 1)) {
+		// The buddy allocator only aligns frames relative to the start of their region.
+		physicalAllocator->free(physical, kLargePageSize);
+		return PhysicalAddr(-1);
+	}
+
+	for(size_t pg_progress = 0; pg_progress < kLargePageSize; pg_progress += kPageSize) {
+		PageAccessor accessor{physical + pg_progress};
+		zeroPage(accessor.get());
+	}
+	return physical;
+}
+
 coroutine<frg::expected<Error, PhysicalRange>>
 AllocatedMemory::fetchRange(uintptr_t offset, FetchFlags, smarter::shared_ptr<WorkQueue>) {
+	constexpr size_t pagesPerBlock = kLargePageSize / kPageSize;
+	auto block = offset >> kLargePageShift;
+
+	// Zeroing a large frame takes too long to do it with IRQs disabled;
+	// hence, we allocate it without holding the lock and re-check afterwards.
+	bool tryLargeBlock;
+	{
+		auto irq_lock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&_mutex);
+
+		tryLargeBlock = _isLargeBlockUnpopulated(block);
+	}
+
+	if(tryLargeBlock) {
+		auto physical = _allocateZeroedLargeFrame();
+		if(physical != PhysicalAddr(-1)) {
+			bool installed = false;
+			{
+				auto irq_lock = frg::guard(&irqMutex());
+				auto lock = frg::guard(&_mutex);
+
+				if(_isLargeBlockUnpopulated(block)) {
+					auto first = block * pagesPerBlock;
+					for(size_t i = 0; i < pagesPerBlock; ++i)
+						_physicalChunks[first + i] = physical + i * kPageSize;
+					_largeBlocks[block] = true;
+					installed = true;
+				}
+			}
+
+			if(installed) {
+				auto largeDisp = offset & (kLargePageSize - 1);
+				co_return PhysicalRange{physical + largeDisp,
+						kLargePageSize - largeDisp, CachingMode::null};
+			}
+
+			// Another fault populated (parts of) the block in the meantime.
+			physicalAllocator->free(physical, kLargePageSize);
+		}
+	}
+
 	auto irq_lock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&_mutex);
 
@@ -684,14 +904,18 @@ AllocatedMemory::fetchRange(uintptr_t offset, FetchFlags, smarter::shared_ptr<Wo
 	auto disp = offset & (_chunkSize - 1);
 	assert(index < _physicalChunks.size());
 
-	if(_physicalChunks[index] == PhysicalAddr(-1)) {
-		auto physical = physicalAllocator->allocate(_chunkSize, _addressBits);
+	if(_physicalChunks[index] == PhysicalAddr(-1) && _chunkSize == kPageSize) {
+		auto physical = allocateZeroedPage(_addressBits, _numaNode);
+		assert(physical != PhysicalAddr(-1) && "OOM");
+		_physicalChunks[index] = physical;
+	}else if(_physicalChunks[index] == PhysicalAddr(-1)) {
+		auto physical = physicalAllocator->allocate(_chunkSize, _addressBits, _numaNode);
 		assert(physical != PhysicalAddr(-1) && "OOM");
 		assert(!(physical & (_chunkAlign - 1)));
 
 		for(size_t pg_progress = 0; pg_progress < _chunkSize; pg_progress += kPageSize) {
 			PageAccessor accessor{physical + pg_progress};
-			memset(accessor.get(), 0, kPageSize);
+			zeroPage(accessor.get());
 		}
 		_physicalChunks[index] = physical;
 	}
@@ -1030,11 +1254,8 @@ BackingMemory::fetchRange(uintptr_t offset, FetchFlags, smarter::shared_ptr<Work
 	assert(pit);
 
 	if(pit->physical == PhysicalAddr(-1)) {
-		PhysicalAddr physical = physicalAllocator->allocate(kPageSize);
+		PhysicalAddr physical = allocateZeroedPage();
 		assert(physical != PhysicalAddr(-1) && "OOM");
-
-		PageAccessor accessor{physical};
-		memset(accessor.get(), 0, kPageSize);
 		pit->physical = physical;
 	}
 
@@ -1176,6 +1397,26 @@ frg::tuple<PhysicalAddr, CachingMode> FrontalMemory::peekRange(uintptr_t offset)
 	}
 }
 
+void FrontalMemory::markAccessed(uintptr_t offset, size_t size) {
+	assert(!(offset % kPageSize));
+
+	auto irq_lock = frg::guard(&irqMutex());
+	auto lock = frg::guard(&_managed->mutex);
+
+	for(size_t progress = 0; progress < size; progress += kPageSize) {
+		auto index = (offset + progress) / kPageSize;
+		if(index >= _managed->numPages)
+			break;
+		auto pit = _managed->pages.find(index);
+		if(!pit)
+			continue;
+
+		// Same as in fetchRange(); locked pages are not on the reclaimer's list.
+		if(pit->loadState == ManagedSpace::kStatePresent && !pit->lockCount)
+			globalReclaimer->bumpPage(&pit->cachePage);
+	}
+}
+
 coroutine<frg::expected<Error, PhysicalRange>>
 FrontalMemory::fetchRange(uintptr_t offset, FetchFlags flags, smarter::shared_ptr<WorkQueue>) {
 	auto index = offset >> kPageShift;
@@ -1466,6 +1707,53 @@ Error IndirectMemory::setIndirection(size_t slot, smarter::shared_ptr<MemoryView
 	return Error::success;
 }
 
+// --------------------------------------------------------
+// PageIndexSet
+// --------------------------------------------------------
+
+PageIndexSet::~PageIndexSet() {
+	while(auto group = _groups.get_root()) {
+		_groups.remove(group);
+		frg::destruct(*kernelAlloc, group);
+	}
+}
+
+auto PageIndexSet::_findGroup(uint64_t base) -> Group * {
+	auto current = _groups.get_root();
+	while(current) {
+		if(base < current->base) {
+			current = GroupTree::get_left(current);
+		}else if(base > current->base) {
+			current = GroupTree::get_right(current);
+		}else{
+			return current;
+		}
+	}
+	return nullptr;
+}
+
+void PageIndexSet::insert(uint64_t index) {
+	auto base = index >> groupShift;
+	auto group = _findGroup(base);
+	if(!group) {
+		group = frg::construct<Group>(*kernelAlloc);
+		group->base = base;
+		_groups.insert(group);
+	}
+	group->mask |= uint64_t{1} << (index & ((1 << groupShift) - 1));
+}
+
+void PageIndexSet::erase(uint64_t index) {
+	auto group = _findGroup(index >> groupShift);
+	if(!group)
+		return;
+	group->mask &= ~(uint64_t{1} << (index & ((1 << groupShift) - 1)));
+	if(!group->mask) {
+		_groups.remove(group);
+		frg::destruct(*kernelAlloc, group);
+	}
+}
+
 // --------------------------------------------------------
 // CopyOnWriteMemory
 // --------------------------------------------------------
@@ -1522,7 +1810,7 @@ void CopyOnWriteMemory::fork(async::any_receiver<frg::tuple<Error, smarter::shar
 				// As the page is locked anyway, we can just copy it synchronously.
 				PageAccessor lockedAccessor{page->physical};
 				PageAccessor copyAccessor{copyPhysical};
-				memcpy(copyAccessor.get(), lockedAccessor.get(), kPageSize);
+				copyPage(copyAccessor.get(), lockedAccessor.get());
 
 				// Update the chains.
 				auto copyPage = smarter::allocate_shared<CowPage>(*kernelAlloc);
@@ -1530,6 +1818,7 @@ void CopyOnWriteMemory::fork(async::any_receiver<frg::tuple<Error, smarter::shar
 				copyPage->physical = copyPhysical;
 				auto copyIt = forked->_ownedPages.insert(pg >> kPageShift);
 				*copyIt = copyPage;
+				forked->_ownedIndices.insert(pg >> kPageShift);
 			}else{
 				auto physical = page->physical;
 				assert(physical != PhysicalAddr(-1));
@@ -1538,7 +1827,9 @@ void CopyOnWriteMemory::fork(async::any_receiver<frg::tuple<Error, smarter::shar
 				auto pageOffset = self->_viewOffset + pg;
 				auto newIt = newChain->_pages.insert(pageOffset >> kPageShift);
 				*newIt = page.lock();
+				newChain->_indices.insert(pageOffset >> kPageShift);
 				self->_ownedPages.erase(pg >> kPageShift);
+				self->_ownedIndices.erase(pg >> kPageShift);
 			}
 		};
 
@@ -1560,25 +1851,39 @@ void CopyOnWriteMemory::fork(async::any_receiver<frg::tuple<Error, smarter::shar
 							self->_view, self->_viewOffset, self->_length, newChain);
 			forked->selfPtr = forked;
 
+			// We only visit populated entries, such that the cost of fork()
+			// is proportional to the number of resident pages, not to _length.
+
+			// Pages that are missing in this memory object are taken from the CowChain.
+			if(curChain) {
+				auto chainLock = frg::guard(&curChain->_mutex);
+
+				auto firstIndex = self->_viewOffset >> kPageShift;
+				curChain->_indices.forEach(firstIndex, firstIndex + (self->_length >> kPageShift),
+						[&] (uint64_t index) {
+					if(self->_ownedPages.find(index - firstIndex))
+						return;
+
+					auto it = curChain->_pages.find(index);
+					assert(it);
+					auto page = *it;
+					assert(page->state == CowState::hasCopy);
+					auto newIt = newChain->_pages.insert(index);
+					*newIt = page;
+					newChain->_indices.insert(index);
+				});
+			}
+
 			// Inspect all copied pages owned by the original mapping.
-			for(size_t pg = 0; pg < self->_length; pg += kPageSize) {
-				auto it = self->_ownedPages.find(pg >> kPageShift);
+			// As doCopyOnePage() modifies _ownedIndices, collect the pages first.
+			frg::vector<size_t, KernelAlloc> ownedPages{*kernelAlloc};
+			self->_ownedIndices.forEach(0, self->_length >> kPageShift, [&] (uint64_t index) {
+				ownedPages.push(index << kPageShift);
+			});
 
-				if(!it) {
-					// If the page is missing in this memory object, look at the CowChain.
-					auto pageOffset = self->_viewOffset + pg;
-					if (curChain) {
-						auto chainLock = frg::guard(&curChain->_mutex);
-
-						if(auto it = curChain->_pages.find(pageOffset >> kPageShift); it) {
-							auto page = *it;
-							assert(page->state == CowState::hasCopy);
-							auto newIt = newChain->_pages.insert(pageOffset >> kPageShift);
-							*newIt = page;
-						}
-					}
-					continue;
-				}
+			for(auto pg : ownedPages) {
+				auto it = self->_ownedPages.find(pg >> kPageShift);
+				assert(it);
 
 				auto page = *it;
 				if(page->state == CowState::inProgress) {
@@ -1677,6 +1982,7 @@ bool CopyOnWriteMemory::asyncLockRange(uintptr_t offset, size_t size,
 					cowPage->state = CowState::inProgress;
 					cowIt = self->_ownedPages.insert(offset >> kPageShift);
 					*cowIt = cowPage;
+					self->_ownedIndices.insert(offset >> kPageShift);
 				}
 			}
 
@@ -1707,13 +2013,9 @@ bool CopyOnWriteMemory::asyncLockRange(uintptr_t offset, size_t size,
 				continue;
 			}
 
-			PhysicalAddr physical = physicalAllocator->allocate(kPageSize);
-			assert(physical != PhysicalAddr(-1) && "OOM");
-			PageAccessor accessor{physical};
-
 			// Try to copy from a descendant CoW chain.
 			auto pageOffset = viewOffset + offset;
-			bool chainHasCopy = false;
+			PhysicalAddr physical = PhysicalAddr(-1);
 			if(chain) {
 				auto irqLock = frg::guard(&irqMutex());
 				auto lock = frg::guard(&chain->_mutex);
@@ -1724,18 +2026,28 @@ bool CopyOnWriteMemory::asyncLockRange(uintptr_t offset, size_t size,
 					assert(page->state == CowState::hasCopy);
 					auto srcPhysical = page->physical;
 					assert(srcPhysical != PhysicalAddr(-1));
+					physical = physicalAllocator->allocate(kPageSize);
+					assert(physical != PhysicalAddr(-1) && "OOM");
+					PageAccessor accessor{physical};
 					auto srcAccessor = PageAccessor{srcPhysical};
-					memcpy(accessor.get(), srcAccessor.get(), kPageSize);
-					chainHasCopy = true;
+					copyPage(accessor.get(), srcAccessor.get());
 				}
 			}
 
-			// Copy from the root view.
-			if(!chainHasCopy) {
-				// TODO: Handle errors here -- we need to drop the lock again.
-				auto copyOutcome = co_await view->copyFrom(pageOffset & ~(kPageSize - 1),
-						accessor.get(), kPageSize, wq);
-				assert(copyOutcome);
+			// Copy from the root view. Copies of the zero view can be taken from the zero pool.
+			if(physical == PhysicalAddr(-1)) {
+				if(view.get() == getZeroMemory().get()) {
+					physical = allocateZeroedPage();
+					assert(physical != PhysicalAddr(-1) && "OOM");
+				}else{
+					physical = physicalAllocator->allocate(kPageSize);
+					assert(physical != PhysicalAddr(-1) && "OOM");
+					PageAccessor accessor{physical};
+					// TODO: Handle errors here -- we need to drop the lock again.
+					auto copyOutcome = co_await view->copyFrom(pageOffset & ~(kPageSize - 1),
+							accessor.get(), kPageSize, wq);
+					assert(copyOutcome);
+				}
 			}
 
 			// To make CoW unobservable, we first need to evict the page here.
@@ -1821,6 +2133,7 @@ CopyOnWriteMemory::fetchRange(uintptr_t offset, FetchFlags, smarter::shared_ptr<
 			cowPage->state = CowState::inProgress;
 			cowIt = _ownedPages.insert(offset >> kPageShift);
 			*cowIt = cowPage;
+			_ownedIndices.insert(offset >> kPageShift);
 		}
 	}
 
@@ -1843,13 +2156,9 @@ CopyOnWriteMemory::fetchRange(uintptr_t offset, FetchFlags, smarter::shared_ptr<
 		co_return PhysicalRange{cowPage->physical, kPageSize, CachingMode::null};
 	}
 
-	PhysicalAddr physical = physicalAllocator->allocate(kPageSize);
-	assert(physical != PhysicalAddr(-1) && "OOM");
-	PageAccessor accessor{physical};
-
 	// Try to copy from a descendant CoW chain.
 	auto pageOffset = viewOffset + offset;
-	bool chainHasCopy = false;
+	PhysicalAddr physical = PhysicalAddr(-1);
 	if(chain) {
 		auto irqLock = frg::guard(&irqMutex());
 		auto lock = frg::guard(&chain->_mutex);
@@ -1860,16 +2169,26 @@ CopyOnWriteMemory::fetchRange(uintptr_t offset, FetchFlags, smarter::shared_ptr<
 			assert(page->state == CowState::hasCopy);
 			auto srcPhysical = page->physical;
 			assert(srcPhysical != PhysicalAddr(-1));
+			physical = physicalAllocator->allocate(kPageSize);
+			assert(physical != PhysicalAddr(-1) && "OOM");
+			PageAccessor accessor{physical};
 			auto srcAccessor = PageAccessor{srcPhysical};
-			memcpy(accessor.get(), srcAccessor.get(), kPageSize);
-			chainHasCopy = true;
+			copyPage(accessor.get(), srcAccessor.get());
 		}
 	}
 
-	// Copy from the root view.
-	if(!chainHasCopy) {
-		FRG_CO_TRY(co_await view->copyFrom(pageOffset & ~(kPageSize - 1),
-				accessor.get(), kPageSize, wq));
+	// Copy from the root view. Copies of the zero view can be taken from the zero pool.
+	if(physical == PhysicalAddr(-1)) {
+		if(view.get() == getZeroMemory().get()) {
+			physical = allocateZeroedPage();
+			assert(physical != PhysicalAddr(-1) && "OOM");
+		}else{
+			physical = physicalAllocator->allocate(kPageSize);
+			assert(physical != PhysicalAddr(-1) && "OOM");
+			PageAccessor accessor{physical};
+			FRG_CO_TRY(co_await view->copyFrom(pageOffset & ~(kPageSize - 1),
+					accessor.get(), kPageSize, wq));
+		}
 	}
 
 	// To make CoW unobservable, we first need to evict the page here.
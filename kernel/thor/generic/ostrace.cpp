@@ -3,9 +3,13 @@
 #include <frg/cmdline.hpp>
 #include <frg/small_vector.hpp>
 #include <frg/span.hpp>
+#include <frg/string.hpp>
+#include <protocols/ostrace/ring.hpp>
 #include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
 #include <thor-internal/kernel-io.hpp>
 #include <thor-internal/main.hpp>
+#include <thor-internal/memory-view.hpp>
 #include <thor-internal/ostrace.hpp>
 #include <thor-internal/stream.hpp>
 #include <thor-internal/timer.hpp>
@@ -43,6 +47,7 @@ initgraph::Task initOsTraceCore{&globalInitEngine, "generic.init-ostrace-core",
 		if(!wantOsTrace)
 			return;
 
+		// Per-CPU rings are drained into this ring.
 		void *osTraceMemory = kernelAlloc->allocate(1 << 20);
 		globalOsTraceRing.initialize(reinterpret_cast<uintptr_t>(osTraceMemory), 1 << 20);
 
@@ -52,25 +57,139 @@ initgraph::Task initOsTraceCore{&globalInitEngine, "generic.init-ostrace-core",
 	}
 };
 
+// Header of records in the global ring.
+struct Header {
+	uint32_t size;
+};
+
+// Header of records in the per-CPU rings. It is followed by a record in the format of the
+// global ring (i.e., Header + payload), such that the drain fiber can copy it verbatim.
+struct PerCpuHeader {
+	uint64_t ts;
+	uint64_t seq;
+};
+
+// Records must fit into the per-CPU ring; larger records are dropped.
+constexpr size_t maxRecordSize = 16 * 1024;
+
 void doEmit(frg::span<char> payload) {
 	if(!osTraceInUse.load(std::memory_order_relaxed))
 		return;
 
-	struct Header {
-		uint32_t size;
-	};
-
 	frg::small_vector<char, 64, KernelAlloc> buffer{*kernelAlloc};
-	buffer.resize(sizeof(Header) + payload.size());
+	buffer.resize(sizeof(PerCpuHeader) + sizeof(Header) + payload.size());
 
-	auto hdr = new (buffer.data()) Header;
+	auto hdr = new (buffer.data() + sizeof(PerCpuHeader)) Header;
 	hdr->size = payload.size();
 
-	memcpy(buffer.data() + sizeof(Header), payload.data(), payload.size());
+	memcpy(buffer.data() + sizeof(PerCpuHeader) + sizeof(Header),
+			payload.data(), payload.size());
+
+	// Disabling IRQs makes us the only producer of this CPU's ring.
+	// Waking up the drain fiber is not necessary since it polls the per-CPU rings.
+	auto irqLock = frg::guard(&irqMutex());
+	auto ctx = &ostrace::context.get();
+
+	auto ring = ctx->ring.load(std::memory_order_relaxed);
+	if(!ring) {
+		ring = frg::construct<SingleContextRecordRing>(*kernelAlloc);
+		ctx->ring.store(ring, std::memory_order_release);
+	}
+
+	auto pcHdr = new (buffer.data()) PerCpuHeader;
+	pcHdr->ts = haveTimer() ? getClockNanos() : 0;
+	pcHdr->seq = ctx->nextSeq++;
 
-	// We want to be able to call this function from any context, but we cannot wake the waiters
-	// in all contexts. For now, only wake waiters if IRQs are enabled.
-	globalOsTraceRing->enqueue(buffer.data(), buffer.size(), !intsAreEnabled());
+	// The drain fiber notices the gap in the sequence numbers.
+	if(buffer.size() > maxRecordSize)
+		return;
+	ring->enqueue(buffer.data(), buffer.size());
+}
+
+// Moves records from the per-CPU rings to the global ring.
+// Among the records that are available in the per-CPU rings, the oldest one is moved first.
+coroutine<void> drainPerCpuRings() {
+	struct Cursor {
+		frg::vector<char, KernelAlloc> buffer{*kernelAlloc};
+		uint64_t deqPtr{0};
+		uint64_t expectedSeq{0};
+		// Whether buffer contains a record that still needs to be moved.
+		bool valid{false};
+		size_t size{0};
+		uint64_t ts{0};
+	};
+
+	frg::vector<Cursor, KernelAlloc> cursors{*kernelAlloc};
+
+	auto refill = [&] (size_t cpu) {
+		auto &cursor = cursors[cpu];
+		auto &ctx = ostrace::context.getFor(cpu);
+		if(cursor.valid)
+			return;
+		auto ring = ctx.ring.load(std::memory_order_acquire);
+		if(!ring)
+			return;
+
+		auto [success, recordPtr, nextPtr, size] = ring->dequeueAt(cursor.deqPtr,
+				cursor.buffer.data(), cursor.buffer.size());
+		cursor.deqPtr = nextPtr;
+		if(!success)
+			return;
+		assert(size >= sizeof(PerCpuHeader) + sizeof(Header));
+
+		PerCpuHeader pcHdr;
+		memcpy(&pcHdr, cursor.buffer.data(), sizeof(PerCpuHeader));
+		if(pcHdr.seq != cursor.expectedSeq) {
+			assert(pcHdr.seq > cursor.expectedSeq);
+			auto numLost = pcHdr.seq - cursor.expectedSeq;
+			ctx.numDropped.fetch_add(numLost, std::memory_order_relaxed);
+			infoLogger() << "thor: " << numLost << " ostrace records were dropped on CPU "
+					<< cpu << frg::endlog;
+		}
+		cursor.expectedSeq = pcHdr.seq + 1;
+		cursor.valid = true;
+		cursor.size = size;
+		cursor.ts = pcHdr.ts;
+	};
+
+	while(true) {
+		while(cursors.size() < getCpuCount()) {
+			cursors.emplace_back();
+			cursors.back().buffer.resize(maxRecordSize);
+		}
+
+		while(true) {
+			// Re-check all empty rings before picking a record: if a record on one CPU
+			// causally depends on a record of another CPU (e.g., an item definition),
+			// we see the latter before moving the former.
+			// doEmit() takes the timestamp and enqueues with IRQs disabled, hence the latter
+			// is enqueued before the former's timestamp is taken. We keep polling until
+			// a full pass that starts after we observed the oldest record does not find
+			// an older one; such a pass sees all records that precede it.
+			Cursor *oldest = nullptr;
+			while(true) {
+				bool changed = false;
+				for(size_t cpu = 0; cpu < cursors.size(); ++cpu) {
+					refill(cpu);
+					auto &cursor = cursors[cpu];
+					if(cursor.valid && (!oldest || cursor.ts < oldest->ts)) {
+						oldest = &cursor;
+						changed = true;
+					}
+				}
+				if(!changed)
+					break;
+			}
+			if(!oldest)
+				break;
+
+			globalOsTraceRing->enqueue(oldest->buffer.data() + sizeof(PerCpuHeader),
+					oldest->size - sizeof(PerCpuHeader));
+			oldest->valid = false;
+		}
+
+		co_await generalTimerEngine()->sleepFor(1'000'000);
+	}
 }
 
 template<typename R>
@@ -95,6 +214,123 @@ LogRingBuffer *getGlobalOsTraceRing() {
 	return globalOsTraceRing.get();
 }
 
+namespace {
+
+struct OsTraceStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		for(size_t i = 0; i < getCpuCount(); ++i) {
+			auto &ctx = ostrace::context.getFor(i);
+			sink.emitIndexed("ostrace.cpu", i, ".dropped",
+					ctx.numDropped.load(std::memory_order_relaxed));
+		}
+	}
+};
+
+constinit OsTraceStatisticsSource osTraceStatisticsSource;
+
+initgraph::Task initOsTraceStatistics{&globalInitEngine, "generic.init-ostrace-statistics",
+	initgraph::Requires{&initOsTraceCore, getFibersAvailableStage()},
+	[] {
+		if(!wantOsTrace)
+			return;
+		registerStatisticsSource(&osTraceStatisticsSource);
+	}
+};
+
+} // anonymous namespace
+
+// --------------------------------------------------------------------------------------
+// Shared-memory rings of user space ostrace contexts.
+// --------------------------------------------------------------------------------------
+
+namespace {
+
+// Size of the record area of each ring. Must be a power of two.
+constexpr size_t userRingSize = 64 * 1024;
+
+// Moves committed records from the ring to the per-CPU ring.
+// Since user space can write to the whole ring, tail is kept by the caller and only
+// published to the header. Each call drains at most userRingSize bytes; this is enough
+// to drain all records of a well-behaved producer.
+// Returns false if user space corrupted the ring.
+bool drainUserRing(ImmediateMemory *memory, frg::span<char> buffer, uint64_t &tail) {
+	using namespace protocols::ostrace;
+
+	auto header = memory->accessImmediate<RingHeader>(0);
+	size_t drained = 0;
+	while(drained < userRingSize) {
+		auto recordOffset = tail & (userRingSize - 1);
+		auto recordHeader = memory->accessImmediate<RingRecordHeader>(
+				ringDataOffset + recordOffset);
+		if(!__atomic_load_n(&recordHeader->committed, __ATOMIC_ACQUIRE))
+			break;
+		auto size = __atomic_load_n(&recordHeader->size, __ATOMIC_RELAXED);
+		if(size > ringMaxPayloadSize)
+			return false;
+		assert(size <= buffer.size());
+
+		// The payload may wrap around the end of the ring.
+		auto payloadOffset = (recordOffset + sizeof(RingRecordHeader)) & (userRingSize - 1);
+		auto preWrapSize = frg::min(userRingSize - payloadOffset, static_cast<size_t>(size));
+		memory->readImmediate(ringDataOffset + payloadOffset, buffer.data(), preWrapSize);
+		memory->readImmediate(ringDataOffset, buffer.data() + preWrapSize, size - preWrapSize);
+		doEmit({buffer.data(), size});
+
+		// Clear the record such that its contents are never mistaken for a record header.
+		auto recordSize = ringRecordSize(size);
+		auto preWrapRecordSize = frg::min(userRingSize - recordOffset, recordSize);
+		memory->zeroImmediate(ringDataOffset + recordOffset, preWrapRecordSize);
+		memory->zeroImmediate(ringDataOffset, recordSize - preWrapRecordSize);
+
+		tail += recordSize;
+		drained += recordSize;
+		__atomic_store_n(&header->tail, tail, __ATOMIC_RELEASE);
+	}
+	return true;
+}
+
+// Polls the ring until user space closes the conversation that was used to open the ring.
+coroutine<void> runUserRing(smarter::shared_ptr<ImmediateMemory> memory, LaneHandle lane) {
+	std::atomic<bool> closed{false};
+	// This coroutine only finishes after closed is set; hence, the reference stays valid.
+	async::detach_with_allocator(*kernelAlloc, [] (LaneHandle lane,
+			std::atomic<bool> *closed) -> coroutine<void> {
+		// User space never sends anything; this completes once the lane is closed.
+		co_await RecvBufferSender{lane};
+		closed->store(true, std::memory_order_release);
+	}(lane, &closed));
+
+	frg::vector<char, KernelAlloc> buffer{*kernelAlloc};
+	buffer.resize(protocols::ostrace::ringMaxPayloadSize);
+
+	auto header = memory->accessImmediate<protocols::ostrace::RingHeader>(0);
+	uint64_t tail = 0;
+	uint64_t reportedDrops = 0;
+	while(true) {
+		// Load closed before draining such that we drain all records emitted before the close.
+		bool wasClosed = closed.load(std::memory_order_acquire);
+		if(!drainUserRing(memory.get(), {buffer.data(), buffer.size()}, tail)) {
+			infoLogger() << "thor: Corrupted ostrace ring, ignoring further records" << frg::endlog;
+			while(!closed.load(std::memory_order_acquire))
+				co_await generalTimerEngine()->sleepFor(100'000'000);
+			break;
+		}
+
+		auto dropped = __atomic_load_n(&header->dropped, __ATOMIC_RELAXED);
+		if(dropped != reportedDrops) {
+			infoLogger() << "thor: " << (dropped - reportedDrops)
+					<< " ostrace records were dropped by user space" << frg::endlog;
+			reportedDrops = dropped;
+		}
+
+		if(wasClosed)
+			break;
+		co_await generalTimerEngine()->sleepFor(1'000'000);
+	}
+}
+
+} // anonymous namespace
+
 // --------------------------------------------------------------------------------------
 // mbus object handling.
 // --------------------------------------------------------------------------------------
@@ -215,6 +451,44 @@ private:
 				co_return Error::protocolViolation;
 			}
 		} break;
+		case bragi::message_id<managarm::ostrace::OpenRingReq>: {
+			auto maybeReq = bragi::parse_head_only<managarm::ostrace::OpenRingReq>(
+					reqSpan, *kernelAlloc);
+			if(!maybeReq)
+				co_return Error::protocolViolation;
+
+			smarter::shared_ptr<ImmediateMemory> memory;
+			managarm::ostrace::Response<KernelAlloc> resp(*kernelAlloc);
+			if(wantOsTrace) {
+				memory = smarter::allocate_shared<ImmediateMemory>(*kernelAlloc,
+						protocols::ostrace::ringDataOffset + userRingSize);
+				memory->selfPtr = memory;
+				resp.set_error(managarm::ostrace::Error::SUCCESS);
+			}else{
+				resp.set_error(managarm::ostrace::Error::OSTRACE_GLOBALLY_DISABLED);
+			}
+
+			frg::string<KernelAlloc> ser(*kernelAlloc);
+			resp.SerializeToString(&ser);
+			frg::unique_memory<KernelAlloc> respBuffer{*kernelAlloc, ser.size()};
+			memcpy(respBuffer.data(), ser.data(), ser.size());
+			auto respError = co_await SendBufferSender{lane, std::move(respBuffer)};
+			if(respError != Error::success) {
+				assert(isRemoteIpcError(respError));
+				co_return Error::protocolViolation;
+			}
+
+			if(!memory)
+				break;
+			auto memoryError = co_await PushDescriptorSender{lane, MemoryViewDescriptor{memory}};
+			if(memoryError != Error::success) {
+				assert(isRemoteIpcError(memoryError));
+				co_return Error::protocolViolation;
+			}
+
+			async::detach_with_allocator(*kernelAlloc,
+					runUserRing(std::move(memory), std::move(lane)));
+		} break;
 		default:
 			managarm::ostrace::Response<KernelAlloc> resp(*kernelAlloc);
 			resp.set_error(managarm::ostrace::Error::ILLEGAL_REQUEST);
@@ -245,6 +519,9 @@ initgraph::Task initOsTraceMbus{&globalInitEngine, "generic.init-ostrace-sinks",
 			auto ostrace = frg::construct<OstraceBusObject>(*kernelAlloc);
 			async::detach_with_allocator(*kernelAlloc, ostrace->run());
 
+			if(wantOsTrace)
+				async::detach_with_allocator(*kernelAlloc, drainPerCpuRings());
+
 			// Only dump to an I/O channel if ostrace is supported (otherwise, the ring buffer
 			// does not even exist).
 			if(wantOsTrace) {
@@ -284,6 +561,7 @@ void setup() {
 
 	setupTerm(ostEvtArmPreemption);
 	setupTerm(ostEvtArmCpuTimer);
+	setupTerm(ostEvtHandoff);
 	available.store(true, std::memory_order_relaxed);
 }
 
@@ -299,5 +577,6 @@ void emitBuffer(frg::span<char> payload) {
 
 ostrace::Event ostEvtArmPreemption{"thor.arm-preemption"};
 ostrace::Event ostEvtArmCpuTimer{"thor.arm-cpu-timer"};
+ostrace::Event ostEvtHandoff{"thor.handoff"};
 
 } // namespace thor
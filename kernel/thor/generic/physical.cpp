@@ -1,8 +1,16 @@
 #include <assert.h>
+#include <string.h>
+#include <frg/string.hpp>
+#include <initgraph.hpp>
 #include <thor-internal/arch-generic/paging.hpp>
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/debug.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
+#include <thor-internal/kernel_heap.hpp>
+#include <thor-internal/main.hpp>
 #include <thor-internal/physical.hpp>
+#include <thor-internal/util.hpp>
 
 namespace thor {
 
@@ -28,21 +36,30 @@ void poisonPhysicalWriteAccess(PhysicalAddr physical) {
 // --------------------------------------------------------
 
 PhysicalChunkAllocator::PhysicalChunkAllocator() {
+	for(int i = 0; i < maxNumaNodes; i++) {
+		for(int j = 0; j < maxNumaNodes; j++)
+			_distances[i][j] = (i == j) ? localNumaDistance : remoteNumaDistance;
+	}
+	finalizeNumaTopology(1);
 }
 
 void PhysicalChunkAllocator::bootstrapRegion(PhysicalAddr address,
 		int order, size_t numRoots, int8_t *buddyTree) {
-	if(_numRegions >= 8) {
-		infoLogger() << "thor: Ignoring memory region (can only handle 8 regions)"
-				<< frg::endlog;
+	if(_numRegions >= maxRegions) {
+		infoLogger() << "thor: Ignoring memory region (can only handle "
+				<< maxRegions << " regions)" << frg::endlog;
 		return;
 	}
 
 	int n = _numRegions++;
 	_allRegions[n].physicalBase = address;
 	_allRegions[n].regionSize = numRoots << (order + kPageShift);
+	_allRegions[n].buddyTree = buddyTree;
+	_allRegions[n].numRoots = numRoots;
+	_allRegions[n].order = order;
 	_allRegions[n].buddyAccessor = BuddyAccessor{address, kPageShift,
 			buddyTree, numRoots, order};
+	_allRegions[n].freePages.store(numRoots << order, std::memory_order_relaxed);
 
 	auto currentTotal = _totalPages.load(std::memory_order_relaxed);
 	auto currentFree = _freePages.load(std::memory_order_relaxed);
@@ -50,16 +67,376 @@ void PhysicalChunkAllocator::bootstrapRegion(PhysicalAddr address,
 	_freePages.store(currentFree + (numRoots << order), std::memory_order_relaxed);
 }
 
-PhysicalAddr PhysicalChunkAllocator::allocate(size_t size, int addressBits) {
-	auto irq_lock = frg::guard(&irqMutex());
+namespace {
+
+// Offset of the entries of the given order within a buddy tree
+// (see BuddyAccessor::initialize() for the layout).
+size_t buddyLevelOffset(size_t numRoots, int tableOrder, int order) {
+	size_t offset = 0;
+	for(int k = tableOrder; k > order; k--)
+		offset += numRoots << (tableOrder - k);
+	return offset;
+}
+
+// Counts the free pages below the entry at the given order and index.
+size_t countBuddyFreePages(int8_t *tree, size_t numRoots, int tableOrder,
+		int order, size_t index) {
+	auto value = tree[buddyLevelOffset(numRoots, tableOrder, order) + index];
+	if(value == order)
+		return size_t{1} << order;
+	if(value < 0)
+		return 0;
+	return countBuddyFreePages(tree, numRoots, tableOrder, order - 1, 2 * index)
+			+ countBuddyFreePages(tree, numRoots, tableOrder, order - 1, 2 * index + 1);
+}
+
+} // anonymous namespace
+
+void PhysicalChunkAllocator::assignNumaNode(PhysicalAddr base, size_t length, int node) {
+	assert(node >= 0 && node < maxNumaNodes);
+
+	// Regions that are split off below do not intersect [base, base + length).
+	int numRegions = _numRegions;
+	for(int i = 0; i < numRegions; i++) {
+		auto regionBase = _allRegions[i].physicalBase;
+		auto regionSize = _allRegions[i].regionSize;
+		if(base + length <= regionBase || base >= regionBase + regionSize)
+			continue;
+
+		// Regions can only be split at the boundaries of their buddy roots.
+		// Each root belongs to the node that contains its base address.
+		auto rootSize = size_t(kPageSize) << _allRegions[i].order;
+		auto startOffset = (base > regionBase) ? base - regionBase : 0;
+		auto endOffset = (base + length - regionBase < regionSize)
+				? base + length - regionBase : regionSize;
+		if((startOffset % rootSize) || (endOffset % rootSize))
+			infoLogger() << "thor: NUMA node boundary within the memory region at "
+					<< frg::hex_fmt{regionBase} << " is not aligned to its buddy roots"
+					<< frg::endlog;
+
+		auto first = (startOffset + rootSize - 1) / rootSize;
+		auto last = (endOffset + rootSize - 1) / rootSize;
+		if(first >= last)
+			continue;
+
+		if(first > 0 || last < _allRegions[i].numRoots) {
+			if(!_splitRegion(i, first, last)) {
+				infoLogger() << "thor: Cannot split the memory region at "
+						<< frg::hex_fmt{regionBase} << " that spans multiple NUMA nodes"
+						<< frg::endlog;
+				if(first > 0)
+					continue;
+			}
+		}
+		_allRegions[i].node = node;
+	}
+}
+
+bool PhysicalChunkAllocator::_splitRegion(int i, size_t first, size_t last) {
+	auto oldBase = _allRegions[i].physicalBase;
+	auto oldTree = _allRegions[i].buddyTree;
+	auto oldRoots = _allRegions[i].numRoots;
+	auto order = _allRegions[i].order;
+	auto node = _allRegions[i].node;
+	auto rootSize = size_t(kPageSize) << order;
+
+	// Region i retains [first, last); the other parts become new regions.
+	struct Part {
+		size_t firstRoot;
+		size_t numRoots;
+		int8_t *tree;
+	};
+	Part parts[3];
+	int numParts = 0;
+	parts[numParts++] = {first, last - first, nullptr};
+	if(first > 0)
+		parts[numParts++] = {0, first, nullptr};
+	if(last < oldRoots)
+		parts[numParts++] = {last, oldRoots - last, nullptr};
+	if(_numRegions + numParts - 1 > maxRegions)
+		return false;
+
+	// The kernel heap allocates from this allocator; hence, we cannot hold _mutex here.
+	for(int p = 0; p < numParts; p++) {
+		parts[p].tree = static_cast<int8_t *>(kernelAlloc->allocate(
+				BuddyAccessor::determineSize(parts[p].numRoots, order)));
+		if(!parts[p].tree) {
+			for(int q = 0; q < p; q++)
+				kernelAlloc->deallocate(parts[q].tree,
+						BuddyAccessor::determineSize(parts[q].numRoots, order));
+			return false;
+		}
+	}
+
+	auto irqLock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&_mutex);
 
-	auto currentFree = _freePages.load(std::memory_order_relaxed);
-	auto currentUsed = _usedPages.load(std::memory_order_relaxed);
-	assert(currentFree > size / kPageSize);
-	_freePages.store(currentFree - size / kPageSize, std::memory_order_relaxed);
-	_usedPages.store(currentUsed + size / kPageSize, std::memory_order_relaxed);
+	// Roots are independent subtrees; copy their entries at each order.
+	// The old tree is not freed since it is not part of the kernel heap.
+	for(int p = 0; p < numParts; p++) {
+		for(int k = order; k >= 0; k--) {
+			memcpy(parts[p].tree + buddyLevelOffset(parts[p].numRoots, order, k),
+					oldTree + buddyLevelOffset(oldRoots, order, k)
+						+ (parts[p].firstRoot << (order - k)),
+					parts[p].numRoots << (order - k));
+		}
+
+		size_t freePages = 0;
+		for(size_t j = 0; j < parts[p].numRoots; j++)
+			freePages += countBuddyFreePages(oldTree, oldRoots, order, order,
+					parts[p].firstRoot + j);
+
+		int n = p ? _numRegions++ : i;
+		auto partBase = oldBase + parts[p].firstRoot * rootSize;
+		_allRegions[n].physicalBase = partBase;
+		_allRegions[n].regionSize = parts[p].numRoots * rootSize;
+		_allRegions[n].buddyTree = parts[p].tree;
+		_allRegions[n].numRoots = parts[p].numRoots;
+		_allRegions[n].order = order;
+		_allRegions[n].buddyAccessor = BuddyAccessor{partBase, kPageShift,
+				parts[p].tree, parts[p].numRoots, order};
+		_allRegions[n].node = node;
+		_allRegions[n].freePages.store(freePages, std::memory_order_relaxed);
+	}
+
+	return true;
+}
+
+void PhysicalChunkAllocator::setNumaDistance(int from, int to, uint8_t distance) {
+	assert(from >= 0 && from < maxNumaNodes);
+	assert(to >= 0 && to < maxNumaNodes);
+	_distances[from][to] = distance;
+}
+
+void PhysicalChunkAllocator::finalizeNumaTopology(int numNodes) {
+	assert(numNodes >= 1 && numNodes <= maxNumaNodes);
+	_numNodes = numNodes;
+
+	for(int i = 0; i < numNodes; i++) {
+		// The local node comes first, followed by the remaining nodes
+		// in insertion sort order by distance (ties are broken by node number).
+		_fallbackOrder[i][0] = i;
+		int n = 1;
+		for(int j = 0; j < numNodes; j++) {
+			if(j == i)
+				continue;
+			int k = n++;
+			while(k > 1 && _distances[i][_fallbackOrder[i][k - 1]] > _distances[i][j]) {
+				_fallbackOrder[i][k] = _fallbackOrder[i][k - 1];
+				k--;
+			}
+			_fallbackOrder[i][k] = j;
+		}
+	}
+}
+
+int PhysicalChunkAllocator::numaNodeOf(PhysicalAddr address) {
+	for(int i = 0; i < _numRegions; i++) {
+		if(address < _allRegions[i].physicalBase)
+			continue;
+		if(address - _allRegions[i].physicalBase >= _allRegions[i].regionSize)
+			continue;
+		return _allRegions[i].node;
+	}
+	return 0;
+}
+
+size_t PhysicalChunkAllocator::numNodeTotalPages(int node) {
+	size_t pages = 0;
+	for(int i = 0; i < _numRegions; i++) {
+		if(_allRegions[i].node == node)
+			pages += _allRegions[i].regionSize >> kPageShift;
+	}
+	return pages;
+}
+
+size_t PhysicalChunkAllocator::numNodeFreePages(int node) {
+	size_t pages = 0;
+	for(int i = 0; i < _numRegions; i++) {
+		if(_allRegions[i].node == node)
+			pages += _allRegions[i].freePages.load(std::memory_order_relaxed);
+	}
+	return pages;
+}
+
+namespace {
+
+struct PlatformCpuNode {
+	uint32_t platformId;
+	int node;
+};
+
+constexpr size_t maxPlatformCpuNodes = 256;
+constinit PlatformCpuNode platformCpuNodes[maxPlatformCpuNodes];
+constinit size_t numPlatformCpuNodes = 0;
+
+} // anonymous namespace
+
+void setNumaNodeOfPlatformCpu(uint32_t platformId, int node) {
+	for(size_t i = 0; i < numPlatformCpuNodes; i++) {
+		if(platformCpuNodes[i].platformId == platformId) {
+			platformCpuNodes[i].node = node;
+			return;
+		}
+	}
+
+	if(numPlatformCpuNodes == maxPlatformCpuNodes) {
+		infoLogger() << "thor: Too many CPUs for NUMA affinity table" << frg::endlog;
+		return;
+	}
+	platformCpuNodes[numPlatformCpuNodes++] = {platformId, node};
+}
+
+int getNumaNodeOfPlatformCpu(uint32_t platformId) {
+	for(size_t i = 0; i < numPlatformCpuNodes; i++) {
+		if(platformCpuNodes[i].platformId == platformId)
+			return platformCpuNodes[i].node;
+	}
+	return 0;
+}
+
+// --------------------------------------------------------
+// Per-CPU frame caches
+// --------------------------------------------------------
+
+namespace {
+
+// Orders that are cached per-CPU.
+constexpr int frameCacheOrders[] = {0, 9};
+constexpr size_t numFrameCacheOrders = sizeof(frameCacheOrders) / sizeof(int);
+constexpr size_t frameCacheCapacity = 128;
+
+struct FrameCacheParams {
+	// Frames are drained once a cache would exceed this number of frames.
+	size_t highWatermark;
+	// Number of frames that are moved from/to the buddy allocator at once.
+	size_t batch;
+};
+
+constexpr FrameCacheParams frameCacheParams[numFrameCacheOrders] = {
+	{frameCacheCapacity, 32},
+	{4, 2}
+};
+
+// Statistics prefixes of the cached orders; the CPU number is appended.
+constexpr frg::string_view frameCacheStatisticsPrefixes[numFrameCacheOrders] = {
+	"physical.order0.cpu",
+	"physical.order9.cpu"
+};
+
+int frameCacheIndex(int order) {
+	for(size_t i = 0; i < numFrameCacheOrders; ++i) {
+		if(frameCacheOrders[i] == order)
+			return i;
+	}
+	return -1;
+}
+
+} // anonymous namespace
+
+// Only written with the cache's lock held.
+struct FrameCacheStats {
+	OwnerCounter hits;
+	OwnerCounter misses;
+	OwnerCounter refills;
+	OwnerCounter drains;
+};
+
+struct FrameList {
+	// Only written with the cache's lock held but read by numFreePages() on all CPUs.
+	std::atomic<size_t> count{0};
+	PhysicalAddr frames[frameCacheCapacity];
+	FrameCacheStats stats;
+};
+
+// Accesses happen with IRQs disabled.
+struct PhysicalFrameCache {
+	PhysicalFrameCache() {
+		enabled = true;
+	}
+
+	// The per-CPU region is zero-initialized, hence this is false until
+	// the per-CPU initializers run.
+	bool enabled{false};
+	// Only contended if another CPU drains this cache because it ran out of memory.
+	// Ordered before the allocator's _mutex.
+	frg::ticket_spinlock mutex;
+	FrameList lists[numFrameCacheOrders];
+};
+
+extern PerCpu<PhysicalFrameCache> physicalFrameCache;
+THOR_DEFINE_PERCPU(physicalFrameCache);
+
+namespace {
+
+size_t numCachedPages() {
+	size_t pages = 0;
+	for(size_t i = 0; i < getCpuCount(); ++i) {
+		auto &cache = physicalFrameCache.getFor(i);
+		for(size_t j = 0; j < numFrameCacheOrders; ++j)
+			pages += cache.lists[j].count.load(std::memory_order_relaxed)
+					<< frameCacheOrders[j];
+	}
+	return pages;
+}
+
+struct FrameCacheStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		for(size_t i = 0; i < getCpuCount(); ++i) {
+			auto &cache = physicalFrameCache.getFor(i);
+			for(size_t j = 0; j < numFrameCacheOrders; ++j) {
+				auto &list = cache.lists[j];
+				auto prefix = frameCacheStatisticsPrefixes[j];
+				sink.emitIndexed(prefix, i, ".cached", list.count.load(std::memory_order_relaxed));
+				sink.emitIndexed(prefix, i, ".hits", list.stats.hits.load());
+				sink.emitIndexed(prefix, i, ".misses", list.stats.misses.load());
+				sink.emitIndexed(prefix, i, ".refills", list.stats.refills.load());
+				sink.emitIndexed(prefix, i, ".drains", list.stats.drains.load());
+			}
+		}
+	}
+};
+
+constinit FrameCacheStatisticsSource frameCacheStatisticsSource;
+
+struct NumaStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		for(int i = 0; i < physicalAllocator->numNumaNodes(); ++i) {
+			auto total = physicalAllocator->numNodeTotalPages(i);
+			auto free = physicalAllocator->numNodeFreePages(i);
+			sink.emitIndexed("physical.node", i, ".total-pages", total);
+			sink.emitIndexed("physical.node", i, ".free-pages", free);
+			sink.emitIndexed("physical.node", i, ".used-pages", total - free);
+		}
+	}
+};
+
+constinit NumaStatisticsSource numaStatisticsSource;
+
+initgraph::Task initFrameCacheStatistics{&globalInitEngine, "generic.init-frame-cache-statistics",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		registerStatisticsSource(&frameCacheStatisticsSource);
+		registerStatisticsSource(&numaStatisticsSource);
+	}
+};
+
+} // anonymous namespace
+
+size_t PhysicalChunkAllocator::numUsedPages() {
+	auto used = _usedPages.load(std::memory_order_relaxed);
+	auto cached = numCachedPages();
+	// The two values are not read atomically.
+	if(cached > used)
+		return 0;
+	return used - cached;
+}
+
+size_t PhysicalChunkAllocator::numFreePages() {
+	return _freePages.load(std::memory_order_relaxed) + numCachedPages();
+}
 
+PhysicalAddr PhysicalChunkAllocator::allocate(size_t size, int addressBits, int node) {
 	// TODO: This could be solved better.
 	int target = 0;
 	while(size > (size_t(kPageSize) << target))
@@ -69,7 +446,147 @@ PhysicalAddr PhysicalChunkAllocator::allocate(size_t size, int addressBits) {
 	if(logPhysicalAllocs)
 		infoLogger() << "thor: Allocating physical memory of order "
 					<< (target + kPageShift) << frg::endlog;
+
+	auto irq_lock = frg::guard(&irqMutex());
+
+	// Per-CPU caches only contain frames of the local node.
+	auto localNode = getCpuData()->numaNode;
+	if(node < 0)
+		node = localNode;
+
+	auto cacheIndex = frameCacheIndex(target);
+	auto cache = &physicalFrameCache.get();
+	if(addressBits == 64 && node == localNode && cacheIndex >= 0 && cache->enabled) {
+		auto cacheLock = frg::guard(&cache->mutex);
+		auto &list = cache->lists[cacheIndex];
+		auto count = list.count.load(std::memory_order_relaxed);
+		if(count) {
+			list.stats.hits.bump();
+		}else{
+			list.stats.misses.bump();
+
+			auto lock = frg::guard(&_mutex);
+			while(count < frameCacheParams[cacheIndex].batch) {
+				auto physical = _allocateFromNode(target, addressBits, localNode);
+				if(physical == static_cast<PhysicalAddr>(-1))
+					break;
+				list.frames[count++] = physical;
+			}
+			if(count)
+				list.stats.refills.bump();
+		}
+
+		if(count) {
+			auto physical = list.frames[--count];
+			list.count.store(count, std::memory_order_relaxed);
+			return physical;
+		}
+		// Otherwise, the local node is exhausted; fall back to other nodes below.
+	}
+
+	{
+		auto lock = frg::guard(&_mutex);
+		auto physical = _allocateFromBuddy(target, addressBits, node);
+		if(physical != static_cast<PhysicalAddr>(-1))
+			return physical;
+	}
+
+	return _allocateAfterDrain(target, addressBits, node);
+}
+
+PhysicalAddr PhysicalChunkAllocator::_allocateAfterDrain(int target, int addressBits, int node) {
+	// Frames in our own cache can be freed without involving other CPUs.
+	size_t self = getCpuData()->cpuIndex;
+	_drainFrameCache(self);
+	{
+		auto lock = frg::guard(&_mutex);
+		auto physical = _allocateFromBuddy(target, addressBits, node);
+		if(physical != static_cast<PhysicalAddr>(-1))
+			return physical;
+	}
+
+	// Take back the frames that other CPUs have cached. This also helps allocations
+	// that cannot be served from the caches (e.g., due to address restrictions).
+	for(size_t i = 0; i < getCpuCount(); ++i) {
+		if(i != self)
+			_drainFrameCache(i);
+	}
+
+	auto lock = frg::guard(&_mutex);
+	return _allocateFromBuddy(target, addressBits, node);
+}
+
+void PhysicalChunkAllocator::_drainFrameCache(size_t cpu) {
+	auto cache = &physicalFrameCache.getFor(cpu);
+	auto cacheLock = frg::guard(&cache->mutex);
+	for(size_t j = 0; j < numFrameCacheOrders; ++j) {
+		auto &list = cache->lists[j];
+		auto count = list.count.load(std::memory_order_relaxed);
+		if(!count)
+			continue;
+		list.stats.drains.bump();
+
+		auto lock = frg::guard(&_mutex);
+		for(size_t i = 0; i < count; ++i)
+			_freeToBuddy(list.frames[i], frameCacheOrders[j]);
+		list.count.store(0, std::memory_order_relaxed);
+	}
+}
+
+void PhysicalChunkAllocator::free(PhysicalAddr address, size_t size) {
+	int target = 0;
+	while(size > (size_t(kPageSize) << target))
+		target++;
+
+	auto irq_lock = frg::guard(&irqMutex());
+
+	auto cacheIndex = frameCacheIndex(target);
+	auto cache = &physicalFrameCache.get();
+	if(cacheIndex >= 0 && cache->enabled
+			&& (_numNodes == 1 || numaNodeOf(address) == getCpuData()->numaNode)) {
+		auto cacheLock = frg::guard(&cache->mutex);
+		auto &list = cache->lists[cacheIndex];
+		auto count = list.count.load(std::memory_order_relaxed);
+		if(count == frameCacheParams[cacheIndex].highWatermark) {
+			list.stats.drains.bump();
+
+			// Return the frames at the bottom of the list since they are least
+			// likely to be cache hot.
+			auto batch = frameCacheParams[cacheIndex].batch;
+			{
+				auto lock = frg::guard(&_mutex);
+				for(size_t i = 0; i < batch; ++i)
+					_freeToBuddy(list.frames[i], target);
+			}
+			memmove(list.frames, list.frames + batch, (count - batch) * sizeof(PhysicalAddr));
+			count -= batch;
+		}
+
+		list.frames[count++] = address;
+		list.count.store(count, std::memory_order_relaxed);
+		return;
+	}
+
+	auto lock = frg::guard(&_mutex);
+	_freeToBuddy(address, target);
+}
+
+PhysicalAddr PhysicalChunkAllocator::_allocateFromBuddy(int target, int addressBits, int node) {
+	assert(node >= 0 && node < _numNodes);
+
+	for(int k = 0; k < _numNodes; k++) {
+		auto physical = _allocateFromNode(target, addressBits, _fallbackOrder[node][k]);
+		if(physical != static_cast<PhysicalAddr>(-1))
+			return physical;
+	}
+
+	return static_cast<PhysicalAddr>(-1);
+}
+
+PhysicalAddr PhysicalChunkAllocator::_allocateFromNode(int target, int addressBits, int node) {
 	for(int i = 0; i < _numRegions; i++) {
+		if(_allRegions[i].node != node)
+			continue;
 		if(target > _allRegions[i].buddyAccessor.tableOrder())
 			continue;
 
@@ -78,20 +595,23 @@ PhysicalAddr PhysicalChunkAllocator::allocate(size_t size, int addressBits) {
 			continue;
 	//	infoLogger() << "Allocate " << (void *)physical << frg::endlog;
 		assert(!(physical % (size_t(kPageSize) << target)));
+
+		auto pages = size_t{1} << target;
+		auto regionFree = _allRegions[i].freePages.load(std::memory_order_relaxed);
+		_allRegions[i].freePages.store(regionFree - pages, std::memory_order_relaxed);
+		auto currentFree = _freePages.load(std::memory_order_relaxed);
+		auto currentUsed = _usedPages.load(std::memory_order_relaxed);
+		assert(currentFree > pages);
+		_freePages.store(currentFree - pages, std::memory_order_relaxed);
+		_usedPages.store(currentUsed + pages, std::memory_order_relaxed);
 		return physical;
 	}
 
 	return static_cast<PhysicalAddr>(-1);
 }
 
-void PhysicalChunkAllocator::free(PhysicalAddr address, size_t size) {
-	auto irq_lock = frg::guard(&irqMutex());
-	auto lock = frg::guard(&_mutex);
-	
-	int target = 0;
-	while(size > (size_t(kPageSize) << target))
-		target++;
-
+void PhysicalChunkAllocator::_freeToBuddy(PhysicalAddr address, int target) {
+	auto size = size_t(kPageSize) << target;
 	for(int i = 0; i < _numRegions; i++) {
 		if(address < _allRegions[i].physicalBase)
 			continue;
@@ -99,6 +619,8 @@ void PhysicalChunkAllocator::free(PhysicalAddr address, size_t size) {
 			continue;
 
 		_allRegions[i].buddyAccessor.free(address, target);
+		auto regionFree = _allRegions[i].freePages.load(std::memory_order_relaxed);
+		_allRegions[i].freePages.store(regionFree + size / kPageSize, std::memory_order_relaxed);
 		auto currentFree = _freePages.load(std::memory_order_relaxed);
 		auto currentUsed = _usedPages.load(std::memory_order_relaxed);
 		assert(currentUsed > size / kPageSize);
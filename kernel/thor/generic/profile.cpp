@@ -48,38 +48,40 @@ void initializeProfile() {
 	globalProfileRing.initialize(reinterpret_cast<uintptr_t>(profileMemory), 1 << 20);
 
 	// Dump the per-CPU profiling data to the global ring buffer.
-	// TODO: Start one such fiber per CPU.
-	KernelFiber::run([=] {
-		getCpuData()->localProfileRing = frg::construct<SingleContextRecordRing>(*kernelAlloc);
+	// Note that all CPUs are already booted at this point.
+	for(size_t i = 0; i < getCpuCount(); ++i) {
+		KernelFiber::run([=] {
+			getCpuData()->localProfileRing = frg::construct<SingleContextRecordRing>(*kernelAlloc);
 
-		if(getGlobalCpuFeatures()->profileFlags & CpuFeatures::profileIntelSupported) {
-			initializeIntelPmc();
-			getCpuData()->profileMechanism.store(ProfileMechanism::intelPmc,
-					std::memory_order_release);
-			setIntelPmc();
-		}else{
-			assert(getGlobalCpuFeatures()->profileFlags & CpuFeatures::profileAmdSupported);
-			getCpuData()->profileMechanism.store(ProfileMechanism::amdPmc,
-					std::memory_order_release);
-			setAmdPmc();
-		}
-
-		uint64_t deqPtr = 0;
-		while(true) {
-			char buffer[128];
-			auto [success, recordPtr, newPtr, size] = getCpuData()->localProfileRing->dequeueAt(
-					deqPtr, buffer, 128);
-			deqPtr = newPtr;
-			if(!success) {
-				KernelFiber::asyncBlockCurrent(generalTimerEngine()->sleepFor(1'000'000));
-				continue;
+			if(getGlobalCpuFeatures()->profileFlags & CpuFeatures::profileIntelSupported) {
+				initializeIntelPmc();
+				getCpuData()->profileMechanism.store(ProfileMechanism::intelPmc,
+						std::memory_order_release);
+				setIntelPmc();
+			}else{
+				assert(getGlobalCpuFeatures()->profileFlags & CpuFeatures::profileAmdSupported);
+				getCpuData()->profileMechanism.store(ProfileMechanism::amdPmc,
+						std::memory_order_release);
+				setAmdPmc();
 			}
-			assert(size);
-			assert(size < 128);
 
-			globalProfileRing->enqueue(buffer, size);
-		}
-	});
+			uint64_t deqPtr = 0;
+			while(true) {
+				char buffer[maxProfileRecordSize];
+				auto [success, recordPtr, newPtr, size] = getCpuData()->localProfileRing->dequeueAt(
+						deqPtr, buffer, maxProfileRecordSize);
+				deqPtr = newPtr;
+				if(!success) {
+					KernelFiber::asyncBlockCurrent(generalTimerEngine()->sleepFor(1'000'000));
+					continue;
+				}
+				assert(size);
+				assert(size <= maxProfileRecordSize);
+
+				globalProfileRing->enqueue(buffer, size);
+			}
+		}, &localScheduler.getFor(i));
+	}
 #endif
 }
 
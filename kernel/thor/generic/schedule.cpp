@@ -1,9 +1,15 @@
 #include <assert.h>
 
+#include <frg/string.hpp>
+#include <initgraph.hpp>
 #include <thor-internal/arch-generic/cpu.hpp>
 #include <thor-internal/arch-generic/ints.hpp>
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/debug.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
+#include <thor-internal/load-balancing.hpp>
+#include <thor-internal/main.hpp>
 #include <thor-internal/ostrace.hpp>
 #include <thor-internal/schedule.hpp>
 #include <thor-internal/thread.hpp>
@@ -30,6 +36,8 @@ namespace {
 			runOnStack([] (Continuation) {
 				if(logIdle)
 					infoLogger() << "System is idle" << frg::endlog;
+				// Try to pull work from busy CPUs before halting.
+				LoadBalancer::singleton().stealOnIdle(getCpuData());
 				suspendSelf();
 				__builtin_trap();
 			}, getCpuData()->idleStack.base());
@@ -130,6 +138,16 @@ void Scheduler::resume(ScheduleEntity *entity) {
 
 		wasEmpty = self->_pendingList.empty();
 		self->_pendingList.push_back(entity);
+
+		// If the current entity wakes up another entity on the same CPU, it is likely
+		// that the current entity is about to block (e.g., after sending a request over
+		// a stream). Remember the woken entity such that we can switch to it directly.
+		// Only wakeups within a handoff window count; wakeups from IRQs or timers
+		// are not caused by the current entity.
+		if(self == &localScheduler.get() && self->_current
+				&& self->_current->type() == ScheduleType::regular
+				&& self->_current->_handoffWindow)
+			self->_handoffCandidate = entity;
 	}
 
 	if(wasEmpty) {
@@ -286,9 +304,13 @@ bool Scheduler::maybeReschedule() {
 		return diff < 0;
 	};
 
+	// Keep the handoff candidate if we do not switch: this function also runs on syscall
+	// exit, i.e., before the current entity blocks in a later syscall.
 	if(!wantToSchedule())
 		return false;
 
+	// Handoffs only apply if the current entity blocks, not if it is preempted.
+	_handoffCandidate = nullptr;
 	_unschedule();
 	_schedule();
 	return true;
@@ -297,8 +319,11 @@ bool Scheduler::maybeReschedule() {
 void Scheduler::forceReschedule() {
 	assert(!intsAreEnabled());
 
-	if(_current)
+	if(_current) {
+		// Handoffs only apply if the current entity blocks.
+		_handoffCandidate = nullptr;
 		_unschedule();
+	}
 	_schedule();
 }
 
@@ -324,6 +349,21 @@ void Scheduler::renewSchedule() {
 		_updatePreemption();
 }
 
+Scheduler::HandoffWindow::HandoffWindow(bool open)
+: _entity{nullptr}, _saved{false} {
+	auto irqLock = frg::guard(&irqMutex());
+	_entity = localScheduler.get()._current;
+	if(_entity)
+		_saved = std::exchange(_entity->_handoffWindow, open);
+}
+
+Scheduler::HandoffWindow::~HandoffWindow() {
+	// The entity may have migrated in the meantime but it is still the entity
+	// that runs this code, hence no other CPU accesses its window.
+	if(_entity)
+		_entity->_handoffWindow = _saved;
+}
+
 ScheduleEntity *Scheduler::currentRunnable() {
 	assert(_current);
 	return _current;
@@ -348,6 +388,9 @@ void Scheduler::_schedule() {
 	assert(!_current);
 	assert(!_scheduled);
 
+	// The candidate is only valid until the next scheduling decision.
+	auto candidate = std::exchange(_handoffCandidate, nullptr);
+
 	if(_waitQueue.empty()) {
 		if(logScheduling)
 			infoLogger() << "No entities to schedule" << frg::endlog;
@@ -355,8 +398,22 @@ void Scheduler::_schedule() {
 		return;
 	}
 
-	auto entity = _waitQueue.top();
-	_waitQueue.pop();
+	// Hand off the CPU to the entity that was woken up by the (now blocked) previous entity.
+	// This bypasses the unfairness comparison but not priorities. Since commitReschedule()
+	// keeps the current preemption deadline, the candidate inherits the remaining time slice.
+	// Note that the candidate may still be pending if the queue was not updated.
+	ScheduleEntity *entity;
+	if(candidate && candidate->state == ScheduleState::active
+			&& !ScheduleEntity::orderPriority(candidate, _waitQueue.top())) {
+		_waitQueue.remove(candidate);
+		_numHandoffs.store(_numHandoffs.load(std::memory_order_relaxed) + 1,
+				std::memory_order_relaxed);
+		ostrace::emit(ostEvtHandoff);
+		entity = candidate;
+	}else{
+		entity = _waitQueue.top();
+		_waitQueue.pop();
+	}
 	_numWaiting--;
 
 	// Increase the unfairness at the start of the time slice.
@@ -476,6 +533,27 @@ void checkThreadPreemption(SyscallImageAccessor image) {
 
 THOR_DEFINE_PERCPU(localScheduler);
 
+namespace {
+
+struct SchedulerStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		for(size_t i = 0; i < getCpuCount(); ++i) {
+			sink.emitIndexed("sched.cpu", i, ".handoffs", localScheduler.getFor(i).numHandoffs());
+		}
+	}
+};
+
+constinit SchedulerStatisticsSource schedulerStatisticsSource;
+
+initgraph::Task initSchedulerStatistics{&globalInitEngine, "generic.init-scheduler-statistics",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		registerStatisticsSource(&schedulerStatisticsSource);
+	}
+};
+
+} // anonymous namespace
+
 smarter::borrowed_ptr<Thread> getCurrentThread() {
 	return getCpuData()->activeThread;
 }
@@ -4,6 +4,7 @@
 #include <frg/hash_map.hpp>
 #include <frg/string.hpp>
 #include <elf.h>
+#include <string.h>
 #include <thor-internal/coroutine.hpp>
 #include <thor-internal/debug.hpp>
 #include <thor-internal/load-balancing.hpp>
@@ -202,35 +203,83 @@ coroutine<ImageInfo> loadModuleImage(smarter::shared_ptr<AddressSpace, BindableH
 			if((virt_length % kPageSize) != 0)
 				virt_length += kPageSize - virt_length % kPageSize;
 			
-			auto memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc, virt_length);
-			memory->selfPtr = memory;
-			co_await copyBetweenViews(memory.get(), phdr.p_vaddr - virt_address,
-					image.get(), phdr.p_offset, phdr.p_filesz,
-					WorkQueue::generalQueue()->take());
-
-			auto view = smarter::allocate_shared<MemorySlice>(*kernelAlloc,
-					std::move(memory), 0, virt_length);
-
+			AddressSpace::MapFlags protFlags;
 			if((phdr.p_flags & (PF_R | PF_W | PF_X)) == (PF_R | PF_W)) {
-				auto mapResult = co_await space->map(std::move(view),
-						base + virt_address, 0, virt_length,
-						AddressSpace::kMapFixed | AddressSpace::kMapProtRead
-							| AddressSpace::kMapProtWrite);
-				assert(mapResult);
+				protFlags = AddressSpace::kMapProtRead | AddressSpace::kMapProtWrite;
 			}else if((phdr.p_flags & (PF_R | PF_W | PF_X)) == (PF_R | PF_X)) {
-				auto mapResult = co_await space->map(std::move(view),
-						base + virt_address, 0, virt_length,
-						AddressSpace::kMapFixed | AddressSpace::kMapProtRead
-							| AddressSpace::kMapProtExecute);
-				assert(mapResult);
+				protFlags = AddressSpace::kMapProtRead | AddressSpace::kMapProtExecute;
 			}else if((phdr.p_flags & (PF_R | PF_W | PF_X)) == PF_R) {
-				auto mapResult = co_await space->map(std::move(view),
-						base + virt_address, 0, virt_length,
-						AddressSpace::kMapFixed | AddressSpace::kMapProtRead);
-				assert(mapResult);
+				protFlags = AddressSpace::kMapProtRead;
 			}else{
 				panicLogger() << "Illegal combination of segment permissions"
 						<< frg::endlog;
+				__builtin_unreachable();
+			}
+
+			// Pages that contain file data are mapped directly from the image
+			// (through a CoW view if the segment is writable). This avoids copying
+			// segments out of initrd files. Only the remaining pages are anonymous.
+			size_t misalign = phdr.p_vaddr - virt_address;
+			size_t file_length = (misalign + phdr.p_filesz + (kPageSize - 1))
+					& ~size_t{kPageSize - 1};
+			bool needZeroTail = phdr.p_memsz > phdr.p_filesz
+					&& ((misalign + phdr.p_filesz) & (kPageSize - 1));
+			if(!phdr.p_filesz
+					|| ((phdr.p_offset - misalign) & (kPageSize - 1))
+					|| phdr.p_offset - misalign + file_length > image->getLength()
+					|| (needZeroTail && !(protFlags & AddressSpace::kMapProtWrite))) {
+				// Fall back to copying the entire segment.
+				file_length = 0;
+			}
+
+			if(file_length) {
+				smarter::shared_ptr<MemoryView> fileMemory;
+				if(protFlags & AddressSpace::kMapProtWrite) {
+					auto cow = smarter::allocate_shared<CopyOnWriteMemory>(*kernelAlloc,
+							image, phdr.p_offset - misalign, file_length);
+					cow->selfPtr = cow;
+
+					// The bytes between the end of the file data and the end of the page belong
+					// to the zero-initialized part of the segment. This copies a single page.
+					if(needZeroTail) {
+						size_t tail = file_length - (misalign + phdr.p_filesz);
+						frg::unique_memory<KernelAlloc> zeros{*kernelAlloc, tail};
+						memset(zeros.data(), 0, tail);
+						auto zeroOutcome = co_await cow->copyTo(misalign + phdr.p_filesz,
+								zeros.data(), tail, WorkQueue::generalQueue()->take());
+						assert(zeroOutcome);
+					}
+
+					fileMemory = std::move(cow);
+				}else{
+					fileMemory = image;
+				}
+
+				auto view = smarter::allocate_shared<MemorySlice>(*kernelAlloc,
+						std::move(fileMemory),
+						(protFlags & AddressSpace::kMapProtWrite) ? 0 : phdr.p_offset - misalign,
+						file_length);
+				auto mapResult = co_await space->map(std::move(view),
+						base + virt_address, 0, file_length,
+						AddressSpace::kMapFixed | protFlags);
+				assert(mapResult);
+			}
+
+			if(file_length < virt_length) {
+				auto memory = smarter::allocate_shared<AllocatedMemory>(*kernelAlloc,
+						virt_length - file_length);
+				memory->selfPtr = memory;
+				if(!file_length)
+					co_await copyBetweenViews(memory.get(), misalign,
+							image.get(), phdr.p_offset, phdr.p_filesz,
+							WorkQueue::generalQueue()->take());
+
+				auto view = smarter::allocate_shared<MemorySlice>(*kernelAlloc,
+						std::move(memory), 0, virt_length - file_length);
+				auto mapResult = co_await space->map(std::move(view),
+						base + virt_address + file_length, 0, virt_length - file_length,
+						AddressSpace::kMapFixed | protFlags);
+				assert(mapResult);
 			}
 		}else if(phdr.p_type == PT_INTERP) {
 			info.interpreter.resize(phdr.p_filesz);
@@ -310,7 +359,7 @@ coroutine<void> executeModule(frg::string_view name, MfsRegular *module,
 	if(xpipe_lane) {
 		auto lock = frg::guard(&universe->lock);
 		xpipe_handle = universe->attachDescriptor(lock,
-				LaneDescriptor(xpipe_lane));
+				LaneDescriptor(xpipe_lane)).unwrap();
 	}
 
 	enum {
@@ -373,7 +373,7 @@ namespace posix {
 				Universe::Guard universeLock(thread->getUniverse()->lock);
 
 				posixHandle = thread->getUniverse()->attachDescriptor(universeLock,
-					LaneDescriptor{std::move(posixStream.get<1>())});
+					LaneDescriptor{std::move(posixStream.get<1>())}).unwrap();
 			}
 
 			ThreadInfo info {
@@ -395,7 +395,7 @@ namespace posix {
 			Universe::Guard universe_guard(thread->getUniverse()->lock);
 
 			controlHandle = thread->getUniverse()->attachDescriptor(universe_guard,
-					LaneDescriptor{lane});
+					LaneDescriptor{lane}).unwrap();
 		}
 
 		void attachMbus(smarter::shared_ptr<Thread, ActiveHandle> thread) {
@@ -403,7 +403,7 @@ namespace posix {
 			Universe::Guard universeLock(thread->getUniverse()->lock);
 
 			mbusHandle = thread->getUniverse()->attachDescriptor(universeLock,
-					LaneDescriptor{*mbusClient});
+					LaneDescriptor{*mbusClient}).unwrap();
 		}
 
 		coroutine<int> attachFile(smarter::shared_ptr<Thread, ActiveHandle> thread, OpenFile *file) {
@@ -413,7 +413,7 @@ namespace posix {
 				Universe::Guard universe_guard(thread->getUniverse()->lock);
 
 				handle = thread->getUniverse()->attachDescriptor(universe_guard,
-						LaneDescriptor(file->clientLane));
+						LaneDescriptor(file->clientLane)).unwrap();
 			}
 
 			for(int fd = 0; fd < (int)openFiles.size(); ++fd) {
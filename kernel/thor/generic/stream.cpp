@@ -169,7 +169,7 @@ void Stream::Submitter::run() {
 		}else if(u->tag() == kTagSendKernelBuffer && v->tag() == kTagRecvKernelBuffer) {
 			transfer(SendRecvInline{}, u, v);
 		}else if(u->tag() == kTagSendFlow && v->tag() == kTagRecvKernelBuffer) {
-			if(u->_inBuffer.size() > v->_maxLength) {
+			if(u->_maxLength > v->_maxLength) {
 				// Both nodes complete with bufferTooSmall.
 				u->_error = Error::bufferTooSmall;
 				v->_error = Error::bufferTooSmall;
@@ -27,6 +27,13 @@ inline CachingMode determineCachingMode(CachingMode physicalRangeCaching,
 	return physicalRangeCaching;
 }
 
+// Checks whether the naturally aligned large page at va fits into the remaining range.
+inline bool isLargePageBlock(VirtualAddr va, uintptr_t offset, size_t remaining) {
+	return !(va & (kLargePageSize - 1))
+		&& !(offset & (kLargePageSize - 1))
+		&& remaining >= kLargePageSize;
+}
+
 template<typename Cursor, typename PageSpace>
 frg::expected<Error> mapPresentPagesByCursor(PageSpace *ps, VirtualAddr va,
 		MemoryView *view, uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) {
@@ -37,6 +44,19 @@ frg::expected<Error> mapPresentPagesByCursor(PageSpace *ps, VirtualAddr va,
 	Cursor c{ps, va};
 	while(c.virtualAddress() < va + size) {
 		auto progress = c.virtualAddress() - va;
+
+		if constexpr (Cursor::supportsLargePages) {
+			if(isLargePageBlock(va + progress, offset + progress, size - progress)) {
+				auto largeRange = view->peekLargeRange(offset + progress);
+				if(largeRange.template get<0>() != PhysicalAddr(-1)
+						&& c.remap2m(largeRange.template get<0>(), flags,
+							determineCachingMode(largeRange.template get<1>(), mode))) {
+					c.moveTo(c.virtualAddress() + kLargePageSize);
+					continue;
+				}
+			}
+		}
+
 		auto physicalRange = view->peekRange(offset + progress);
 		if(physicalRange.template get<0>() == PhysicalAddr(-1)) {
 			c.advance4k();
@@ -62,6 +82,22 @@ frg::expected<Error> remapPresentPagesByCursor(PageSpace *ps, VirtualAddr va,
 	while(c.virtualAddress() < va + size) {
 		auto progress = c.virtualAddress() - va;
 
+		if constexpr (Cursor::supportsLargePages) {
+			if(isLargePageBlock(va + progress, offset + progress, size - progress)) {
+				auto largeRange = view->peekLargeRange(offset + progress);
+				if(largeRange.template get<0>() != PhysicalAddr(-1)) {
+					auto status = c.remap2m(largeRange.template get<0>(), flags,
+							determineCachingMode(largeRange.template get<1>(), mode));
+					if(status) {
+						if((*status & page_status::present) && (*status & page_status::dirty))
+							view->markDirty(offset + progress, kLargePageSize);
+						c.moveTo(c.virtualAddress() + kLargePageSize);
+						continue;
+					}
+				}
+			}
+		}
+
 		auto physicalRange = view->peekRange(offset + progress);
 		if(physicalRange.template get<0>() == PhysicalAddr(-1)) {
 			auto [status, _] = c.unmap4k();
@@ -107,6 +143,62 @@ frg::expected<Error> faultPageByCursor(PageSpace *ps, VirtualAddr va,
 	return {};
 }
 
+// Maps all pages in the range that are resident in the view but not mapped yet.
+template<typename Cursor, typename PageSpace>
+frg::expected<Error> faultAroundByCursor(PageSpace *ps, VirtualAddr va,
+		MemoryView *view, uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) {
+	assert(!(va & (kPageSize - 1)));
+	assert(!(offset & (kPageSize - 1)));
+	assert(!(size & (kPageSize - 1)));
+
+	Cursor c{ps, va};
+	while(c.virtualAddress() < va + size) {
+		auto progress = c.virtualAddress() - va;
+		if(c.isPresent()) {
+			c.advance4k();
+			continue;
+		}
+
+		auto physicalRange = view->peekRange(offset + progress);
+		if(physicalRange.template get<0>() != PhysicalAddr(-1)) {
+			assert(!(physicalRange.template get<0>() & (kPageSize - 1)));
+			c.map4k(physicalRange.template get<0>(), flags,
+				determineCachingMode(physicalRange.template get<1>(), mode));
+		}
+		c.advance4k();
+	}
+
+	// Let the reclaimer know that the pages are in use, as if they were fetched.
+	view->markAccessed(offset, size);
+	return {};
+}
+
+// Maps the large page at va if the view is backed by a large page at offset.
+template<typename Cursor, typename PageSpace>
+frg::expected<Error> faultLargePageByCursor(PageSpace *ps, VirtualAddr va,
+		MemoryView *view, uintptr_t offset, PageFlags flags, CachingMode mode) {
+	assert(!(va & (kLargePageSize - 1)));
+	assert(!(offset & (kLargePageSize - 1)));
+
+	if constexpr (Cursor::supportsLargePages) {
+		auto physicalRange = view->peekLargeRange(offset);
+		if(physicalRange.template get<0>() == PhysicalAddr(-1))
+			return Error::fault;
+
+		Cursor c{ps, va};
+		auto status = c.remap2m(physicalRange.template get<0>(), flags,
+			determineCachingMode(physicalRange.template get<1>(), mode));
+		if(!status)
+			return Error::fault;
+		if((*status & page_status::present) && (*status & page_status::dirty))
+			view->markDirty(offset, kLargePageSize);
+
+		return {};
+	}else{
+		return Error::noHardwareSupport;
+	}
+}
+
 template<typename Cursor, typename PageSpace>
 frg::expected<Error> cleanPagesByCursor(PageSpace *ps, VirtualAddr va,
 		MemoryView *view, uintptr_t offset, size_t size) {
@@ -118,6 +210,17 @@ frg::expected<Error> cleanPagesByCursor(PageSpace *ps, VirtualAddr va,
 	while(c.findDirty(va + size)) {
 		auto progress = c.virtualAddress() - va;
 
+		if constexpr (Cursor::supportsLargePages) {
+			if(c.isLarge() && isLargePageBlock(va + progress, offset + progress, size - progress)) {
+				auto status = c.clean2m();
+				assert(status & page_status::dirty);
+				view->markDirty(offset + progress, kLargePageSize);
+
+				c.moveTo(c.virtualAddress() + kLargePageSize);
+				continue;
+			}
+		}
+
 		auto status = c.clean4k();
 		assert(status & page_status::present);
 		assert(status & page_status::dirty);
@@ -139,6 +242,18 @@ frg::expected<Error> unmapPagesByCursor(PageSpace *ps, VirtualAddr va,
 	while(c.findPresent(va + size)) {
 		auto progress = c.virtualAddress() - va;
 
+		if constexpr (Cursor::supportsLargePages) {
+			if(c.isLarge() && isLargePageBlock(va + progress, offset + progress, size - progress)) {
+				auto [status, _] = c.unmap2m();
+				assert(status & page_status::present);
+				if(status & page_status::dirty)
+					view->markDirty(offset + progress, kLargePageSize);
+
+				c.moveTo(c.virtualAddress() + kLargePageSize);
+				continue;
+			}
+		}
+
 		auto [status, _] = c.unmap4k();
 		assert(status & page_status::present);
 		if(status & page_status::dirty)
@@ -193,6 +308,17 @@ struct VirtualOperations {
 	virtual frg::expected<Error> faultPage(VirtualAddr va, MemoryView *view,
 			uintptr_t offset, PageFlags flags, CachingMode mode);
 
+	// Maps the pages of a range that are already resident in the view,
+	// skipping pages that are already mapped. Used to reduce the number of minor faults.
+	virtual frg::expected<Error> faultAround(VirtualAddr va, MemoryView *view,
+			uintptr_t offset, size_t size, PageFlags flags, CachingMode mode);
+
+	// Maps a whole large page. va and offset are aligned to kLargePageSize.
+	// Returns Error::noHardwareSupport if large pages are not supported
+	// and Error::fault if the range cannot be mapped by a large page.
+	virtual frg::expected<Error> faultLargePage(VirtualAddr va, MemoryView *view,
+			uintptr_t offset, PageFlags flags, CachingMode mode);
+
 	virtual frg::expected<Error> cleanPages(VirtualAddr va, MemoryView *view,
 			uintptr_t offset, size_t size);
 
@@ -335,7 +461,12 @@ enum MappingFlags : uint32_t {
 	protWrite = 0x20,
 	protExecute = 0x40,
 
-	dontRequireBacking = 0x100
+	dontRequireBacking = 0x100,
+	noFaultAround = 0x200,
+
+	// Order of the fault-around window (see Mapping::faultAroundPages()).
+	faultAroundMask = 0xF000,
+	faultAroundShift = 12
 };
 
 struct TouchVirtualResult {
@@ -445,6 +576,9 @@ public:
 
 	uint32_t compilePageFlags();
 
+	// Number of pages around a read fault that are mapped if they are already resident.
+	size_t faultAroundPages();
+
 	coroutine<void> runEvictionLoop();
 
 	smarter::shared_ptr<VirtualSpace> owner;
@@ -518,7 +652,11 @@ public:
 		kMapProtExecute = 0x20,
 		kMapPopulate = 0x200,
 		kMapDontRequireBacking = 0x400,
-		kMapFixedNoReplace = 0x800
+		kMapFixedNoReplace = 0x800,
+		kMapNoFaultAround = 0x1000,
+		// Order of the fault-around window; zero selects the default.
+		kMapFaultAroundMask = 0xF0000,
+		kMapFaultAroundShift = 16
 	};
 
 	enum FaultFlags : uint32_t {
@@ -568,6 +706,13 @@ public:
 	coroutine<size_t> writePartialSpace(uintptr_t address, const void *buffer, size_t size,
 			smarter::shared_ptr<WorkQueue> wq);
 
+	// Copies from this space directly to user memory of the address space that is active
+	// while wq runs (i.e., wq must be the main work queue of a thread in that space).
+	// Stops at mappings of this space that are not readable.
+	// On error, userFault tells whether the copy faulted on the destination.
+	coroutine<size_t> readPartialSpaceToUser(uintptr_t address, void *userBuffer, size_t size,
+			bool &userFault, smarter::shared_ptr<WorkQueue> wq);
+
 	auto readSpace(uintptr_t address, void *buffer, size_t size,
 			smarter::shared_ptr<WorkQueue> wq) {
 		return async::transform(
@@ -716,6 +861,18 @@ struct AddressSpace final : VirtualSpace, smarter::crtp_counter<AddressSpace, Bi
 					va, view, offset, flags, mode);
 		}
 
+		frg::expected<Error> faultAround(VirtualAddr va, MemoryView *view,
+				uintptr_t offset, size_t size, PageFlags flags, CachingMode mode) override {
+			return faultAroundByCursor<ClientPageSpace::Cursor>(&space_->pageSpace_,
+					va, view, offset, size, flags, mode);
+		}
+
+		frg::expected<Error> faultLargePage(VirtualAddr va, MemoryView *view,
+				uintptr_t offset, PageFlags flags, CachingMode mode) override {
+			return faultLargePageByCursor<ClientPageSpace::Cursor>(&space_->pageSpace_,
+					va, view, offset, flags, mode);
+		}
+
 		frg::expected<Error> cleanPages(VirtualAddr va, MemoryView *view,
 				uintptr_t offset, size_t size) override {
 			return cleanPagesByCursor<ClientPageSpace::Cursor>(&space_->pageSpace_,
@@ -80,6 +80,14 @@ private:
 
 inline constexpr int globalBindingId = -1;
 
+// If a shootdown covers at least this many pages, the whole ASID is invalidated instead.
+inline constexpr size_t shootdownFullFlushPages = 64;
+
+// PageSpaces track which of the first shootdownTrackedCpus CPUs have a binding to them,
+// such that shootdown IPIs only need to be sent to those CPUs.
+// If there are bindings on other CPUs, shootdowns fall back to broadcast IPIs.
+inline constexpr size_t shootdownTrackedCpus = 256;
+
 struct PageSpace;
 
 struct PageBinding {
@@ -190,6 +198,13 @@ struct PageSpace {
 	}
 
 private:
+	// The following two functions must be called with mutex_ held.
+	void addBindingCpu_(int cpu);
+	void removeBindingCpu_(int cpu);
+
+	// Sends shootdown IPIs to all CPUs (except the current one) that have a binding.
+	void sendShootdownIpis_();
+
 	PhysicalAddr rootTable_;
 
 	std::atomic<bool> wantToRetire_ = false;
@@ -200,6 +215,11 @@ private:
 
 	unsigned int numBindings_;
 
+	// Bit mask of CPUs that have a binding to this space.
+	uint64_t bindingCpus_[shootdownTrackedCpus / 64] = {};
+	// Number of bindings on CPUs that are not tracked in bindingCpus_.
+	unsigned int numUntrackedBindings_ = 0;
+
 	uint64_t shootSequence_;
 
 	ShootNodeList shootQueue_;
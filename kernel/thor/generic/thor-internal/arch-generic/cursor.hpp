@@ -4,6 +4,8 @@
 #include <concepts>
 #include <tuple>
 
+#include <frg/optional.hpp>
+
 #include <thor-internal/arch-generic/paging-consts.hpp>
 #include <thor-internal/arch-generic/asid.hpp>
 #include <thor-internal/physical.hpp>
@@ -46,10 +48,25 @@ concept CursorPolicy = requires (uint64_t pte, uint64_t *ptePtr,
 	{ T::pteNewTable() } -> std::same_as<uint64_t>;
 };
 
+// Policies that can map kLargePageSize pages at the second to last level.
+// ptePagePresent(), ptePageStatus() and pteClean() need to work on large page PTEs, too,
+// while pteTablePresent() must return false for them.
+template <typename T>
+concept LargePageCursorPolicy = CursorPolicy<T> && requires (uint64_t pte,
+		PhysicalAddr pa, PageFlags flags, CachingMode cachingMode, size_t index) {
+	// Check whether the given PTE maps a large page.
+	{ T::ptePageIsLarge(pte) } -> std::same_as<bool>;
+	// Construct a new large page PTE from the given parameters.
+	{ T::pteBuildLarge(pa, flags, cachingMode) } -> std::same_as<uint64_t>;
+	// Construct the PTE of the index-th small page within the given large page PTE.
+	{ T::pteSplitLarge(pte, index) } -> std::same_as<uint64_t>;
+};
+
 template <CursorPolicy Policy>
 struct PageCursor {
 	inline static constexpr uintptr_t levelMask = (uintptr_t{1} << Policy::bitsPerLevel) - 1;
 	inline static constexpr size_t lastLevel = Policy::maxLevels - 1;
+	inline static constexpr bool supportsLargePages = LargePageCursorPolicy<Policy>;
 
 	PageCursor(PageSpace *space, uintptr_t va)
 	: space_{space}, va_{}, initialLevel_{Policy::maxLevels - Policy::numLevels()} {
@@ -75,6 +92,14 @@ private:
 		return __atomic_exchange_n(currentPtePtr_(), value, __ATOMIC_RELAXED);
 	}
 
+	// Pointer to the second to last level PTE that covers the current address.
+	uint64_t *largePtePtr_() {
+		if(!accessors_[lastLevel - 1])
+			return nullptr;
+		return reinterpret_cast<uint64_t *>(accessors_[lastLevel - 1].get())
+			+ ((va_ >> levelShift(lastLevel - 1)) & levelMask);
+	}
+
 public:
 	uintptr_t virtualAddress() {
 		return va_;
@@ -101,6 +126,10 @@ public:
 	bool findPresent(uintptr_t limit) {
 		while(va_ < limit) {
 			if(!accessors_[lastLevel]) {
+				if constexpr (supportsLargePages) {
+					if(isLarge())
+						return true;
+				}
 				advance4k();
 				continue;
 			}
@@ -118,6 +147,15 @@ public:
 	bool findDirty(uintptr_t limit) {
 		while(va_ < limit) {
 			if(!accessors_[lastLevel]) {
+				if constexpr (supportsLargePages) {
+					if(isLarge()) {
+						auto largeEnt = __atomic_load_n(largePtePtr_(), __ATOMIC_RELAXED);
+						if(Policy::ptePageStatus(largeEnt) & page_status::dirty)
+							return true;
+						moveTo((va_ + kLargePageSize) & ~uintptr_t(kLargePageSize - 1));
+						continue;
+					}
+				}
 				advance4k();
 				continue;
 			}
@@ -132,6 +170,17 @@ public:
 		return false;
 	}
 
+	// Check whether the current page is mapped (either by a small or by a large page).
+	bool isPresent() {
+		if(!accessors_[lastLevel]) {
+			if constexpr (supportsLargePages)
+				return isLarge();
+			return false;
+		}
+
+		return Policy::ptePagePresent(readCurrentPte_());
+	}
+
 	void map4k(PhysicalAddr pa, PageFlags flags, CachingMode cachingMode) {
 		if(!accessors_[lastLevel])
 			realizePts_();
@@ -163,21 +212,87 @@ public:
 	}
 
 	PageStatus clean4k() {
-		if(!accessors_[lastLevel])
-			return 0;
+		if(!accessors_[lastLevel]) {
+			if constexpr (supportsLargePages) {
+				if(isLarge())
+					realizePts_();
+			}
+			if(!accessors_[lastLevel])
+				return 0;
+		}
 
 		return Policy::pteClean(currentPtePtr_());
 	}
 
 	std::tuple<PageStatus, PhysicalAddr> unmap4k() {
-		if(!accessors_[lastLevel])
-			return {0, 0};
+		if(!accessors_[lastLevel]) {
+			if constexpr (supportsLargePages) {
+				if(isLarge())
+					realizePts_();
+			}
+			if(!accessors_[lastLevel])
+				return {0, 0};
+		}
 
 		auto ptEnt = exchangeCurrentPte_(0);
 		Policy::pteWriteBarrier();
 		return {Policy::ptePageStatus(ptEnt), Policy::ptePageAddress(ptEnt)};
 	}
 
+	// Large page API. All functions expect the current address to be aligned to kLargePageSize.
+	// Large pages are split into small pages (see doRealizeLevel_()) as soon as
+	// a small page within them is changed; for example, on partial unmap or protect.
+
+	// Check whether the current address is mapped by a large page.
+	bool isLarge() requires LargePageCursorPolicy<Policy> {
+		if(accessors_[lastLevel])
+			return false;
+		auto ptePtr = largePtePtr_();
+		return ptePtr && Policy::ptePageIsLarge(__atomic_load_n(ptePtr, __ATOMIC_RELAXED));
+	}
+
+	// Maps (or replaces) a large page. Fails if small pages are already mapped in the range.
+	frg::optional<PageStatus> remap2m(PhysicalAddr pa, PageFlags flags, CachingMode cachingMode)
+	requires LargePageCursorPolicy<Policy> {
+		assert(!(va_ & (kLargePageSize - 1)));
+		assert(!(pa & (kLargePageSize - 1)));
+		if(accessors_[lastLevel])
+			return frg::null_opt;
+
+		// Take the lock such that no page table can be installed concurrently.
+		auto irqLock = frg::guard(&irqMutex());
+		auto lock = frg::guard(&space_->tableMutex());
+		realizeLevel_(lastLevel - 1);
+
+		auto ptePtr = largePtePtr_();
+		auto ptEnt = __atomic_load_n(ptePtr, __ATOMIC_RELAXED);
+		if(Policy::pteTablePresent(ptEnt))
+			return frg::null_opt;
+
+		if(flags & page_access::execute) {
+			for(size_t pg = 0; pg < kLargePageSize; pg += kPageSize)
+				Policy::pteSyncICache(pa + pg);
+		}
+
+		ptEnt = __atomic_exchange_n(ptePtr, Policy::pteBuildLarge(pa, flags, cachingMode),
+				__ATOMIC_RELAXED);
+		Policy::pteWriteBarrier();
+		return Policy::ptePageStatus(ptEnt);
+	}
+
+	PageStatus clean2m() requires LargePageCursorPolicy<Policy> {
+		assert(isLarge());
+		return Policy::pteClean(largePtePtr_());
+	}
+
+	std::tuple<PageStatus, PhysicalAddr> unmap2m() requires LargePageCursorPolicy<Policy> {
+		assert(isLarge());
+		auto ptEnt = __atomic_exchange_n(largePtePtr_(), 0, __ATOMIC_RELAXED);
+		Policy::pteWriteBarrier();
+		return {Policy::ptePageStatus(ptEnt),
+				Policy::ptePageAddress(Policy::pteSplitLarge(ptEnt, 0))};
+	}
+
 	// Low-level API for use by arch-specific code.
 public:
 	uint64_t *getPtePtr() {
@@ -221,6 +336,13 @@ private:
 			return;
 		}
 
+		if constexpr (supportsLargePages) {
+			if(level == lastLevel - 1 && Policy::ptePageIsLarge(ptEnt)) {
+				splitLarge_(subPt, ptPtr, ptEnt);
+				return;
+			}
+		}
+
 		ptEnt = Policy::pteNewTable();
 		auto subPtPtr = Policy::pteTableAddress(ptEnt);
 		subPt = PageAccessor{subPtPtr};
@@ -229,6 +351,28 @@ private:
 		Policy::pteWriteBarrier();
 	}
 
+	// Replaces a large page by a table of small pages that map the same memory.
+	// Since the translation does not change, we do not need to invalidate the TLB here;
+	// stale large page TLB entries are flushed by the shootdown that follows
+	// any change to the small pages.
+	void splitLarge_(PageAccessor &subPt, uint64_t *ptPtr, uint64_t largeEnt)
+	requires LargePageCursorPolicy<Policy> {
+		auto tableEnt = Policy::pteNewTable();
+		subPt = PageAccessor{Policy::pteTableAddress(tableEnt)};
+		auto subPtPtr = reinterpret_cast<uint64_t *>(subPt.get());
+		for(size_t i = 0; i <= levelMask; i++)
+			subPtPtr[i] = Policy::pteSplitLarge(largeEnt, i);
+
+		auto oldEnt = __atomic_exchange_n(ptPtr, tableEnt, __ATOMIC_RELEASE);
+		Policy::pteWriteBarrier();
+
+		// The page table walker might have set the dirty bit in the meantime.
+		if(oldEnt != largeEnt) {
+			for(size_t i = 0; i <= levelMask; i++)
+				__atomic_fetch_or(&subPtPtr[i], Policy::pteSplitLarge(oldEnt, i), __ATOMIC_RELAXED);
+		}
+	}
+
 	void realizeLevel_(size_t level) {
 		if(accessors_[level]) /*[[likely]]*/
 			return;
@@ -8,6 +8,8 @@ struct CpuData;
 
 void sendPingIpi(CpuData *dstData);
 void sendShootdownIpi();
+// Sends a shootdown IPI to a single CPU.
+void sendShootdownIpi(CpuData *dstData);
 void sendSelfCallIpi();
 
 } // namespace thor
@@ -6,7 +6,10 @@ namespace thor {
 
 enum {
 	kPageSize = 0x1000,
-	kPageShift = 12
+	kPageShift = 12,
+	// Size of pages that are mapped by the second to last page table level.
+	kLargePageSize = 0x200000,
+	kLargePageShift = 21
 };
 
 constexpr Word kPfAccess = 1;
@@ -9,6 +9,12 @@ namespace thor {
 // Get the size of the lower half (= virtual memory available to user-space) in bits.
 int getLowerHalfBits();
 
+// Copy or zero a single page (e.g., through a PageAccessor).
+// Pages must be page-aligned normal memory; the implementation is selected at boot
+// based on the CPU's features.
+void copyPage(void *dest, const void *src);
+void zeroPage(void *dest);
+
 template <typename T>
 concept ValidCursor = requires (T t, uintptr_t va, PhysicalAddr pa,
 		PageFlags flags, CachingMode mode) {
@@ -2,6 +2,7 @@
 
 #include <frg/optional.hpp>
 #include <stdint.h>
+#include <thor-internal/util.hpp>
 
 namespace thor {
 
@@ -14,6 +15,9 @@ void setTimerDeadline(frg::optional<uint64_t> deadline);
 bool haveTimer();
 // Get the raw timestamp in preemption timer ticks.
 uint64_t getRawTimestampCounter();
+// If user space can read the raw timestamp counter directly and getClockNanos()
+// is derived from it, returns the conversion from counter ticks to nanoseconds.
+frg::optional<FreqFraction> getUserCounterInverseFreq();
 
 // Called by the architecture-specific code. Handles timer deadline
 // expiry.
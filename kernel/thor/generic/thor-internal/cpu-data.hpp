@@ -39,6 +39,13 @@ struct CpuData : public PlatformCpuData {
 	bool haveVirtualization;
 
 	int cpuIndex;
+	// NUMA node that this CPU belongs to (see PhysicalChunkAllocator).
+	int numaNode{0};
+	// Topology of this CPU (used for load balancing).
+	// CPUs with the same coreId are SMT siblings; -1 if unknown (i.e., no SMT siblings).
+	// CPUs with the same packageId share a package; -1 if unknown (i.e., single package).
+	int coreId{-1};
+	int packageId{-1};
 
 	ExecutorContext *executorContext{nullptr};
 	smarter::borrowed_ptr<Thread> activeThread;
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
+
 #include <async/cancellation.hpp>
 #include <frg/functional.hpp>
-#include <frg/hash_map.hpp>
+#include <frg/expected.hpp>
 #include <frg/list.hpp>
 #include <frg/spinlock.hpp>
 
@@ -11,6 +13,7 @@
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/error.hpp>
 #include <thor-internal/kernel_heap.hpp>
+#include <thor-internal/lockstat.hpp>
 #include <thor-internal/work-queue.hpp>
 
 #include <thor-internal/debug.hpp>
@@ -55,13 +58,18 @@ concept Futex = requires(F f) {
 };
 
 struct FutexRealm {
+	// Passed as a count to wake all waiters.
+	static constexpr unsigned int wakeAll = static_cast<unsigned int>(-1);
+
 private:
+	struct Bucket;
+
 	// Represents a single waiter.
 	struct Node {
 		friend struct FutexRealm;
 
 		Node(FutexRealm *realm, FutexIdentity id)
-		: realm_{realm}, id_{id}, cobs_{this} { }
+		: realm_{realm}, id_{id}, bucket_{realm->_bucketFor(id)}, cobs_{this} { }
 
 	protected:
 		virtual void complete() = 0;
@@ -72,53 +80,111 @@ private:
 		void cancel_() {
 			{
 				auto irqLock = frg::guard(&irqMutex());
-				auto lock = frg::guard(&realm_->_mutex);
+				auto bucket = lockBucket_();
 
 				if(!result_) {
-					auto sit = realm_->_slots.get(id_);
-					assert(sit);			
-
-					// Invariant: If the slot exists then its queue is not empty.
-					assert(!sit->queue.empty());
-
-					auto nit = sit->queue.iterator_to(this);
-					sit->queue.erase(nit);
+					assert(queueHook_.in_list);
+					bucket->queue.erase(bucket->queue.iterator_to(this));
 					result_ = Error::cancelled;
-
-					if(sit->queue.empty())
-						realm_->_slots.remove(id_);
 				}else{
 					assert(!queueHook_.in_list);
 				}
+
+				bucket->mutex.unlock();
 			}
 
 			complete();
 		}
 
+		// requeue() can move the node to another bucket while we wait for the lock.
+		// Retry until we hold the lock of the bucket that the node is currently in.
+		Bucket *lockBucket_() {
+			while(true) {
+				auto bucket = bucket_.load(std::memory_order_acquire);
+				bucket->mutex.lock();
+				if(bucket_.load(std::memory_order_relaxed) == bucket)
+					return bucket;
+				bucket->mutex.unlock();
+			}
+		}
+
 		FutexRealm *realm_;
-		FutexIdentity id_;
+		FutexIdentity id_; // Protected by the bucket's mutex.
+		std::atomic<Bucket *> bucket_; // Only changed while holding the bucket's mutex.
 		frg::optional<Error> result_; // Set after completion.
 		async::cancellation_observer<frg::bound_mem_fn<&Node::cancel_>> cobs_;
 		frg::default_list_hook<Node> queueHook_;
 	};
 
-	struct Slot {
-		frg::intrusive_list<
+	using Mutex = ClassSpinlock<"futex">;
+
+	using NodeList = frg::intrusive_list<
+		Node,
+		frg::locate_member<
 			Node,
-			frg::locate_member<
-				Node,
-				frg::default_list_hook<Node>,
-				&Node::queueHook_
-			>
-		> queue;
+			frg::default_list_hook<Node>,
+			&Node::queueHook_
+		>
+	>;
+
+	// Waiters of all futexes that hash to the same bucket share a single queue.
+	// Buckets are padded to a cache line such that unrelated futexes do not contend.
+	struct alignas(64) Bucket {
+		Mutex mutex;
+		NodeList queue;
 	};
 
+	static constexpr size_t numBuckets = 64;
+	static_assert(!(numBuckets & (numBuckets - 1)));
+
+	Bucket *_bucketFor(FutexIdentity id) {
+		return &_buckets[FutexIdentity::Hash{}(id) & (numBuckets - 1)];
+	}
+
+	// Wakes up to count waiters of id. Must be called with the bucket's mutex held.
+	// Waiters that need to be completed are moved to pending.
+	static unsigned int _wakeLocked(Bucket *bucket, FutexIdentity id, unsigned int count,
+			NodeList &pending) {
+		unsigned int n = 0;
+		auto it = bucket->queue.begin();
+		while(it != bucket->queue.end() && n < count) {
+			auto node = *it;
+			++it;
+			if(node->id_ != id)
+				continue;
+			assert(!node->result_);
+			bucket->queue.erase(bucket->queue.iterator_to(node));
+
+			node->result_ = Error::success;
+			if(node->cobs_.try_reset())
+				pending.push_back(node);
+			++n;
+		}
+		return n;
+	}
+
+	static void _completePending(NodeList &pending) {
+		while(!pending.empty()) {
+			auto node = pending.pop_front();
+			node->complete();
+		}
+	}
+
 public:
-	FutexRealm()
-	: _slots{FutexIdentity::Hash{}, *kernelAlloc} { }
+	FutexRealm() = default;
+
+	FutexRealm(const FutexRealm &) = delete;
+
+	FutexRealm &operator= (const FutexRealm &) = delete;
 
 	bool empty() {
-		return _slots.empty();
+		auto irqLock = frg::guard(&irqMutex());
+		for(auto &bucket : _buckets) {
+			auto lock = frg::guard(&bucket.mutex);
+			if(!bucket.queue.empty())
+				return false;
+		}
+		return true;
 	}
 
 	// ----------------------------------------------------------------------------------
@@ -144,7 +210,9 @@ public:
 
 			auto fastPath = [&] {
 				auto irqLock = frg::guard(&irqMutex());
-				auto lock = frg::guard(&realm_->_mutex);
+				// No need for lockBucket_() since the node is not visible to requeue() yet.
+				auto bucket = bucket_.load(std::memory_order_relaxed);
+				auto lock = frg::guard(&bucket->mutex);
 
 				if(f.read() != expected_) {
 					result_ = Error::futexRace;
@@ -156,14 +224,8 @@ public:
 					return true;
 				}
 
-				auto sit = realm_->_slots.get(id_);
-				if(!sit) {
-					realm_->_slots.insert(id_, Slot());
-					sit = realm_->_slots.get(id_);
-				}
-
 				assert(!queueHook_.in_list);
-				sit->queue.push_back(this);
+				bucket->queue.push_back(this);
 				return false;
 			}(); // Immediately invoked.
 
@@ -214,60 +276,80 @@ public:
 
 	// ----------------------------------------------------------------------------------
 
-	void wake(FutexIdentity id) {
-		frg::intrusive_list<
-			Node,
-			frg::locate_member<
-				Node,
-				frg::default_list_hook<Node>,
-				&Node::queueHook_
-			>
-		> pending;
+	// Wakes up to count waiters (in FIFO order). Returns the number of woken waiters.
+	unsigned int wake(FutexIdentity id, unsigned int count = wakeAll) {
+		NodeList pending;
+		unsigned int n;
+		{
+			auto irqLock = frg::guard(&irqMutex());
+			auto bucket = _bucketFor(id);
+			auto lock = frg::guard(&bucket->mutex);
+
+			n = _wakeLocked(bucket, id, count, pending);
+		}
+
+		_completePending(pending);
+		return n;
+	}
+
+	// Wakes up to wakeCount waiters of f and moves up to requeueCount of the remaining
+	// waiters to the futex identified by to. This avoids thundering herds, for example,
+	// when a condition variable is broadcast but all waiters need to reacquire a mutex.
+	// Fails with Error::futexRace if f does not contain the expected value.
+	// Returns the number of woken waiters.
+	template<Futex F>
+	frg::expected<Error, unsigned int> requeue(F f, unsigned int expected, FutexIdentity to,
+			unsigned int wakeCount, unsigned int requeueCount) {
+		auto from = f.getIdentity();
+		NodeList pending;
+		frg::expected<Error, unsigned int> result = Error::futexRace;
 		{
 			auto irqLock = frg::guard(&irqMutex());
-			auto lock = frg::guard(&_mutex);
-
-			auto sit = _slots.get(id);
-			if(!sit)
-				return;
-			// Invariant: If the slot exists then its queue is not empty.
-			assert(!sit->queue.empty());
-
-			// TODO: Enable users to only wake a certain number of waiters.
-			while(!sit->queue.empty()) {
-				auto node = sit->queue.front();
-				assert(!node->result_);
-				sit->queue.pop_front();
-
-				node->result_ = Error::success;
-				if(node->cobs_.try_reset()) {
-					pending.push_back(node);
+			auto src = _bucketFor(from);
+			auto dst = _bucketFor(to);
+
+			// Lock both buckets in a consistent order to avoid deadlocks.
+			auto first = src < dst ? src : dst;
+			auto second = src < dst ? dst : src;
+			auto firstLock = frg::guard(&first->mutex);
+			if(second != first)
+				second->mutex.lock();
+
+			if(f.read() == expected) {
+				auto n = _wakeLocked(src, from, wakeCount, pending);
+
+				unsigned int m = 0;
+				auto it = src->queue.begin();
+				while(it != src->queue.end() && m < requeueCount) {
+					auto node = *it;
+					++it;
+					if(node->id_ != from)
+						continue;
+					assert(!node->result_);
+					if(src != dst) {
+						src->queue.erase(src->queue.iterator_to(node));
+						dst->queue.push_back(node);
+						node->bucket_.store(dst, std::memory_order_release);
+					}
+					node->id_ = to;
+					++m;
 				}
+
+				result = n;
 			}
 
-			if(sit->queue.empty())
-				_slots.remove(id);
+			if(second != first)
+				second->mutex.unlock();
 		}
 
-		while(!pending.empty()) {
-			auto node = pending.pop_front();
-			node->complete();
-		}
+		f.retire();
+
+		_completePending(pending);
+		return result;
 	}
 
 private:
-	using Mutex = frg::ticket_spinlock;
-
-	// TODO: use a scalable hash table with fine-grained locks to
-	// improve the scalability of the futex algorithm.
-	Mutex _mutex;
-
-	frg::hash_map<
-		FutexIdentity,
-		Slot,
-		FutexIdentity::Hash,
-		KernelAlloc
-	> _slots;
+	Bucket _buckets[numBuckets];
 };
 
 } // namespace thor
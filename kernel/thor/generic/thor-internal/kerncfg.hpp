@@ -1,7 +1,37 @@
 #pragma once
 
+#include <stdint.h>
+#include <frg/list.hpp>
+#include <frg/string.hpp>
+
 namespace thor {
 
 void initializeKerncfg();
 
+// Receives the counters of StatisticsSources.
+// The full name of each counter is the concatenation of prefix and name.
+struct StatisticsSink {
+	virtual void emit(frg::string_view prefix, frg::string_view name, uint64_t value) = 0;
+
+	// Emits a counter of a CPU, NUMA node, etc. named <prefix><index><name>
+	// (e.g., "sched.cpu", 1, ".handoffs").
+	void emitIndexed(frg::string_view prefix, size_t index, frg::string_view name, uint64_t value);
+
+protected:
+	~StatisticsSink() = default;
+};
+
+// Subsystems implement this interface to export counters via kerncfg.
+// collectStatistics() is called with IRQs disabled and must not block.
+struct StatisticsSource {
+	virtual void collectStatistics(StatisticsSink &sink) = 0;
+
+	frg::default_list_hook<StatisticsSource> hook;
+
+protected:
+	~StatisticsSource() = default;
+};
+
+void registerStatisticsSource(StatisticsSource *source);
+
 } // namespace thor
@@ -1,17 +1,21 @@
 #pragma once
 
 #include <assert.h>
+#include <atomic>
 #include <frg/slab.hpp>
 #include <frg/spinlock.hpp>
 #include <frg/manual_box.hpp>
 #include <physical-buddy.hpp>
 #include <thor-internal/arch/stack.hpp>
 #include <thor-internal/cpu-data.hpp>
+#include <thor-internal/lockstat.hpp>
+#include <thor-internal/util.hpp>
 
 namespace thor {
 
-struct IrqSpinlock {
-	constexpr IrqSpinlock() = default;
+template<LockClassName Name>
+struct ClassIrqSpinlock {
+	constexpr ClassIrqSpinlock() = default;
 
 	void lock() {
 		irqMutex().lock();
@@ -24,9 +28,11 @@ struct IrqSpinlock {
 	}
 
 private:
-	frg::ticket_spinlock _spinlock;
+	ClassSpinlock<Name> _spinlock;
 };
 
+using IrqSpinlock = ClassIrqSpinlock<"irq-spinlock">;
+
 struct KernelVirtualMemory {
 	using Mutex = frg::ticket_spinlock;
 public:
@@ -73,16 +79,95 @@ public:
 	void output_trace(void *buffer, size_t size);
 };
 
-using KernelAlloc = frg::slab_allocator<KernelVirtualAlloc, IrqSpinlock>;
+using KernelHeap = frg::slab_pool<KernelVirtualAlloc, ClassIrqSpinlock<"kernel-heap">>;
+
+// Small allocations are served from per-CPU magazine caches (as in Bonwick's
+// "Magazines and Vmem" paper) that sit in front of the shared slab pool.
+// Each power-of-two size class has two magazines per CPU and a global depot
+// of full and empty magazines; only the depot and the slab pool are locked.
+inline constexpr int heapCacheMinShift = 5; // 32 bytes.
+inline constexpr int heapCacheMaxShift = 11; // 2 KiB.
+inline constexpr int heapCacheNumClasses = heapCacheMaxShift - heapCacheMinShift + 1;
+
+// Number of objects per magazine. Chosen such that a HeapMagazine is 256 bytes.
+inline constexpr size_t heapMagazineRounds = 30;
+// Maximal number of full (or empty) magazines that the depot keeps per size class.
+inline constexpr size_t heapDepotLimit = 64;
+
+struct HeapMagazine {
+	HeapMagazine *next{nullptr};
+	size_t rounds{0};
+	void *objects[heapMagazineRounds];
+};
+
+// Only written by the owning CPU.
+struct HeapCacheStats {
+	// Allocations served from a magazine (including depot exchanges).
+	OwnerCounter allocHits;
+	// Allocations that had to go to the slab pool.
+	OwnerCounter allocMisses;
+	// Frees that were absorbed by a magazine.
+	OwnerCounter freeHits;
+	// Frees that had to go to the slab pool.
+	OwnerCounter freeMisses;
+	// Number of full magazines taken from the depot.
+	OwnerCounter depotRefills;
+	// Number of full magazines flushed back to the slab pool.
+	OwnerCounter depotFlushes;
+};
+
+struct HeapClassCache {
+	HeapMagazine *loaded{nullptr};
+	HeapMagazine *previous{nullptr};
+	HeapCacheStats stats;
+};
+
+// Per-CPU part of the heap cache. All accesses happen with IRQs disabled.
+struct KernelHeapCache {
+	KernelHeapCache();
+
+	// The per-CPU region is zero-initialized, hence this is false until the
+	// constructor runs (i.e., until per-CPU initializers are executed).
+	bool enabled{false};
+	HeapClassCache classes[heapCacheNumClasses];
+};
+
+extern PerCpu<KernelHeapCache> kernelHeapCache;
+
+// Allocator front-end that is used for all kernel heap allocations.
+// Callers of deallocate() must pass the size that was passed to allocate().
+struct KernelAlloc {
+	explicit KernelAlloc(KernelHeap *pool)
+	: pool_{pool} { }
+
+	void *allocate(size_t size);
+
+	void deallocate(void *pointer, size_t size);
+
+	// Frees memory without knowing its size; this bypasses the per-CPU caches.
+	void free(void *pointer) {
+		pool_->free(pointer);
+	}
+
+private:
+	KernelHeap *pool_;
+};
+
+struct HeapCacheSummary {
+	uint64_t allocHits{0};
+	uint64_t allocMisses{0};
+	uint64_t freeHits{0};
+	uint64_t freeMisses{0};
+	uint64_t depotRefills{0};
+	uint64_t depotFlushes{0};
+};
+
+// Sums up the heap cache statistics of the given size class over all CPUs.
+HeapCacheSummary getHeapCacheSummary(int sizeClass);
 
 extern constinit frg::manual_box<KernelVirtualAlloc> kernelVirtualAlloc;
 
-extern constinit frg::manual_box<
-	frg::slab_pool<
-		KernelVirtualAlloc,
-		IrqSpinlock
-	>
-> kernelHeap;
+extern constinit frg::manual_box<KernelHeap> kernelHeap;
 
 extern constinit frg::manual_box<KernelAlloc> kernelAlloc;
 
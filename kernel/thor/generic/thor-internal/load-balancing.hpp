@@ -1,6 +1,5 @@
 #pragma once
 
-#include <async/barrier.hpp>
 #include <frg/span.hpp>
 #include <thor-internal/coroutine.hpp>
 #include <thor-internal/cpu-data.hpp>
@@ -99,12 +98,17 @@ struct LbNode {
 		>
 	> tasks;
 
-	// Constant during main phase of load balancing.
-	uint64_t totalLoad{0};
+	// Load of all tasks owned by this node. Recomputed periodically by the owning CPU.
+	// Written while holding mutex but read without synchronization by other CPUs.
+	std::atomic<uint64_t> currentLoad{0};
 
-	// Equal to totalLoad before load balancing but updated during load balancing.
-	// Protected by mutex during main phase of load balancing.
-	uint64_t currentLoad{0};
+	// Time of the last attempt to steal tasks while idle.
+	// Only accessed by the owning CPU (with IRQs disabled).
+	uint64_t lastIdleSteal{0};
+
+	// Statistics. Only written by the owning CPU.
+	std::atomic<uint64_t> numPulled{0};
+	std::atomic<uint64_t> numIdleSteals{0};
 };
 
 extern PerCpu<LbNode> lbNode;
@@ -125,14 +129,26 @@ struct LoadBalancer {
 	// The thread is detached from the load balancer when the weak reference goes out of scope.
 	void connect(Thread *thread, CpuData *cpu);
 
+	// Called by the scheduler when the CPU runs out of work (with IRQs disabled).
+	// Pulls a task from a busy CPU, starting with the closest CPUs in the topology.
+	void stealOnIdle(CpuData *cpu);
+
 private:
 	coroutine<void> run_(CpuData *cpu);
 
+	// Recomputes the load of the node from the load of its tasks.
+	void updateLoad_(LbNode *node, bool applyDecay);
+
+	// Pulls tasks from other CPUs in the balancing domain of the given level.
+	// Returns the source of the last task that was pulled, or nullptr.
+	LbNode *balanceDomain_(LbNode *thisNode, int level, bool idle);
+
 	// Move tasks from srcNode to dstNode to balance load.
 	// newLoad: newLoad at dstNode after balancing.
-	void balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &newLoad, uint64_t idealLoad);
-
-	async::barrier barrier_;
+	// runnableOnly: skip tasks that are currently blocked.
+	// Returns the number of moved tasks.
+	size_t balanceBetween_(LbNode *srcNode, LbNode *dstNode, uint64_t &newLoad, uint64_t idealLoad,
+			size_t maxTasks = static_cast<size_t>(-1), bool runnableOnly = false);
 };
 
 } // namespace thor
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <frg/spinlock.hpp>
+#include <thor-internal/arch-generic/timer.hpp>
+
+namespace thor {
+
+// Name of a lock class. Used as template argument, e.g., ClassSpinlock<"universe">.
+template<size_t N>
+struct LockClassName {
+	consteval LockClassName(const char (&s)[N]) {
+		for(size_t i = 0; i < N; ++i)
+			str[i] = s[i];
+	}
+
+	char str[N];
+};
+
+// Contention statistics that are shared by all locks of a lock class.
+// Times are measured in getRawTimestampCounter() ticks.
+struct LockClassStats {
+	constexpr LockClassStats(const char *name)
+	: name{name} { }
+
+	const char *name;
+	std::atomic<uint64_t> numAcquires{0};
+	std::atomic<uint64_t> numContended{0};
+	std::atomic<uint64_t> waitTicks{0};
+	std::atomic<uint64_t> maxHoldTicks{0};
+
+	// Classes are registered on their first acquisition.
+	std::atomic<bool> registered{false};
+	LockClassStats *next{nullptr};
+};
+
+// Adds the class to the list of classes that are exported via kerncfg.
+void registerLockClass(LockClassStats *stats);
+
+// Ticket spinlock that records LockClassStats for its lock class.
+template<LockClassName Name>
+struct InstrumentedSpinlock {
+	constexpr InstrumentedSpinlock() = default;
+
+	InstrumentedSpinlock(const InstrumentedSpinlock &) = delete;
+
+	InstrumentedSpinlock &operator= (const InstrumentedSpinlock &) = delete;
+
+	void lock() {
+		if(!stats.registered.load(std::memory_order_relaxed)
+				&& !stats.registered.exchange(true, std::memory_order_relaxed))
+			registerLockClass(&stats);
+
+		auto ticket = _nextTicket.fetch_add(1, std::memory_order_relaxed);
+		if(_servingTicket.load(std::memory_order_acquire) != ticket) {
+			auto waitStart = getRawTimestampCounter();
+			while(_servingTicket.load(std::memory_order_acquire) != ticket)
+				;
+			_acquireTicks = getRawTimestampCounter();
+			stats.numContended.fetch_add(1, std::memory_order_relaxed);
+			stats.waitTicks.fetch_add(_acquireTicks - waitStart, std::memory_order_relaxed);
+		}else{
+			_acquireTicks = getRawTimestampCounter();
+		}
+		stats.numAcquires.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void unlock() {
+		auto hold = getRawTimestampCounter() - _acquireTicks;
+		auto max = stats.maxHoldTicks.load(std::memory_order_relaxed);
+		while(hold > max && !stats.maxHoldTicks.compare_exchange_weak(max, hold,
+				std::memory_order_relaxed))
+			;
+
+		_servingTicket.store(_servingTicket.load(std::memory_order_relaxed) + 1,
+				std::memory_order_release);
+	}
+
+	static constinit inline LockClassStats stats{Name.str};
+
+private:
+	std::atomic<uint32_t> _nextTicket{0};
+	std::atomic<uint32_t> _servingTicket{0};
+	// Only accessed by the current owner of the lock.
+	uint64_t _acquireTicks{0};
+};
+
+// Spinlock that belongs to a named lock class.
+// Only lockstat builds (-Dkernel_lockstat=true) instrument these locks;
+// otherwise, this is a plain frg::ticket_spinlock.
+#ifdef THOR_LOCKSTAT
+template<LockClassName Name>
+using ClassSpinlock = InstrumentedSpinlock<Name>;
+#else
+template<LockClassName Name>
+using ClassSpinlock = frg::ticket_spinlock;
+#endif
+
+} // namespace thor
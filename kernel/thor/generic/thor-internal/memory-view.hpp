@@ -6,6 +6,7 @@
 #include <async/oneshot-event.hpp>
 #include <async/post-ack.hpp>
 #include <async/recurring-event.hpp>
+#include <frg/rbtree.hpp>
 #include <frg/rcu_radixtree.hpp>
 #include <frg/vector.hpp>
 #include <frg/expected.hpp>
@@ -38,6 +39,8 @@ struct CachePage {
 	static constexpr uint32_t reclaimPosted = 0x02;
 	// Page has been evicted (neither in the LRU, nor in the bundle list).
 	static constexpr uint32_t reclaimInflight = 0x04;
+	// Page is on the active LRU list (instead of the inactive one).
+	static constexpr uint32_t reclaimActive = 0x08;
 
 	// CacheBundle that owns this page.
 	CacheBundle *bundle = nullptr;
@@ -49,7 +52,16 @@ struct CachePage {
 	// Hooks for LRU lists.
 	frg::default_list_hook<CachePage> listHook;
 
+	// Protected by the MemoryReclaimer's lock.
 	uint32_t flags = 0;
+
+	// Set when the page is accessed; consumed by the reclaimer's LRU scan.
+	// This is not protected by any lock such that accesses do not need to take one.
+	std::atomic<bool> referenced{false};
+
+	// CPU whose add batch contains this page (or -1 if it is not in a batch).
+	// Protected by the lock of that batch.
+	std::atomic<int> batchCpu{-1};
 };
 
 // This is the "backend" part of a memory object.
@@ -306,6 +318,10 @@ public:
 	// Result stays valid until the range is evicted.
 	virtual frg::tuple<PhysicalAddr, CachingMode> peekRange(uintptr_t offset) = 0;
 
+	// Like peekRange() but only succeeds if the kLargePageSize range at offset
+	// is backed by a single physically contiguous, naturally aligned large page.
+	virtual frg::tuple<PhysicalAddr, CachingMode> peekLargeRange(uintptr_t offset);
+
 	// Makes a range of memory available for peekRange().
 	virtual coroutine<frg::expected<Error>>
 	touchRange(uintptr_t offset, size_t size, FetchFlags flags, smarter::shared_ptr<WorkQueue> wq);
@@ -319,6 +335,10 @@ public:
 	// Marks a range of pages as dirty.
 	virtual void markDirty(uintptr_t offset, size_t size) = 0;
 
+	// Marks the resident pages of a range as recently used (e.g., for page reclaim).
+	// This is implicit in fetchRange() but not in peekRange().
+	virtual void markAccessed(uintptr_t offset, size_t size);
+
 	virtual void submitManage(ManageNode *handle);
 
 	// Called (e.g. by user space) to update a range after loading or writeback.
@@ -555,7 +575,8 @@ struct SliceRange {
 
 struct MemorySlice {
 	MemorySlice(smarter::shared_ptr<MemoryView> view,
-			ptrdiff_t view_offset, size_t view_size, CachingFlags cachingFlags = 0);
+			ptrdiff_t view_offset, size_t view_size, CachingFlags cachingFlags = 0,
+			bool readOnly = false);
 
 	smarter::shared_ptr<MemoryView> getView() {
 		return _view;
@@ -565,6 +586,11 @@ struct MemorySlice {
 		return cachingFlags_;
 	}
 
+	// Mappings of read-only slices can never become writable or executable.
+	bool isReadOnly() const {
+		return readOnly_;
+	}
+
 	uintptr_t offset() { return _viewOffset; }
 	size_t length() { return _viewSize; }
 
@@ -573,6 +599,7 @@ private:
 	ptrdiff_t _viewOffset;
 	size_t _viewSize;
 	CachingFlags cachingFlags_;
+	bool readOnly_;
 };
 
 // ----------------------------------------------------------------------------------
@@ -750,6 +777,35 @@ struct ImmediateMemory final : MemoryView, GlobalFutexSpace {
 				reinterpret_cast<std::byte *>(accessor.get()) + misalign);
 	}
 
+	void readImmediate(uintptr_t offset, void *pointer, size_t size) {
+		size_t progress = 0;
+		while(progress < size) {
+			auto misalign = (offset + progress) & (kPageSize - 1);
+			auto chunk = frg::min(size - progress, kPageSize - misalign);
+
+			auto index = (offset + progress) >> kPageShift;
+			assert(index < _physicalPages.size());
+			PageAccessor accessor{_physicalPages[index]};
+			memcpy(reinterpret_cast<std::byte *>(pointer) + progress,
+					reinterpret_cast<std::byte *>(accessor.get()) + misalign, chunk);
+			progress += chunk;
+		}
+	}
+
+	void zeroImmediate(uintptr_t offset, size_t size) {
+		size_t progress = 0;
+		while(progress < size) {
+			auto misalign = (offset + progress) & (kPageSize - 1);
+			auto chunk = frg::min(size - progress, kPageSize - misalign);
+
+			auto index = (offset + progress) >> kPageShift;
+			assert(index < _physicalPages.size());
+			PageAccessor accessor{_physicalPages[index]};
+			memset(reinterpret_cast<std::byte *>(accessor.get()) + misalign, 0, chunk);
+			progress += chunk;
+		}
+	}
+
 	void writeImmediate(uintptr_t offset, void *pointer, size_t size) {
 		size_t progress = 0;
 		while(progress < size) {
@@ -799,8 +855,9 @@ private:
 };
 
 struct AllocatedMemory final : MemoryView, GlobalFutexSpace {
+	// A numaNode of -1 allocates from the node of the CPU that triggers the fetch.
 	AllocatedMemory(size_t length, int addressBits = 64,
-			size_t chunkSize = kPageSize, size_t chunkAlign = kPageSize);
+			size_t chunkSize = kPageSize, size_t chunkAlign = kPageSize, int numaNode = -1);
 	AllocatedMemory(const AllocatedMemory &) = delete;
 	~AllocatedMemory();
 
@@ -813,6 +870,7 @@ struct AllocatedMemory final : MemoryView, GlobalFutexSpace {
 	Error lockRange(uintptr_t offset, size_t size) override;
 	void unlockRange(uintptr_t offset, size_t size) override;
 	frg::tuple<PhysicalAddr, CachingMode> peekRange(uintptr_t offset) override;
+	frg::tuple<PhysicalAddr, CachingMode> peekLargeRange(uintptr_t offset) override;
 	coroutine<frg::expected<Error, PhysicalRange>>
 			fetchRange(uintptr_t offset, FetchFlags flags,
 			smarter::shared_ptr<WorkQueue> wq) override;
@@ -826,10 +884,21 @@ public:
 	// Contract: set by the code that constructs this object.
 	smarter::borrowed_ptr<AllocatedMemory> selfPtr;
 private:
+	// Whether the large page block can still be backed by a single large frame.
+	// Must be called with _mutex held.
+	bool _isLargeBlockUnpopulated(size_t block);
+	// Returns PhysicalAddr(-1) if no suitably aligned frame is available.
+	// Called without holding _mutex.
+	PhysicalAddr _allocateZeroedLargeFrame();
+
 	frg::ticket_spinlock _mutex;
 
 	frg::vector<PhysicalAddr, KernelAlloc> _physicalChunks;
+	// For each kLargePageSize block: whether it is backed by a single large frame.
+	// Only used if chunks are exactly one page in size.
+	frg::vector<bool, KernelAlloc> _largeBlocks;
 	int _addressBits;
+	int _numaNode;
 	size_t _chunkSize, _chunkAlign;
 };
 
@@ -979,6 +1048,7 @@ public:
 			fetchRange(uintptr_t offset, FetchFlags flags,
 			smarter::shared_ptr<WorkQueue> wq) override;
 	void markDirty(uintptr_t offset, size_t size) override;
+	void markAccessed(uintptr_t offset, size_t size) override;
 
 	coroutine<frg::expected<Error, PhysicalAddr>> takeGlobalFutex(uintptr_t offset,
 			smarter::shared_ptr<WorkQueue> wq) override;
@@ -1039,6 +1109,76 @@ enum class CowState {
 	hasCopy
 };
 
+// Ordered set of page indices. Used to enumerate the populated entries of
+// sparse page trees in time proportional to the number of entries.
+struct PageIndexSet {
+	PageIndexSet() = default;
+
+	PageIndexSet(const PageIndexSet &) = delete;
+
+	~PageIndexSet();
+
+	PageIndexSet &operator= (const PageIndexSet &) = delete;
+
+	void insert(uint64_t index);
+	void erase(uint64_t index);
+
+	// Calls f(index) for all indices in [begin, end) in increasing order.
+	// f must not modify the set.
+	template<typename F>
+	void forEach(uint64_t begin, uint64_t end, F f) {
+		// Find the first group that can contain indices >= begin.
+		Group *first = nullptr;
+		auto current = _groups.get_root();
+		while(current) {
+			if(current->base < (begin >> groupShift)) {
+				current = GroupTree::get_right(current);
+			}else{
+				first = current;
+				current = GroupTree::get_left(current);
+			}
+		}
+
+		for(auto group = first; group; group = GroupTree::successor(group)) {
+			auto mask = group->mask;
+			while(mask) {
+				auto index = (group->base << groupShift) + __builtin_ctzll(mask);
+				mask &= mask - 1;
+				if(index >= end)
+					return;
+				if(index >= begin)
+					f(index);
+			}
+		}
+	}
+
+private:
+	static constexpr int groupShift = 6;
+
+	// Each group tracks 64 consecutive indices.
+	struct Group {
+		uint64_t base;
+		uint64_t mask = 0;
+		frg::rbtree_hook treeNode;
+	};
+
+	struct GroupLess {
+		bool operator() (const Group &a, const Group &b) {
+			return a.base < b.base;
+		}
+	};
+
+	using GroupTree = frg::rbtree<
+		Group,
+		&Group::treeNode,
+		GroupLess
+	>;
+
+	Group *_findGroup(uint64_t base);
+
+	GroupTree _groups;
+};
+
 struct CowPage {
 	~CowPage();
 
@@ -1056,6 +1196,8 @@ struct CowChain {
 	frg::ticket_spinlock _mutex;
 
 	frg::rcu_radixtree<smarter::shared_ptr<CowPage>, KernelAlloc> _pages;
+	// Indices of all entries in _pages.
+	PageIndexSet _indices;
 };
 
 struct CopyOnWriteMemory final : MemoryView, GlobalFutexSpace /*, MemoryObserver */ {
@@ -1098,6 +1240,8 @@ private:
 	size_t _length;
 	smarter::shared_ptr<CowChain> _copyChain;
 	frg::rcu_radixtree<smarter::shared_ptr<CowPage>, KernelAlloc> _ownedPages;
+	// Indices of all entries in _ownedPages.
+	PageIndexSet _ownedIndices;
 	async::recurring_event _copyEvent;
 	EvictionQueue _evictQueue;
 };
@@ -5,6 +5,7 @@
 #include <bragi/helpers-all.hpp>
 #include <bragi/helpers-frigg.hpp>
 #include <frg/span.hpp>
+#include <thor-internal/arch-generic/timer.hpp>
 #include <thor-internal/main.hpp>
 #include <thor-internal/ring-buffer.hpp>
 #include <ostrace.frigg_bragi.hpp>
@@ -24,6 +25,16 @@ extern std::atomic<bool> available;
 
 struct Context {
 	frg::vector<char, KernelAlloc> buffer{*kernelAlloc};
+
+	// Records are first written to a per-CPU ring. The ring is only written by its own CPU
+	// (with IRQs disabled) and is allocated on first use. A single fiber drains all per-CPU
+	// rings into the global ring, merging them by timestamp.
+	std::atomic<SingleContextRecordRing *> ring{nullptr};
+	// Sequence number of the next record. Gaps in the sequence numbers indicate
+	// records that were overwritten (or discarded) before they were drained.
+	uint64_t nextSeq{0};
+	// Number of records of this CPU that were lost. Updated by the drain fiber.
+	std::atomic<uint64_t> numDropped{0};
 };
 
 extern PerCpu<Context> context;
@@ -85,6 +96,7 @@ void emit(const Event &event, Args... args) {
 
 	managarm::ostrace::EventRecord<KernelAlloc> eventRecord{*kernelAlloc};
 	eventRecord.set_id(static_cast<uint64_t>(event.id()));
+	eventRecord.set_ts(getClockNanos());
 
 	managarm::ostrace::EndOfRecord<KernelAlloc> endOfRecord{*kernelAlloc};
 
@@ -126,5 +138,6 @@ void emit(const Event &event, Args... args) {
 
 extern ostrace::Event ostEvtArmPreemption;
 extern ostrace::Event ostEvtArmCpuTimer;
+extern ostrace::Event ostEvtHandoff;
 
 } // namespace thor
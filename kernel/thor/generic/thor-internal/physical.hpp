@@ -114,6 +114,13 @@ void poisonPhysicalAccess(PhysicalAddr physical);
 void poisonPhysicalWriteAccess(PhysicalAddr physical);
 
 
+// Maximal number of NUMA nodes that the physical allocator distinguishes.
+inline constexpr int maxNumaNodes = 8;
+
+// Distances as defined by the ACPI SLIT (10 = local).
+inline constexpr uint8_t localNumaDistance = 10;
+inline constexpr uint8_t remoteNumaDistance = 20;
+
 class PhysicalChunkAllocator {
 	typedef frg::ticket_spinlock Mutex;
 public:
@@ -122,36 +129,96 @@ public:
 	void bootstrapRegion(PhysicalAddr address,
 			int order, size_t numRoots, int8_t *buddyTree);
 
-	PhysicalAddr allocate(size_t size, int addressBits = 64);
+	// Allocates from the regions of the given NUMA node first and falls back to
+	// other nodes in order of increasing distance. A node of -1 selects
+	// the node of the current CPU.
+	// Allocations and frees of order 0 and order 9 chunks without address restrictions
+	// are served from per-CPU frame caches that are refilled and drained in batches.
+	// Before reporting OOM, the frame caches of all CPUs are returned to the buddy allocator.
+	PhysicalAddr allocate(size_t size, int addressBits = 64, int node = -1);
 	void free(PhysicalAddr address, size_t size);
 
 	size_t numTotalPages() {
 		return _totalPages.load(std::memory_order_relaxed);
 	}
-	size_t numUsedPages() {
-		return _usedPages.load(std::memory_order_relaxed);
-	}
-	size_t numFreePages() {
-		return _freePages.load(std::memory_order_relaxed);
+	// Frames that reside in per-CPU caches are counted as free.
+	size_t numUsedPages();
+	size_t numFreePages();
+
+	// NUMA topology. This is set up (e.g., from the ACPI SRAT) before APs are booted.
+	// Regions that span multiple nodes are split at the boundaries of their buddy roots;
+	// each root is assigned to the node that contains its base address.
+	void assignNumaNode(PhysicalAddr base, size_t length, int node);
+	void setNumaDistance(int from, int to, uint8_t distance);
+	// Must be called after the topology has been changed.
+	void finalizeNumaTopology(int numNodes);
+
+	int numNumaNodes() {
+		return _numNodes;
 	}
+	int numaNodeOf(PhysicalAddr address);
+	size_t numNodeTotalPages(int node);
+	// Unlike numFreePages(), this does not include frames in per-CPU caches.
+	size_t numNodeFreePages(int node);
 
 private:
+	// The following functions must be called with _mutex held.
+	PhysicalAddr _allocateFromBuddy(int target, int addressBits, int node);
+	PhysicalAddr _allocateFromNode(int target, int addressBits, int node);
+	void _freeToBuddy(PhysicalAddr address, int target);
+
+	// Returns all frames in the frame cache of the given CPU to the buddy allocator.
+	// Takes the cache's lock and _mutex.
+	void _drainFrameCache(size_t cpu);
+	// Last resort before reporting OOM: drains the frame caches and retries the allocation.
+	PhysicalAddr _allocateAfterDrain(int target, int addressBits, int node);
+
+	// Moves all roots of region i except for [first, last) to new regions.
+	// Returns false if there are not enough free region slots or if the buddy trees
+	// of the new regions cannot be allocated. Takes _mutex.
+	bool _splitRegion(int i, size_t first, size_t last);
+
 	Mutex _mutex;
 
 	struct Region {
 		PhysicalAddr physicalBase;
 		PhysicalAddr regionSize;
+		int8_t *buddyTree;
+		size_t numRoots;
+		int order;
 		BuddyAccessor buddyAccessor;
+		int node = 0;
+		// Only written with _mutex held.
+		std::atomic<size_t> freePages{0};
 	};
 
-	Region _allRegions[8];
+	// Leaves room for regions that are split at NUMA node boundaries.
+	static constexpr int maxRegions = 16;
+
+	Region _allRegions[maxRegions];
 	int _numRegions = 0;
 
+	int _numNodes = 1;
+	uint8_t _distances[maxNumaNodes][maxNumaNodes];
+	// For each node, all nodes ordered by increasing distance.
+	int _fallbackOrder[maxNumaNodes][maxNumaNodes];
+
 	std::atomic<size_t> _totalPages{0};
 	std::atomic<size_t> _usedPages{0};
 	std::atomic<size_t> _freePages{0};
 };
 
+// Maps platform-specific CPU IDs (e.g., APIC IDs on x86) to NUMA nodes.
+// CPUs that are not registered belong to node 0.
+void setNumaNodeOfPlatformCpu(uint32_t platformId, int node);
+int getNumaNodeOfPlatformCpu(uint32_t platformId);
+
 extern constinit frg::manual_box<PhysicalChunkAllocator> physicalAllocator;
 
+// Allocates a single page that is filled with zeros.
+// Pages are taken from a per-node pool that is refilled in the background;
+// if the pool is empty (or for restricted addressBits), the page is zeroed synchronously.
+// Returns PhysicalAddr(-1) if we run out of memory.
+PhysicalAddr allocateZeroedPage(int addressBits = 64, int node = -1);
+
 } // namespace thor
@@ -6,6 +6,25 @@ namespace thor {
 
 extern bool wantKernelProfile;
 
+constexpr uint32_t profileRecordMagic = 0x50524F46; // 'PROF'.
+
+// Maximal number of frames per call chain (i.e., separately for kernel and user space).
+constexpr size_t maxProfileFrames = 32;
+
+// Each profiling sample consists of this header, followed by numKernelFrames
+// kernel IPs and numUserFrames user IPs (each as a uint64_t, innermost frame first).
+struct ProfileRecordHeader {
+	uint32_t magic;
+	uint16_t numKernelFrames;
+	uint16_t numUserFrames;
+	// Thread and universe that were interrupted (zero if no thread was running).
+	uint64_t threadId;
+	uint64_t universeId;
+};
+
+constexpr size_t maxProfileRecordSize = sizeof(ProfileRecordHeader)
+		+ 2 * maxProfileFrames * sizeof(uint64_t);
+
 void initializeProfile();
 LogRingBuffer *getGlobalProfileRing();
 
@@ -3,10 +3,13 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
+
 #include <frg/list.hpp>
 #include <frg/pairing_heap.hpp>
 #include <frg/spinlock.hpp>
 #include <thor-internal/cpu-data.hpp>
+#include <thor-internal/lockstat.hpp>
 #include <thor-internal/arch-generic/cpu.hpp>
 
 namespace thor {
@@ -89,6 +92,9 @@ private:
 
 	// Unfairness value at slice T.
 	Progress baseUnfairness;
+
+	// See Scheduler::HandoffWindow.
+	bool _handoffWindow = false;
 };
 
 struct ScheduleGreater {
@@ -164,6 +170,30 @@ public:
 
 	ScheduleEntity *currentRunnable();
 
+	// Number of times that the CPU was handed off directly to a woken entity.
+	uint64_t numHandoffs() {
+		return _numHandoffs.load(std::memory_order_relaxed);
+	}
+
+	// While the current entity's handoff window is open, entities that it resumes
+	// on this CPU are recorded as handoff candidates (see resume()).
+	// Syscalls open the window around code that directly wakes up a peer (i.e.,
+	// stream transfers). IRQ handlers close it while they run since their wakeups
+	// are unrelated to the interrupted entity.
+	struct HandoffWindow {
+		HandoffWindow(bool open);
+
+		HandoffWindow(const HandoffWindow &) = delete;
+
+		~HandoffWindow();
+
+		HandoffWindow &operator= (const HandoffWindow &) = delete;
+
+	private:
+		ScheduleEntity *_entity;
+		bool _saved;
+	};
+
 private:
 	void _unschedule();
 	void _schedule();
@@ -196,6 +226,14 @@ private:
 	// See mustCallPreemption().
 	bool _mustCallPreemption{false};
 
+	// Entity that was resumed by _current on this CPU while _current's
+	// handoff window was open (see resume()).
+	// Preferred by _schedule() if _current blocks before the next scheduling decision.
+	ScheduleEntity *_handoffCandidate = nullptr;
+
+	// Only written by the local CPU but read by the statistics code.
+	std::atomic<uint64_t> _numHandoffs{0};
+
 	// The last tick at which the scheduler's state (i.e. progress) was updated.
 	// In our model this is the time point at which slice T started.
 	uint64_t _refClock = 0;
@@ -212,7 +250,7 @@ private:
 	// ----------------------------------------------------------------------------------
 
 	// Note that _mutex *only* protects _pendingList and nothing more!
-	frg::ticket_spinlock _mutex;
+	ClassSpinlock<"scheduler"> _mutex;
 
 	frg::intrusive_list<
 		ScheduleEntity,
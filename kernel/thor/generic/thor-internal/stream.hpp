@@ -13,6 +13,7 @@
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/error.hpp>
 #include <thor-internal/kernel_heap.hpp>
+#include <thor-internal/lockstat.hpp>
 #include <thor-internal/thread.hpp>
 #include <thor-internal/universe.hpp>
 
@@ -74,11 +75,20 @@ inline bool usesFlowProtocol(int tag) {
 	return tag == kTagSendFlow || tag == kTagRecvFlow;
 }
 
+// Flows of at least this size are not bounced through kernel buffers.
+// Instead, the receiver copies directly from the sender's address space.
+inline constexpr size_t directFlowThreshold = 16 * 1024;
+
 struct FlowPacket {
 	void *data = nullptr;
 	size_t size = 0;
+	// For direct transfers: data is a user address in this space.
+	// The sender keeps the space alive until it receives the ack.
+	VirtualSpace *space = nullptr;
 	bool terminate = false;
 	bool fault = false;
+	// Set in acks of direct transfers if the sender's buffer faulted.
+	bool sourceFault = false;
 };
 
 struct StreamNode {
@@ -122,6 +132,9 @@ public:
 	size_t _maxLength;
 	frg::unique_memory<KernelAlloc> _inBuffer;
 	AnyDescriptor _inDescriptor;
+	// For flows that send from (or receive to) a memory object instead of a user buffer.
+	smarter::shared_ptr<MemoryView> _inMemory;
+	uintptr_t _inMemoryOffset = 0;
 
 	StreamNode *peerNode = nullptr;
 
@@ -231,7 +244,7 @@ private:
 
 	frg::optional<Credentials> _creds;
 
-	frg::ticket_spinlock _mutex;
+	ClassSpinlock<"stream"> _mutex;
 
 	// protected by _mutex.
 	frg::intrusive_list<
@@ -267,6 +267,11 @@ public:
 		return &_pagingWorkQueue;
 	}
 
+	// Unique ID of this thread. IDs are never reused; they identify threads in profiles.
+	uint64_t id() {
+		return _id;
+	}
+
 	UserContext &getContext();
 	smarter::borrowed_ptr<Universe> getUniverse();
 	smarter::borrowed_ptr<AddressSpace, BindableHandle> getAddressSpace();
@@ -420,6 +425,8 @@ public:
 
 	// Update the load factor.
 	void updateLoad();
+	// Returns true if the thread is running or waiting to be scheduled (i.e., not blocked).
+	bool isRunnable();
 	// Called periodically by load balancing code.
 	void decayLoad(uint64_t decayFactor, int decayScale);
 
@@ -431,6 +438,7 @@ public:
 	LbControlBlock *_lbCb{nullptr};
 
 private:
+	uint64_t _id;
 	smarter::shared_ptr<Universe> _universe;
 	smarter::shared_ptr<AddressSpace, BindableHandle> _addressSpace;
 
@@ -8,13 +8,17 @@
 #include <frg/intrusive.hpp>
 #include <frg/pairing_heap.hpp>
 #include <frg/spinlock.hpp>
+#include <smarter.hpp>
 #include <thor-internal/arch-generic/timer.hpp>
 #include <thor-internal/cancel.hpp>
+#include <thor-internal/lockstat.hpp>
+#include <thor-internal/util.hpp>
 #include <thor-internal/work-queue.hpp>
 
 namespace thor {
 
 struct CpuData;
+struct MemoryView;
 struct PrecisionTimerEngine;
 
 struct ClockSource {
@@ -43,6 +47,7 @@ struct PrecisionTimerNode {
 	};
 
 	friend struct CompareTimer;
+	friend struct CompareTimerLatest;
 	friend struct PrecisionTimerEngine;
 
 	PrecisionTimerNode()
@@ -59,14 +64,30 @@ struct PrecisionTimerNode {
 		_elapsed = elapsed;
 	}
 
+	// Allows the timer to elapse up to slack nanoseconds after its deadline.
+	// The engine uses this to serve multiple timers by a single IRQ.
+	void setSlack(uint64_t slack) {
+		_slack = slack;
+	}
+
 	bool wasCancelled() {
 		return _wasCancelled;
 	}
 
 	frg::pairing_heap_hook<PrecisionTimerNode> hook;
+	frg::pairing_heap_hook<PrecisionTimerNode> latestHook;
 
 private:
+	// Latest point in time at which the timer needs to elapse.
+	uint64_t _latest() const {
+		uint64_t latest;
+		if(__builtin_add_overflow(_deadline, _slack, &latest))
+			return UINT64_MAX;
+		return latest;
+	}
+
 	uint64_t _deadline;
+	uint64_t _slack = 0;
 	async::cancellation_token _cancelToken;
 	Worklet *_elapsed;
 
@@ -84,11 +105,17 @@ struct CompareTimer {
 	}
 };
 
+struct CompareTimerLatest {
+	bool operator() (const PrecisionTimerNode *a, const PrecisionTimerNode *b) const {
+		return a->_latest() > b->_latest();
+	}
+};
+
 struct PrecisionTimerEngine final {
 	friend struct PrecisionTimerNode;
 
 private:
-	using Mutex = frg::ticket_spinlock;
+	using Mutex = ClassSpinlock<"timer">;
 
 public:
 	PrecisionTimerEngine(CpuData *ourCpu)
@@ -163,6 +190,16 @@ private:
 public:
 	void firedAlarm();
 
+	// Number of timer IRQs and number of timers that elapsed on this engine.
+	// With timer slack, a single IRQ can elapse multiple timers.
+	uint64_t numIrqs() {
+		return _numIrqs.load();
+	}
+
+	uint64_t numElapsed() {
+		return _numElapsed.load();
+	}
+
 private:
 	void _progress();
 
@@ -180,7 +217,24 @@ private:
 		CompareTimer
 	> _timerQueue;
 
+	// Contains the same timers as _timerQueue but ordered by deadline plus slack.
+	// The hardware is armed for the top of this queue; when the IRQ fires,
+	// all timers whose deadline has passed elapse.
+	frg::pairing_heap<
+		PrecisionTimerNode,
+		frg::locate_member<
+			PrecisionTimerNode,
+			frg::pairing_heap_hook<PrecisionTimerNode>,
+			&PrecisionTimerNode::latestHook
+		>,
+		CompareTimerLatest
+	> _latestQueue;
+
 	size_t _activeTimers;
+
+	// Only written by the owning CPU.
+	OwnerCounter _numIrqs;
+	OwnerCounter _numElapsed;
 };
 
 inline void PrecisionTimerNode::CancelFunctor::operator() () {
@@ -196,4 +250,8 @@ void setPreemptionDeadline(frg::optional<uint64_t> deadline);
 // is none.
 frg::optional<uint64_t> getPreemptionDeadline();
 
+// Returns the read-only page that lets user space read the monotonic clock
+// without a syscall (see HelClockPage).
+smarter::shared_ptr<MemoryView> getClockPageMemory();
+
 } // namespace thor
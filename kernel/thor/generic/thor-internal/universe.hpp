@@ -1,8 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <frg/expected.hpp>
+#include <frg/manual_box.hpp>
 #include <frg/variant.hpp>
+#include <frg/vector.hpp>
 #include <assert.h>
 #include <smarter.hpp>
+#include <thor-internal/error.hpp>
+#include <thor-internal/lockstat.hpp>
 #include <thor-internal/mm-rc.hpp>
 #include <thor-internal/virtualization.hpp>
 
@@ -257,31 +263,119 @@ typedef frg::variant<
 // Universe.
 // --------------------------------------------------------
 
+// Descriptors are stored in a three-level table that is indexed by the low bits of the handle.
+// Lookups do not take Universe::lock. Instead, they pin the slot via its reference count;
+// detachDescriptor() waits until all pins are dropped before it removes the descriptor.
+// The upper bits of the handle store a generation number that is bumped whenever
+// a slot is reused, such that stale handles do not refer to new descriptors.
+struct DescriptorSlot {
+	// Bit 0 is set while the slot holds a descriptor.
+	// The remaining bits count the number of readers that pinned the slot.
+	static constexpr uint32_t liveBit = 1;
+	static constexpr uint32_t pinIncrement = 2;
+
+	std::atomic<uint32_t> state{0};
+	std::atomic<Handle> handle{0};
+	// Generation of the next handle that refers to this slot. Protected by Universe::lock.
+	uint64_t generation{0};
+	frg::manual_box<AnyDescriptor> descriptor;
+};
+
+// Keeps a descriptor alive while it is accessed without holding Universe::lock.
+// References must only be held with IRQs disabled (i.e., they must not be held across
+// preemption) since detachDescriptor() busy-waits for them.
+struct DescriptorRef {
+	friend void swap(DescriptorRef &a, DescriptorRef &b) {
+		using std::swap;
+		swap(a._slot, b._slot);
+	}
+
+	DescriptorRef() = default;
+
+	explicit DescriptorRef(DescriptorSlot *slot)
+	: _slot{slot} { }
+
+	DescriptorRef(const DescriptorRef &) = delete;
+
+	DescriptorRef(DescriptorRef &&other)
+	: DescriptorRef() {
+		swap(*this, other);
+	}
+
+	~DescriptorRef() {
+		if(_slot)
+			_slot->state.fetch_sub(DescriptorSlot::pinIncrement, std::memory_order_release);
+	}
+
+	DescriptorRef &operator= (DescriptorRef other) {
+		swap(*this, other);
+		return *this;
+	}
+
+	explicit operator bool () const {
+		return _slot;
+	}
+
+	AnyDescriptor &operator* () const {
+		return *_slot->descriptor;
+	}
+
+	AnyDescriptor *operator-> () const {
+		return _slot->descriptor.get();
+	}
+
+private:
+	DescriptorSlot *_slot{nullptr};
+};
+
 struct Universe {
 public:
-	typedef frg::ticket_spinlock Lock;
-	typedef frg::unique_lock<frg::ticket_spinlock> Guard;
+	typedef ClassSpinlock<"universe"> Lock;
+	typedef frg::unique_lock<Lock> Guard;
+
+	static constexpr int leafShift = 6;
+	static constexpr int middleShift = 7;
+	static constexpr int rootShift = 7;
+	static constexpr int indexBits = leafShift + middleShift + rootShift;
 
 	Universe();
 	~Universe();
 
-	Handle attachDescriptor(Guard &guard, AnyDescriptor descriptor);
+	// Unique ID of this universe. IDs are never reused; they identify universes in profiles.
+	uint64_t id() {
+		return _id;
+	}
+
+	// Fails with Error::noMemory if the universe ran out of descriptor slots.
+	frg::expected<Error, Handle> attachDescriptor(Guard &guard, AnyDescriptor descriptor);
 
-	AnyDescriptor *getDescriptor(Guard &guard, Handle handle);
+	// Does not require Universe::lock. Must be called with IRQs disabled.
+	DescriptorRef getDescriptor(Handle handle);
 
 	frg::optional<AnyDescriptor> detachDescriptor(Guard &guard, Handle handle);
 
 	Lock lock;
 
 private:
-	frg::hash_map<
-		Handle,
-		AnyDescriptor,
-		frg::hash<Handle>,
-		KernelAlloc
-	> _descriptorMap;
-
-	Handle _nextHandle;
+	struct Leaf {
+		DescriptorSlot slots[size_t{1} << leafShift];
+	};
+
+	struct Middle {
+		std::atomic<Leaf *> leaves[size_t{1} << middleShift]{};
+	};
+
+	DescriptorSlot *_findSlot(size_t index);
+	DescriptorSlot *_ensureSlot(Guard &guard, size_t index);
+
+	uint64_t _id;
+
+	std::atomic<Middle *> _root[size_t{1} << rootShift]{};
+
+	// Indices of slots that can be reused. Protected by lock.
+	frg::vector<size_t, KernelAlloc> _freeIndices;
+	// Next index that was never used. Index zero is reserved for kHelNullHandle.
+	size_t _nextIndex;
 };
 
 } // namespace thor
@@ -2,6 +2,7 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <atomic>
 
 namespace thor {
 
@@ -43,4 +44,19 @@ inline FreqFraction computeFreqFraction(uint64_t num, uint64_t denom) {
 	return FreqFraction{f, s};
 }
 
+// Statistics counter that only has a single writer at a time (e.g., the owning CPU)
+// but that can be read concurrently. Increments avoid locked instructions.
+struct OwnerCounter {
+	void bump() {
+		_value.store(_value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	uint64_t load() const {
+		return _value.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<uint64_t> _value{0};
+};
+
 } // namespace thor
@@ -18,6 +18,8 @@ namespace {
 	constexpr bool logRunStates = false;
 	constexpr bool logMigration = false;
 	constexpr bool logCleanup = false;
+
+	std::atomic<uint64_t> nextThreadId{1};
 }
 
 // --------------------------------------------------------
@@ -462,6 +464,7 @@ Thread::Thread(smarter::shared_ptr<Universe> universe,
 		_runState{kRunInterrupted}, _lastInterrupt{kIntrNull}, _stateSeq{1},
 		_pendingKill{false}, _pendingSignal{kSigNone}, _runCount{1},
 		_executor{&_userContext, abi},
+		_id{nextThreadId.fetch_add(1, std::memory_order_relaxed)},
 		_universe{std::move(universe)}, _addressSpace{std::move(address_space)} {
 	_lastRunTimeUpdate = getClockNanos();
 }
@@ -575,6 +578,37 @@ void Thread::doHandlePreemption(bool inManipulableDomain, ImageAccessor image) {
 
 	auto *scheduler = &localScheduler.get();
 
+	// Handle thread migration due to load balancing (see also raiseSignals()).
+	// Without this, CPU-bound threads that rarely enter syscalls would never migrate.
+	if(auto assignedCpu = _lbCb->getAssignedCpu();
+			inManipulableDomain && assignedCpu != getCpuData()) {
+		assert(assignedCpu);
+		auto lock = frg::guard(&_mutex);
+
+		if(logMigration)
+			infoLogger() << "thor: " << (void *)this
+					<< " is moved to CPU " << assignedCpu->cpuIndex << frg::endlog;
+
+		assert(_runState == kRunActive);
+		_updateRunTime();
+		_runState = kRunSuspended;
+		saveExecutor(&_executor, image);
+		scheduler->update();
+		Scheduler::suspendCurrent();
+		_uninvoke();
+		Scheduler::unassociate(this);
+
+		Scheduler::associate(this, &localScheduler.get(assignedCpu));
+		Scheduler::resume(this);
+		scheduler->forceReschedule();
+
+		runOnStack([] (Continuation cont, ImageAccessor image, frg::unique_lock<Mutex> lock) {
+			scrubStack(image, cont);
+			lock.unlock();
+			localScheduler.get().commitReschedule();
+		}, getCpuData()->detachedStack.base(), image, std::move(lock));
+	}
+
 	scheduler->update();
 	if(scheduler->maybeReschedule()) {
 		auto lock = frg::guard(&_mutex);
@@ -656,6 +690,13 @@ void Thread::AssociatedWorkQueue::wakeup() {
 	unblockOther(_thread->self);
 }
 
+bool Thread::isRunnable() {
+	auto irqLock = frg::guard(&irqMutex());
+	auto lock = frg::guard(&_mutex);
+
+	return _runState == kRunActive || _runState == kRunSuspended || _runState == kRunDeferred;
+}
+
 void Thread::updateLoad() {
 	auto irqLock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&_mutex);
@@ -1,5 +1,12 @@
+#include <hel.h>
+#include <initgraph.hpp>
+#include <frg/string.hpp>
 #include <thor-internal/cpu-data.hpp>
 #include <thor-internal/debug.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
+#include <thor-internal/main.hpp>
+#include <thor-internal/memory-view.hpp>
 #include <thor-internal/timer.hpp>
 #include <thor-internal/schedule.hpp>
 
@@ -72,6 +79,7 @@ void setPreemptionDeadline(frg::optional<uint64_t> deadline) {
 
 
 void handleTimerInterrupt() {
+	Scheduler::HandoffWindow handoffWindow{false};
 	auto &state = deadlineState.get();
 	auto now = getClockNanos();
 
@@ -125,6 +133,7 @@ void PrecisionTimerEngine::installTimer(PrecisionTimerNode *timer) {
 	}
 
 	_timerQueue.push(timer);
+	_latestQueue.push(timer);
 	_activeTimers++;
 	timer->_state = TimerState::queued;
 
@@ -137,6 +146,7 @@ void PrecisionTimerEngine::cancelTimer(PrecisionTimerNode *timer) {
 
 	if(timer->_state == TimerState::queued) {
 		_timerQueue.remove(timer);
+		_latestQueue.remove(timer);
 		_activeTimers--;
 		timer->_wasCancelled = true;
 	}else{
@@ -153,6 +163,7 @@ void PrecisionTimerEngine::firedAlarm() {
 	auto irq_lock = frg::guard(&irqMutex());
 	auto lock = frg::guard(&_mutex);
 
+	_numIrqs.bump();
 	_progress();
 }
 
@@ -179,7 +190,9 @@ void PrecisionTimerEngine::_progress() {
 			auto timer = _timerQueue.top();
 			assert(timer->_state == TimerState::queued);
 			_timerQueue.pop();
+			_latestQueue.remove(timer);
 			_activeTimers--;
+			_numElapsed.bump();
 			if(logProgress)
 				infoLogger() << "thor: Timer completed" << frg::endlog;
 			if(timer->_cancelCb.try_reset()) {
@@ -191,9 +204,10 @@ void PrecisionTimerEngine::_progress() {
 			}
 		}
 
-		// Setup the interrupt.
-		assert(!_timerQueue.empty());
-		setTimerEngineDeadline(_timerQueue.top()->_deadline);
+		// Setup the interrupt. Timers with a deadline before this point in time
+		// elapse together with the timer at the top of _latestQueue.
+		assert(!_latestQueue.empty());
+		setTimerEngineDeadline(_latestQueue.top()->_latest());
 
 		// We iterate if there was a race.
 		// Technically, this is optional but it may help to avoid unnecessary IRQs.
@@ -205,4 +219,71 @@ PrecisionTimerEngine *generalTimerEngine() {
 	return &timerEngine.get();
 }
 
+namespace {
+
+struct TimerStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		for(size_t i = 0; i < getCpuCount(); ++i) {
+			auto &engine = timerEngine.getFor(i);
+			sink.emitIndexed("timer.cpu", i, ".irqs", engine.numIrqs());
+			sink.emitIndexed("timer.cpu", i, ".elapsed", engine.numElapsed());
+		}
+	}
+};
+
+constinit TimerStatisticsSource timerStatisticsSource;
+
+initgraph::Task initTimerStatistics{&globalInitEngine, "generic.init-timer-statistics",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		registerStatisticsSource(&timerStatisticsSource);
+	}
+};
+
+} // anonymous namespace
+
+// --------------------------------------------------------
+// Clock page.
+// --------------------------------------------------------
+
+namespace {
+
+constinit frg::manual_box<smarter::shared_ptr<ImmediateMemory>> clockPageMemory;
+
+// Publishes the clock parameters to user space. Readers retry while the seqlock
+// is odd or if it changed during their read.
+void updateClockPage() {
+	auto page = (*clockPageMemory)->accessImmediate<HelClockPage>(0);
+
+	auto seqlock = __atomic_load_n(&page->seqlock, __ATOMIC_RELAXED);
+	__atomic_store_n(&page->seqlock, seqlock + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	if(auto inverseFreq = getUserCounterInverseFreq(); inverseFreq) {
+		__atomic_store_n(&page->source, kHelClockSourceCounter, __ATOMIC_RELAXED);
+		__atomic_store_n(&page->shift, inverseFreq->s, __ATOMIC_RELAXED);
+		__atomic_store_n(&page->multiplier, inverseFreq->f, __ATOMIC_RELAXED);
+	}else{
+		__atomic_store_n(&page->source, kHelClockSourceNone, __ATOMIC_RELAXED);
+	}
+
+	__atomic_store_n(&page->seqlock, seqlock + 2, __ATOMIC_RELEASE);
+}
+
+} // anonymous namespace
+
+static initgraph::Task initClockPage{&globalInitEngine, "generic.init-clock-page",
+	initgraph::Requires{getTaskingAvailableStage()},
+	[] {
+		auto memory = smarter::allocate_shared<ImmediateMemory>(*kernelAlloc, kPageSize);
+		memory->selfPtr = memory;
+		clockPageMemory.initialize(std::move(memory));
+		updateClockPage();
+	}
+};
+
+smarter::shared_ptr<MemoryView> getClockPageMemory() {
+	return *clockPageMemory;
+}
+
 } // namespace thor
@@ -1,37 +1,141 @@
+#include <thor-internal/arch/ints.hpp>
 #include <thor-internal/universe.hpp>
 
 namespace thor {
 
 namespace {
 	constexpr bool logCleanup = false;
+
+	constexpr size_t leafMask = (size_t{1} << Universe::leafShift) - 1;
+	constexpr size_t middleMask = (size_t{1} << Universe::middleShift) - 1;
+	constexpr size_t indexMask = (size_t{1} << Universe::indexBits) - 1;
+
+	std::atomic<uint64_t> nextUniverseId{1};
 }
 
 Universe::Universe()
-: _descriptorMap{frg::hash<Handle>{}, *kernelAlloc}, _nextHandle{1} { }
+: _id{nextUniverseId.fetch_add(1, std::memory_order_relaxed)},
+	_freeIndices{*kernelAlloc}, _nextIndex{1} { }
 
 Universe::~Universe() {
 	if(logCleanup)
 		debugLogger() << "thor: Universe is deallocated" << frg::endlog;
+
+	for(auto &middleEntry : _root) {
+		auto middle = middleEntry.load(std::memory_order_relaxed);
+		if(!middle)
+			continue;
+		for(auto &leafEntry : middle->leaves) {
+			auto leaf = leafEntry.load(std::memory_order_relaxed);
+			if(!leaf)
+				continue;
+			for(auto &slot : leaf->slots) {
+				if(slot.state.load(std::memory_order_relaxed) & DescriptorSlot::liveBit)
+					slot.descriptor.destruct();
+			}
+			frg::destruct(*kernelAlloc, leaf);
+		}
+		frg::destruct(*kernelAlloc, middle);
+	}
+}
+
+DescriptorSlot *Universe::_findSlot(size_t index) {
+	auto middle = _root[index >> (leafShift + middleShift)].load(std::memory_order_acquire);
+	if(!middle)
+		return nullptr;
+	auto leaf = middle->leaves[(index >> leafShift) & middleMask].load(std::memory_order_acquire);
+	if(!leaf)
+		return nullptr;
+	return &leaf->slots[index & leafMask];
 }
 
-Handle Universe::attachDescriptor(Guard &guard, AnyDescriptor descriptor) {
+DescriptorSlot *Universe::_ensureSlot(Guard &guard, size_t index) {
 	assert(guard.protects(&lock));
 
-	Handle handle = _nextHandle++;
-	_descriptorMap.insert(handle, std::move(descriptor));
-	return handle;
+	auto &middleEntry = _root[index >> (leafShift + middleShift)];
+	auto middle = middleEntry.load(std::memory_order_relaxed);
+	if(!middle) {
+		middle = frg::construct<Middle>(*kernelAlloc);
+		middleEntry.store(middle, std::memory_order_release);
+	}
+
+	auto &leafEntry = middle->leaves[(index >> leafShift) & middleMask];
+	auto leaf = leafEntry.load(std::memory_order_relaxed);
+	if(!leaf) {
+		leaf = frg::construct<Leaf>(*kernelAlloc);
+		leafEntry.store(leaf, std::memory_order_release);
+	}
+
+	return &leaf->slots[index & leafMask];
 }
 
-AnyDescriptor *Universe::getDescriptor(Guard &guard, Handle handle) {
+frg::expected<Error, Handle> Universe::attachDescriptor(Guard &guard, AnyDescriptor descriptor) {
 	assert(guard.protects(&lock));
 
-	return _descriptorMap.get(handle);
+	size_t index;
+	if(!_freeIndices.empty()) {
+		index = _freeIndices.back();
+		_freeIndices.pop();
+	}else{
+		if(_nextIndex > indexMask)
+			return Error::noMemory;
+		index = _nextIndex++;
+	}
+
+	auto slot = _ensureSlot(guard, index);
+	// The first handle of each index equals the index itself; this keeps handles small.
+	Handle handle = static_cast<Handle>(index | (slot->generation << indexBits));
+	slot->descriptor.initialize(std::move(descriptor));
+	slot->handle.store(handle, std::memory_order_relaxed);
+	// Publishes both the descriptor and the handle to getDescriptor().
+	slot->state.fetch_or(DescriptorSlot::liveBit, std::memory_order_release);
+	return handle;
+}
+
+DescriptorRef Universe::getDescriptor(Handle handle) {
+	assert(!intsAreEnabled());
+
+	if(handle <= 0)
+		return DescriptorRef{};
+	auto slot = _findSlot(handle & indexMask);
+	if(!slot)
+		return DescriptorRef{};
+
+	// Pin the slot first. Once the pin is visible, detachDescriptor() cannot destruct
+	// the descriptor anymore; hence, we only need to check that it is still live.
+	auto state = slot->state.fetch_add(DescriptorSlot::pinIncrement, std::memory_order_acquire);
+	DescriptorRef ref{slot};
+	if(!(state & DescriptorSlot::liveBit)
+			|| slot->handle.load(std::memory_order_relaxed) != handle)
+		return DescriptorRef{};
+	return ref;
 }
 
 frg::optional<AnyDescriptor> Universe::detachDescriptor(Guard &guard, Handle handle) {
 	assert(guard.protects(&lock));
 
-	return _descriptorMap.remove(handle);
+	if(handle <= 0)
+		return frg::null_opt;
+	size_t index = handle & indexMask;
+	auto slot = _findSlot(index);
+	if(!slot
+			|| !(slot->state.load(std::memory_order_relaxed) & DescriptorSlot::liveBit)
+			|| slot->handle.load(std::memory_order_relaxed) != handle)
+		return frg::null_opt;
+
+	// New readers back off once the live bit is clear; wait for existing readers.
+	// Readers run with IRQs disabled and do not block, so this wait is short.
+	slot->state.fetch_and(~DescriptorSlot::liveBit, std::memory_order_relaxed);
+	while(slot->state.load(std::memory_order_acquire) >= DescriptorSlot::pinIncrement) {
+		// Wait for readers to drop their pins.
+	}
+
+	frg::optional<AnyDescriptor> descriptor{std::move(*slot->descriptor)};
+	slot->descriptor.destruct();
+	slot->handle.store(0, std::memory_order_relaxed);
+	slot->generation++;
+	_freeIndices.push(index);
+	return descriptor;
 }
 
 } // namespace thor
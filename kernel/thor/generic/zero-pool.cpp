@@ -0,0 +1,236 @@
+#include <string.h>
+#include <async/recurring-event.hpp>
+#include <frg/string.hpp>
+#include <initgraph.hpp>
+#include <thor-internal/arch-generic/paging.hpp>
+#include <thor-internal/cpu-data.hpp>
+#include <thor-internal/fiber.hpp>
+#include <thor-internal/kerncfg.hpp>
+#include <thor-internal/kernel_heap.hpp>
+#include <thor-internal/main.hpp>
+#include <thor-internal/physical.hpp>
+#include <thor-internal/timer.hpp>
+
+namespace thor {
+
+namespace {
+
+// Number of pre-zeroed pages that are kept per NUMA node.
+constexpr size_t zeroPoolCapacity = 512;
+// The refill fiber is woken up once a pool drops below this level.
+constexpr size_t zeroPoolLowWatermark = 384;
+// Number of pages that the refill fiber zeroes before it yields.
+// Fibers are not preempted, hence this bounds the latency that refilling adds.
+constexpr size_t zeroPoolBatch = 16;
+
+struct ZeroPool {
+	IrqSpinlock mutex;
+	size_t numPages{0};
+	PhysicalAddr pages[zeroPoolCapacity]{};
+
+	std::atomic<uint64_t> hits{0};
+	std::atomic<uint64_t> misses{0};
+	std::atomic<uint64_t> refills{0};
+};
+
+constinit ZeroPool zeroPools[maxNumaNodes];
+
+constinit frg::manual_box<async::recurring_event> refillEvent;
+constinit std::atomic<bool> refillFiberRunning{false};
+// Avoids raising refillEvent on every allocation while the fiber catches up.
+constinit std::atomic<bool> refillPending{false};
+
+// Zeroes a page that is not expected to be accessed soon.
+// On x86, we use non-temporal stores such that the caches are not polluted.
+void zeroPageNonTemporal(void *page) {
+#if defined(__x86_64__)
+	auto words = reinterpret_cast<uint64_t *>(page);
+	for(size_t i = 0; i < kPageSize / sizeof(uint64_t); i += 4) {
+		asm volatile (
+			"movnti %1, 0(%0)\n"
+			"\tmovnti %1, 8(%0)\n"
+			"\tmovnti %1, 16(%0)\n"
+			"\tmovnti %1, 24(%0)\n"
+			: : "r"(words + i), "r"(uint64_t{0}) : "memory");
+	}
+	// Non-temporal stores are weakly ordered; make them visible before the page is published.
+	asm volatile ("sfence" : : : "memory");
+#else
+	memset(page, 0, kPageSize);
+#endif
+}
+
+bool anyPoolNeedsRefill() {
+	for(int n = 0; n < physicalAllocator->numNumaNodes(); ++n) {
+		auto &pool = zeroPools[n];
+		auto lock = frg::guard(&pool.mutex);
+		if(pool.numPages < zeroPoolLowWatermark)
+			return true;
+	}
+	return false;
+}
+
+enum class RefillStatus {
+	// The whole batch was added to the pool.
+	progress,
+	// The pool is full.
+	full,
+	// We ran out of memory before the batch was complete.
+	exhausted,
+};
+
+RefillStatus refillBatch(int node) {
+	auto &pool = zeroPools[node];
+
+	PhysicalAddr batch[zeroPoolBatch];
+	size_t numBatch = 0;
+	{
+		auto lock = frg::guard(&pool.mutex);
+		if(pool.numPages == zeroPoolCapacity)
+			return RefillStatus::full;
+		numBatch = frg::min(zeroPoolBatch, zeroPoolCapacity - pool.numPages);
+	}
+
+	bool exhausted = false;
+	for(size_t i = 0; i < numBatch; ++i) {
+		auto physical = physicalAllocator->allocate(kPageSize, 64, node);
+		if(physical == PhysicalAddr(-1)) {
+			numBatch = i;
+			exhausted = true;
+			break;
+		}
+		PageAccessor accessor{physical};
+		zeroPageNonTemporal(accessor.get());
+		batch[i] = physical;
+	}
+
+	size_t numStored = 0;
+	{
+		auto lock = frg::guard(&pool.mutex);
+		while(numStored < numBatch && pool.numPages < zeroPoolCapacity)
+			pool.pages[pool.numPages++] = batch[numStored++];
+	}
+	pool.refills.fetch_add(numStored, std::memory_order_relaxed);
+
+	// Another CPU may have freed pages into the pool in the meantime.
+	for(size_t i = numStored; i < numBatch; ++i)
+		physicalAllocator->free(batch[i], kPageSize);
+	if(exhausted)
+		return RefillStatus::exhausted;
+	if(numStored < zeroPoolBatch)
+		return RefillStatus::full;
+	return RefillStatus::progress;
+}
+
+void runRefillFiber() {
+	KernelFiber::run([] {
+		// Only run when the CPU has nothing else to do.
+		Scheduler::setPriority(thisFiber(), -1);
+
+		while(true) {
+			refillPending.store(false, std::memory_order_relaxed);
+			bool exhausted = false;
+			for(int n = 0; n < physicalAllocator->numNumaNodes(); ++n) {
+				while(true) {
+					auto status = refillBatch(n);
+					if(status == RefillStatus::exhausted)
+						exhausted = true;
+					if(status != RefillStatus::progress)
+						break;
+					KernelFiber::asyncBlockCurrent(generalTimerEngine()->sleepFor(100'000));
+				}
+			}
+
+			// The pools still need pages but there is no free memory;
+			// retrying immediately would keep the CPU busy.
+			if(exhausted) {
+				KernelFiber::asyncBlockCurrent(generalTimerEngine()->sleepFor(100'000'000));
+				continue;
+			}
+
+			KernelFiber::asyncBlockCurrent(refillEvent->async_wait_if([] {
+				return !anyPoolNeedsRefill();
+			}));
+		}
+	});
+}
+
+} // anonymous namespace
+
+PhysicalAddr allocateZeroedPage(int addressBits, int node) {
+	if(node < 0)
+		node = getCpuData()->numaNode;
+
+	// The pool does not track address restrictions.
+	if(addressBits >= 64) {
+		auto &pool = zeroPools[node];
+		PhysicalAddr physical = PhysicalAddr(-1);
+		bool needsRefill = false;
+		{
+			auto lock = frg::guard(&pool.mutex);
+			if(pool.numPages) {
+				physical = pool.pages[--pool.numPages];
+				needsRefill = pool.numPages < zeroPoolLowWatermark;
+			}else{
+				needsRefill = true;
+			}
+		}
+
+		if(physical != PhysicalAddr(-1)) {
+			pool.hits.fetch_add(1, std::memory_order_relaxed);
+		}else{
+			pool.misses.fetch_add(1, std::memory_order_relaxed);
+		}
+		if(needsRefill && refillFiberRunning.load(std::memory_order_acquire)
+				&& !refillPending.exchange(true, std::memory_order_relaxed))
+			refillEvent->raise();
+
+		if(physical != PhysicalAddr(-1))
+			return physical;
+	}
+
+	auto physical = physicalAllocator->allocate(kPageSize, addressBits, node);
+	if(physical == PhysicalAddr(-1))
+		return physical;
+	PageAccessor accessor{physical};
+	zeroPage(accessor.get());
+	return physical;
+}
+
+namespace {
+
+struct ZeroPoolStatisticsSource final : StatisticsSource {
+	void collectStatistics(StatisticsSink &sink) override {
+		for(int n = 0; n < physicalAllocator->numNumaNodes(); ++n) {
+			auto &pool = zeroPools[n];
+			size_t numPages;
+			{
+				auto lock = frg::guard(&pool.mutex);
+				numPages = pool.numPages;
+			}
+
+			sink.emitIndexed("zero-pool.node", n, ".pages", numPages);
+			sink.emitIndexed("zero-pool.node", n, ".hits", pool.hits.load(std::memory_order_relaxed));
+			sink.emitIndexed("zero-pool.node", n, ".misses",
+					pool.misses.load(std::memory_order_relaxed));
+			sink.emitIndexed("zero-pool.node", n, ".refills",
+					pool.refills.load(std::memory_order_relaxed));
+		}
+	}
+};
+
+constinit ZeroPoolStatisticsSource zeroPoolStatisticsSource;
+
+initgraph::Task initZeroPool{&globalInitEngine, "generic.init-zero-pool",
+	initgraph::Requires{getFibersAvailableStage()},
+	[] {
+		refillEvent.initialize();
+		refillFiberRunning.store(true, std::memory_order_release);
+		runRefillFiber();
+		registerStatisticsSource(&zeroPoolStatisticsSource);
+	}
+};
+
+} // anonymous namespace
+
+} // namespace thor
@@ -450,7 +450,8 @@ static initgraph::Task loadAcpiNamespaceTask{
 };
 
 static initgraph::Task bootApsTask{
-    &globalInitEngine, "acpi.boot-aps", initgraph::Requires{&loadAcpiNamespaceTask}, [] {
+    &globalInitEngine, "acpi.boot-aps",
+    initgraph::Requires{&loadAcpiNamespaceTask, getNumaDiscoveredStage()}, [] {
 	    if (!getEirInfo()->acpiRsdp)
 		    return;
 
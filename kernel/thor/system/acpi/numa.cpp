@@ -0,0 +1,229 @@
+#include <eir/interface.hpp>
+#include <thor-internal/acpi/acpi.hpp>
+#include <thor-internal/cpu-data.hpp>
+#include <thor-internal/debug.hpp>
+#include <thor-internal/main.hpp>
+#include <thor-internal/physical.hpp>
+
+#include <uacpi/acpi.h>
+#include <uacpi/tables.h>
+
+namespace thor {
+namespace acpi {
+
+// As for the MADT, we mark all SRAT/SLIT structs as [[gnu::packed]].
+
+struct [[gnu::packed]] SratHeader {
+	uint32_t reserved1;
+	uint64_t reserved2;
+};
+
+struct [[gnu::packed]] SratGenericEntry {
+	uint8_t type;
+	uint8_t length;
+};
+
+struct [[gnu::packed]] SratLocalApicEntry {
+	SratGenericEntry generic;
+	uint8_t proximityDomainLow;
+	uint8_t localApicId;
+	uint32_t flags;
+	uint8_t localSapicEid;
+	uint8_t proximityDomainHigh[3];
+	uint32_t clockDomain;
+};
+
+struct [[gnu::packed]] SratMemoryEntry {
+	SratGenericEntry generic;
+	uint32_t proximityDomain;
+	uint16_t reserved1;
+	uint64_t base;
+	uint64_t length;
+	uint32_t reserved2;
+	uint32_t flags;
+	uint64_t reserved3;
+};
+
+struct [[gnu::packed]] SratLocalX2ApicEntry {
+	SratGenericEntry generic;
+	uint16_t reserved1;
+	uint32_t proximityDomain;
+	uint32_t x2ApicId;
+	uint32_t flags;
+	uint32_t clockDomain;
+	uint32_t reserved2;
+};
+
+namespace srat_type {
+static constexpr uint8_t localApic = 0;
+static constexpr uint8_t memory = 1;
+static constexpr uint8_t localX2Apic = 2;
+} // namespace srat_type
+
+namespace srat_flags {
+static constexpr uint32_t enabled = 1;
+} // namespace srat_flags
+
+struct [[gnu::packed]] SlitHeader {
+	uint64_t numLocalities;
+};
+
+namespace {
+
+// ACPI proximity domains are arbitrary 32-bit numbers; we map them to dense node numbers.
+constinit uint32_t proximityDomains[maxNumaNodes];
+constinit int numNodes = 0;
+
+int nodeOfProximityDomain(uint32_t domain) {
+	for(int i = 0; i < numNodes; i++) {
+		if(proximityDomains[i] == domain)
+			return i;
+	}
+	if(numNodes == maxNumaNodes) {
+		infoLogger() << "thor: Ignoring proximity domain " << domain
+				<< " (can only handle " << maxNumaNodes << " NUMA nodes)" << frg::endlog;
+		return -1;
+	}
+	proximityDomains[numNodes] = domain;
+	return numNodes++;
+}
+
+// Returns -1 if the proximity domain is not known.
+int lookupProximityDomain(uint32_t domain) {
+	for(int i = 0; i < numNodes; i++) {
+		if(proximityDomains[i] == domain)
+			return i;
+	}
+	return -1;
+}
+
+void parseSrat() {
+	uacpi_table sratTbl;
+	if(uacpi_table_find_by_signature("SRAT", &sratTbl) != UACPI_STATUS_OK) {
+		infoLogger() << "thor: No SRAT, assuming a single NUMA node" << frg::endlog;
+		return;
+	}
+	auto *srat = sratTbl.hdr;
+
+	size_t offset = sizeof(acpi_sdt_hdr) + sizeof(SratHeader);
+	while(offset + sizeof(SratGenericEntry) <= srat->length) {
+		SratGenericEntry generic;
+		auto genericPtr = reinterpret_cast<void *>(sratTbl.virt_addr + offset);
+		memcpy(&generic, genericPtr, sizeof(generic));
+		if(!generic.length)
+			break;
+
+		switch(generic.type) {
+			case srat_type::localApic: {
+				SratLocalApicEntry entry;
+				memcpy(&entry, genericPtr, sizeof(entry));
+				if(!(entry.flags & srat_flags::enabled))
+					break;
+				uint32_t domain = entry.proximityDomainLow
+						| (uint32_t{entry.proximityDomainHigh[0]} << 8)
+						| (uint32_t{entry.proximityDomainHigh[1]} << 16)
+						| (uint32_t{entry.proximityDomainHigh[2]} << 24);
+				auto node = nodeOfProximityDomain(domain);
+				if(node < 0)
+					break;
+				infoLogger() << "    Local APIC " << (int)entry.localApicId
+						<< " belongs to NUMA node " << node << frg::endlog;
+				setNumaNodeOfPlatformCpu(entry.localApicId, node);
+			} break;
+			case srat_type::localX2Apic: {
+				SratLocalX2ApicEntry entry;
+				memcpy(&entry, genericPtr, sizeof(entry));
+				if(!(entry.flags & srat_flags::enabled))
+					break;
+				auto node = nodeOfProximityDomain(entry.proximityDomain);
+				if(node < 0)
+					break;
+				infoLogger() << "    Local x2APIC " << entry.x2ApicId
+						<< " belongs to NUMA node " << node << frg::endlog;
+				setNumaNodeOfPlatformCpu(entry.x2ApicId, node);
+			} break;
+			case srat_type::memory: {
+				SratMemoryEntry entry;
+				memcpy(&entry, genericPtr, sizeof(entry));
+				if(!(entry.flags & srat_flags::enabled) || !entry.length)
+					break;
+				auto node = nodeOfProximityDomain(entry.proximityDomain);
+				if(node < 0)
+					break;
+				infoLogger() << "    Memory " << frg::hex_fmt{entry.base}
+						<< " - " << frg::hex_fmt{entry.base + entry.length}
+						<< " belongs to NUMA node " << node << frg::endlog;
+				physicalAllocator->assignNumaNode(entry.base, entry.length, node);
+			} break;
+			default:
+				// Do nothing.
+		}
+		offset += generic.length;
+	}
+}
+
+void parseSlit() {
+	uacpi_table slitTbl;
+	if(uacpi_table_find_by_signature("SLIT", &slitTbl) != UACPI_STATUS_OK)
+		return;
+	auto *slit = slitTbl.hdr;
+
+	SlitHeader header;
+	memcpy(&header, reinterpret_cast<void *>(slitTbl.virt_addr + sizeof(acpi_sdt_hdr)),
+			sizeof(header));
+	auto n = header.numLocalities;
+	if(sizeof(acpi_sdt_hdr) + sizeof(SlitHeader) + n * n > slit->length) {
+		infoLogger() << "thor: Ignoring truncated SLIT" << frg::endlog;
+		return;
+	}
+
+	auto matrix = reinterpret_cast<uint8_t *>(slitTbl.virt_addr
+			+ sizeof(acpi_sdt_hdr) + sizeof(SlitHeader));
+	for(uint64_t i = 0; i < n; i++) {
+		auto from = lookupProximityDomain(i);
+		if(from < 0)
+			continue;
+		for(uint64_t j = 0; j < n; j++) {
+			auto to = lookupProximityDomain(j);
+			if(to < 0)
+				continue;
+			physicalAllocator->setNumaDistance(from, to, matrix[i * n + j]);
+		}
+	}
+}
+
+} // anonymous namespace
+
+initgraph::Stage *getNumaDiscoveredStage() {
+	static initgraph::Stage s{&globalInitEngine, "acpi.numa-discovered"};
+	return &s;
+}
+
+static initgraph::Task discoverNumaTask{
+    &globalInitEngine, "acpi.discover-numa",
+    initgraph::Requires{getTablesDiscoveredStage()},
+    initgraph::Entails{getNumaDiscoveredStage()},
+    [] {
+	    if (!getEirInfo()->acpiRsdp)
+		    return;
+
+	    infoLogger() << "thor: Discovering NUMA topology" << frg::endlog;
+	    parseSrat();
+	    if (numNodes <= 1)
+		    return;
+	    parseSlit();
+	    physicalAllocator->finalizeNumaTopology(numNodes);
+
+	    for (int i = 0; i < numNodes; i++)
+		    infoLogger() << "thor: NUMA node " << i << " has "
+		                 << physicalAllocator->numNodeTotalPages(i) << " pages" << frg::endlog;
+
+#ifdef __x86_64__
+	    // APs are booted later and determine their node in bootSecondary().
+	    getCpuData()->numaNode = getNumaNodeOfPlatformCpu(getCpuData()->localApicId);
+#endif
+    }
+};
+
+} // namespace acpi
+} // namespace thor
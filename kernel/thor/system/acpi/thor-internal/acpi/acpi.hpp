@@ -53,6 +53,8 @@ constexpr const uacpi_char *ACPI_HID_POWER_BUTTON = "PNP0C0C";
 initgraph::Stage *getTablesDiscoveredStage();
 initgraph::Stage *getNsAvailableStage();
 initgraph::Stage *getAcpiFiberAvailableStage();
+// Reached once the SRAT/SLIT have been parsed (if present).
+initgraph::Stage *getNumaDiscoveredStage();
 
 void initGlue();
 void initEc();
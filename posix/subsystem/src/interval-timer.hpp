@@ -7,8 +7,9 @@
 namespace posix {
 
 struct IntervalTimer {
-	IntervalTimer(uint64_t initial, uint64_t interval)
-		: initial_(initial), interval_(interval) {
+	// Expirations may be delayed by up to slack nanoseconds to reduce the number of timer IRQs.
+	IntervalTimer(uint64_t initial, uint64_t interval, uint64_t slack = 0)
+		: initial_(initial), interval_(interval), slack_(slack) {
 	}
 
 	virtual ~IntervalTimer() {}
@@ -33,6 +34,7 @@ protected:
 	uint64_t initial_ = 0;
 	uint64_t interval_ = 0;
 	uint64_t nextExpiration_ = 0;
+	uint64_t slack_ = 0;
 
 private:
 	async::cancellation_event cancelEvt_;
@@ -4,6 +4,8 @@
 
 #include "net.hpp"
 #include <core/clock.hpp>
+#include <core/cmdline.hpp>
+#include <frg/cmdline.hpp>
 #include "drvcore.hpp"
 #include "devices/full.hpp"
 #include "devices/helout.hpp"
@@ -174,9 +176,27 @@ async::result<void> enumeratePm() {
 // main() function
 // --------------------------------------------------------
 
+// Busy-polling trades CPU time for IPC latency; enable it if posix runs on a dedicated core.
+async::result<void> configureDispatcher() {
+	Cmdline cmdHelper;
+	auto cmdline = co_await cmdHelper.get();
+	bool busyPoll = false;
+
+	frg::array args = {
+		frg::option{"posix.busy-poll", frg::store_true(busyPoll)},
+	};
+	frg::parse_arguments(cmdline.c_str(), args);
+
+	if(busyPoll) {
+		std::cout << "posix: Enabling busy-polling" << std::endl;
+		helix::Dispatcher::global().enableBusyPolling();
+	}
+}
+
 async::detached runInit() {
 	co_await posix::initOstrace();
 	co_await enumerateKerncfg();
+	co_await configureDispatcher();
 	async::detach(enumeratePm());
 	async::detach(net::enumerateNetserver());
 	co_await populateRootView();
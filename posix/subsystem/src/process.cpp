@@ -1238,6 +1238,7 @@ std::shared_ptr<Process> Process::fork(std::shared_ptr<Process> original) {
 
 	// Signal masks are copied on fork().
 	process->_signalMask = original->_signalMask;
+	process->_timerSlack = original->_timerSlack;
 
 	auto [server_lane, client_lane] = helix::createStream();
 	HEL_CHECK(helTransferDescriptor(
@@ -1367,6 +1368,7 @@ Process::clone(std::shared_ptr<Process> original, void *ip, void *sp, posix::sup
 
 	// Signal masks are copied on clone().
 	process->_signalMask = original->_signalMask;
+	process->_timerSlack = original->_timerSlack;
 
 	auto [server_lane, client_lane] = helix::createStream();
 	HEL_CHECK(helTransferDescriptor(
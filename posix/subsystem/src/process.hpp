@@ -494,6 +494,18 @@ public:
 		return _signalMask;
 	}
 
+	// Default timer slack of Linux (see PR_SET_TIMERSLACK).
+	static constexpr uint64_t defaultTimerSlack = 50'000;
+
+	// Timers armed by this thread may elapse up to this many nanoseconds late.
+	void setTimerSlack(uint64_t slack) {
+		_timerSlack = slack;
+	}
+
+	uint64_t timerSlack() {
+		return _timerSlack;
+	}
+
 	HelHandle clientPosixLane() { return _clientPosixLane; }
 	posix::ThreadPage *clientThreadPage() { return _clientThreadPage; }
 	void *clientFileTable() { return _clientFileTable; }
@@ -615,6 +627,8 @@ private:
 
 	uint64_t _signalMask;
 
+	uint64_t _timerSlack = defaultTimerSlack;
+
 	bool _altStackEnabled = false;
 	uint64_t _altStackSp = 0;
 	size_t _altStackSize = 0;
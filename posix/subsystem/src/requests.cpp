@@ -192,6 +192,7 @@ async::result<void> serveRequests(std::shared_ptr<Process> self,
 		MAKE_CASE(GetSid)
 		MAKE_CASE(ParentDeathSignal)
 		MAKE_CASE(ProcessDumpable)
+		MAKE_CASE(TimerSlack)
 		MAKE_CASE(SetResourceLimit)
 		// From socket.cpp
 		MAKE_CASE(Netserver)
@@ -843,7 +844,8 @@ async::result<void> serveRequests(std::shared_ptr<Process> self,
 							// if the timeout runs to completion, i.e. the sleep does not return
 							// false to signal cancellation, we DO NOT consider the call to have
 							// been interrupted.
-							co_await helix::sleepFor(static_cast<uint64_t>(timeout), c);
+							co_await helix::sleepFor(static_cast<uint64_t>(timeout), c,
+									self->timerSlack());
 						}),
 						async::lambda([&](auto c) -> async::result<void> {
 							co_await async::suspend_indefinitely(c, cancelEvent);
@@ -172,6 +172,7 @@ async::result<void> handleSetPgid(RequestContext& ctx);
 async::result<void> handleGetSid(RequestContext& ctx);
 async::result<void> handleParentDeathSignal(RequestContext& ctx);
 async::result<void> handleProcessDumpable(RequestContext& ctx);
+async::result<void> handleTimerSlack(RequestContext& ctx);
 async::result<void> handleSetResourceLimit(RequestContext& ctx);
 
 // From socket.cpp
@@ -410,6 +410,36 @@ async::result<void> handleProcessDumpable(RequestContext& ctx) {
 	logBragiReply(ctx, resp);
 }
 
+// TIMER_SLACK handler (PR_SET_TIMERSLACK and PR_GET_TIMERSLACK)
+async::result<void> handleTimerSlack(RequestContext& ctx) {
+	auto req = bragi::parse_head_only<managarm::posix::TimerSlackRequest>(ctx.recv_head);
+
+	if (!req) {
+		std::cout << "posix: Rejecting request due to decoding failure" << std::endl;
+		co_return;
+	}
+
+	logRequest(logRequests, ctx, "TIMER_SLACK", "set={} value={}", req->set(), req->new_value());
+
+	managarm::posix::TimerSlackResponse resp;
+	resp.set_error(managarm::posix::Errors::SUCCESS);
+
+	if(req->set()) {
+		// Like on Linux, zero resets the slack to its default value.
+		ctx.self->setTimerSlack(req->new_value() ? req->new_value() : Process::defaultTimerSlack);
+	}
+
+	resp.set_value(ctx.self->timerSlack());
+
+	auto [send_resp] = co_await helix_ng::exchangeMsgs(
+		ctx.conversation,
+		helix_ng::sendBragiHeadOnly(resp, frg::stl_allocator{})
+	);
+
+	HEL_CHECK(send_resp.error());
+	logBragiReply(ctx, resp);
+}
+
 // SET_RESOURCE_LIMIT handler
 async::result<void> handleSetResourceLimit(RequestContext& ctx) {
 	auto req = bragi::parse_head_only<managarm::posix::SetResourceLimitRequest>(ctx.recv_head);
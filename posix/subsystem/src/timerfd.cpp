@@ -30,8 +30,8 @@ bool logTimerfd = false;
 struct OpenFile : File {
 private:
 	struct Timer : posix::IntervalTimer {
-		Timer(smarter::weak_ptr<File> file, uint64_t initial, uint64_t interval)
-		: IntervalTimer{initial, interval}, file_{file} {
+		Timer(smarter::weak_ptr<File> file, uint64_t initial, uint64_t interval, uint64_t slack)
+		: IntervalTimer{initial, interval, slack}, file_{file} {
 			assert(file_.lock()->kind() == FileKind::timerfd);
 		}
 
@@ -205,7 +205,7 @@ public:
 		return _passthrough;
 	}
 
-	void setTime(bool relative, const timespec initial, const timespec interval) {
+	void setTime(bool relative, const timespec initial, const timespec interval, uint64_t slack) {
 		uint64_t initialNanos = 0;
 		uint64_t intervalNanos = 0;
 
@@ -217,7 +217,7 @@ public:
 		if(_activeTimer)
 			_activeTimer->cancel();
 		if(initialNanos || intervalNanos) {
-			_activeTimer = std::make_shared<Timer>(weakFile(), initialNanos, intervalNanos);
+			_activeTimer = std::make_shared<Timer>(weakFile(), initialNanos, intervalNanos, slack);
 			_expirations = 0;
 			Timer::arm(_activeTimer);
 		} else {
@@ -272,13 +272,14 @@ smarter::shared_ptr<File, FileHandle> createFile(int clock, bool non_block) {
 	return File::constructHandle(std::move(file));
 }
 
-void setTime(File *file, int flags, struct timespec initial, struct timespec interval) {
+void setTime(File *file, int flags, struct timespec initial, struct timespec interval,
+		uint64_t slack) {
 	if(logTimerfd)
 		std::cout << "setTime() initial: " << initial.tv_sec << " + " << initial.tv_nsec
 				<< ", interval: " << interval.tv_sec << " + " << interval.tv_nsec << std::endl;
 
 	auto timerfd = static_cast<OpenFile *>(file);
-	timerfd->setTime(!(flags & TFD_TIMER_ABSTIME), initial, interval);
+	timerfd->setTime(!(flags & TFD_TIMER_ABSTIME), initial, interval, slack);
 }
 
 void getTime(File *file, timespec &initial, timespec &interval) {
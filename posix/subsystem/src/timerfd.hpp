@@ -6,7 +6,9 @@
 namespace timerfd {
 
 smarter::shared_ptr<File, FileHandle> createFile(int clock, bool non_block);
-void setTime(File *file, int flags, struct timespec initial, struct timespec interval);
+// Expirations may be delayed by up to slack nanoseconds.
+void setTime(File *file, int flags, struct timespec initial, struct timespec interval,
+		uint64_t slack = 0);
 void getTime(File *file, timespec &initial, timespec &interval);
 
 } // namespace timerfd
@@ -17,6 +17,7 @@
 #include <sys/socket.h>
 
 #include <deque>
+#include <functional>
 #include <memory>
 
 namespace managarm::fs {
@@ -54,6 +55,11 @@ using SeekResult = std::variant<Error, int64_t>;
 using GetLinkResult = std::tuple<std::shared_ptr<void>, int64_t, FileType>;
 
 using OpenResult = std::pair<helix::UniqueLane, helix::UniqueLane>;
+
+// Transfers data between the client and a range of a memory object
+// (e.g., the page cache of a file). Returns the number of bytes that were actually transferred.
+using MemoryRangeTransfer = std::function<async::result<size_t>(
+		helix::BorrowedDescriptor memory, uintptr_t offset, size_t length)>;
 using AcceptResult = std::pair<helix::UniqueLane, helix::UniqueLane>;
 
 using MkdirResult = std::pair<std::shared_ptr<void>, int64_t>;
@@ -161,6 +167,26 @@ struct FileOperations {
 			const void *buffer, size_t length) = nullptr;
 	async::result<frg::expected<protocols::fs::Error, size_t>> (*pwrite)(void *object, int64_t offset, helix_ng::CredentialsView credentials,
 			const void *buffer, size_t length) = nullptr;
+	// Alternatives to read/pread/write/pwrite for files that are backed by a memory object.
+	// They invoke the transfer (at most once) to send the data directly from the memory object
+	// or to receive it directly into the memory object. The range passed to the transfer
+	// is valid until the transfer completes.
+	// readRange/preadRange advance the file offset by the number of bytes that were actually sent.
+	// writeRange/pwriteRange grow the file and commit the file size and offset
+	// according to the number of bytes that were actually received. If they fail without
+	// invoking the transfer, the server still needs to consume the client's data.
+	async::result<frg::expected<protocols::fs::Error, size_t>> (*readRange)(void *object,
+			helix_ng::CredentialsView credentials, size_t length,
+			async::cancellation_token cancellation, MemoryRangeTransfer transfer) = nullptr;
+	async::result<frg::expected<protocols::fs::Error, size_t>> (*preadRange)(void *object,
+			int64_t offset, helix_ng::CredentialsView credentials, size_t length,
+			MemoryRangeTransfer transfer) = nullptr;
+	async::result<frg::expected<protocols::fs::Error, size_t>> (*writeRange)(void *object,
+			helix_ng::CredentialsView credentials, size_t length,
+			MemoryRangeTransfer transfer) = nullptr;
+	async::result<frg::expected<protocols::fs::Error, size_t>> (*pwriteRange)(void *object,
+			int64_t offset, helix_ng::CredentialsView credentials, size_t length,
+			MemoryRangeTransfer transfer) = nullptr;
 	async::result<ReadEntriesResult> (*readEntries)(void *object) = nullptr;
 	async::result<helix::BorrowedDescriptor>(*accessMemory)(void *object) = nullptr;
 	async::result<frg::expected<protocols::fs::Error>> (*truncate)(void *object, size_t size) = nullptr;
@@ -79,6 +79,33 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 		);
 	};
 
+	// Sends a successful response followed by the data directly from the memory object
+	// (i.e., without copying through our buffers). Returns the number of bytes that were sent.
+	auto sendResponseFromMemory = [&] (helix::BorrowedDescriptor memory, uintptr_t offset,
+			size_t length) -> async::result<size_t> {
+		managarm::fs::SvrResponse resp;
+		resp.set_error(managarm::fs::Errors::SUCCESS);
+
+		auto ser = resp.SerializeAsString();
+		auto [send_resp, send_data] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::sendBuffer(ser.data(), ser.size()),
+			helix_ng::sendFromMemory(memory, offset, length)
+		);
+		HEL_CHECK(send_resp.error());
+		logBragiSerializedReply(ser);
+
+		// Faults (on either side) only fail this request.
+		if(send_data.error() == kHelErrFault || send_data.error() == kHelErrRemoteFault) {
+			if(file_ops->logRequests)
+				std::cout << "handlePassThrough(): failed to send from memory, error "
+						<< send_data.error() << std::endl;
+			co_return 0;
+		}
+		HEL_CHECK(send_data.error());
+		co_return length;
+	};
+
 	if(req.req_type() == managarm::fs::CntReqType::SEEK_ABS) {
 		if(!file_ops->seekAbs) {
 			managarm::fs::SvrResponse resp;
@@ -182,6 +209,57 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 		);
 		HEL_CHECK(extract_creds.error());
 
+		if(file_ops->readRange) {
+			frg::expected<protocols::fs::Error, size_t> res = protocols::fs::Error::internalError;
+			bool transferred = false;
+			{
+				auto cancelEvent = cancellationEvents.event(extract_creds.credentials(),
+						req.cancellation_id());
+				if (!cancelEvent) {
+					std::println("protocols/fs: possibly duplicate cancellation ID registered");
+					managarm::fs::SvrResponse resp;
+					resp.set_error(managarm::fs::Errors::INTERNAL_ERROR);
+
+					auto ser = resp.SerializeAsString();
+					auto [send_resp] = co_await helix_ng::exchangeMsgs(
+						conversation,
+						helix_ng::sendBuffer(ser.data(), ser.size())
+					);
+					HEL_CHECK(send_resp.error());
+					logBragiSerializedReply(ser);
+					co_return;
+				}
+
+				res = co_await file_ops->readRange(file.get(), extract_creds.credentials(),
+						req.size(), cancelEvent,
+						[&] (helix::BorrowedDescriptor memory, uintptr_t offset,
+								size_t length) -> async::result<size_t> {
+					transferred = true;
+					co_return co_await sendResponseFromMemory(conversation, memory, offset, length);
+				});
+			}
+
+			if(!transferred) {
+				managarm::fs::SvrResponse resp;
+				if(!res) {
+					resp.set_error(res.error() | toFsError);
+				}else{
+					resp.set_error(managarm::fs::Errors::SUCCESS);
+				}
+
+				auto ser = resp.SerializeAsString();
+				auto [send_resp, send_data] = co_await helix_ng::exchangeMsgs(
+					conversation,
+					helix_ng::sendBuffer(ser.data(), ser.size()),
+					helix_ng::sendBuffer(nullptr, 0)
+				);
+				HEL_CHECK(send_resp.error());
+				HEL_CHECK(send_data.error());
+				logBragiSerializedReply(ser);
+			}
+			co_return;
+		}
+
 		if(!file_ops->read) {
 			managarm::fs::SvrResponse resp;
 			resp.set_error(managarm::fs::Errors::ILLEGAL_OPERATION_TARGET);
@@ -251,6 +329,45 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 		);
 		HEL_CHECK(extract_creds.error());
 
+		if(file_ops->preadRange) {
+			bool transferred = false;
+			auto res = co_await file_ops->preadRange(file.get(), req.offset(),
+					extract_creds.credentials(), req.size(),
+					[&] (helix::BorrowedDescriptor memory, uintptr_t offset,
+							size_t length) -> async::result<size_t> {
+				transferred = true;
+				co_return co_await sendResponseFromMemory(conversation, memory, offset, length);
+			});
+
+			if(!transferred) {
+				managarm::fs::SvrResponse resp;
+				if(!res) {
+					resp.set_error(res.error() | toFsError);
+
+					auto ser = resp.SerializeAsString();
+					auto [send_resp] = co_await helix_ng::exchangeMsgs(
+						conversation,
+						helix_ng::sendBuffer(ser.data(), ser.size())
+					);
+					HEL_CHECK(send_resp.error());
+					logBragiSerializedReply(ser);
+				}else{
+					resp.set_error(managarm::fs::Errors::SUCCESS);
+
+					auto ser = resp.SerializeAsString();
+					auto [send_resp, send_data] = co_await helix_ng::exchangeMsgs(
+						conversation,
+						helix_ng::sendBuffer(ser.data(), ser.size()),
+						helix_ng::sendBuffer(nullptr, 0)
+					);
+					HEL_CHECK(send_resp.error());
+					HEL_CHECK(send_data.error());
+					logBragiSerializedReply(ser);
+				}
+			}
+			co_return;
+		}
+
 		if(!file_ops->pread) {
 			managarm::fs::SvrResponse resp;
 			resp.set_error(managarm::fs::Errors::ILLEGAL_OPERATION_TARGET);
@@ -294,6 +411,56 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 			HEL_CHECK(send_data.error());
 			logBragiSerializedReply(ser);
 		}
+	}else if(req.req_type() == managarm::fs::CntReqType::WRITE
+			&& file_ops->writeRange) {
+		auto [extract_creds] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::extractCredentials()
+		);
+		HEL_CHECK(extract_creds.error());
+
+		// Receive directly into the memory object (i.e., without copying through our buffers).
+		bool transferred = false;
+		auto res = co_await file_ops->writeRange(file.get(), extract_creds.credentials(),
+				req.size(),
+				[&] (helix::BorrowedDescriptor memory, uintptr_t offset,
+						size_t length) -> async::result<size_t> {
+			transferred = true;
+			auto [recv_buffer] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::recvToMemory(memory, offset, length)
+			);
+			HEL_CHECK(recv_buffer.error());
+			co_return recv_buffer.actualLength();
+		});
+
+		managarm::fs::SvrResponse resp;
+		if(!transferred) {
+			// We still need to consume the data that the client sends.
+			std::vector<uint8_t> buffer;
+			buffer.resize(req.size());
+
+			auto [recv_buffer] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::recvBuffer(buffer.data(), buffer.size())
+			);
+			HEL_CHECK(recv_buffer.error());
+		}
+
+		if(!res) {
+			resp.set_error(res.error() | toFsError);
+		}else{
+			resp.set_error(managarm::fs::Errors::SUCCESS);
+			resp.set_size(res.value());
+		}
+
+		auto ser = resp.SerializeAsString();
+		auto [send_resp] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::sendBuffer(ser.data(), ser.size())
+		);
+		HEL_CHECK(send_resp.error());
+		logBragiSerializedReply(ser);
 	}else if(req.req_type() == managarm::fs::CntReqType::WRITE) {
 		std::vector<uint8_t> buffer;
 		buffer.resize(req.size());
@@ -345,6 +512,56 @@ async::detached handlePassthrough(smarter::shared_ptr<void> file,
 			HEL_CHECK(send_resp.error());
 			logBragiSerializedReply(ser);
 		}
+	}else if(req.req_type() == managarm::fs::CntReqType::PT_PWRITE
+			&& file_ops->pwriteRange) {
+		auto [extract_creds] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::extractCredentials()
+		);
+		HEL_CHECK(extract_creds.error());
+
+		// Receive directly into the memory object (i.e., without copying through our buffers).
+		bool transferred = false;
+		auto res = co_await file_ops->pwriteRange(file.get(), req.offset(), extract_creds.credentials(),
+				req.size(),
+				[&] (helix::BorrowedDescriptor memory, uintptr_t offset,
+						size_t length) -> async::result<size_t> {
+			transferred = true;
+			auto [recv_buffer] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::recvToMemory(memory, offset, length)
+			);
+			HEL_CHECK(recv_buffer.error());
+			co_return recv_buffer.actualLength();
+		});
+
+		managarm::fs::SvrResponse resp;
+		if(!transferred) {
+			// We still need to consume the data that the client sends.
+			std::vector<uint8_t> buffer;
+			buffer.resize(req.size());
+
+			auto [recv_buffer] = co_await helix_ng::exchangeMsgs(
+				conversation,
+				helix_ng::recvBuffer(buffer.data(), buffer.size())
+			);
+			HEL_CHECK(recv_buffer.error());
+		}
+
+		if(!res) {
+			resp.set_error(res.error() | toFsError);
+		}else{
+			resp.set_error(managarm::fs::Errors::SUCCESS);
+			resp.set_size(res.value());
+		}
+
+		auto ser = resp.SerializeAsString();
+		auto [send_resp] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::sendBuffer(ser.data(), ser.size())
+		);
+		HEL_CHECK(send_resp.error());
+		logBragiSerializedReply(ser);
 	}else if(req.req_type() == managarm::fs::CntReqType::PT_PWRITE) {
 		std::vector<uint8_t> buffer;
 		buffer.resize(req.size());
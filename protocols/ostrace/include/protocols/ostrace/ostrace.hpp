@@ -1,11 +1,14 @@
 #pragma once
 
+#include <array>
 #include <span>
 #include <string>
 
 #include <async/queue.hpp>
 #include <async/result.hpp>
+#include <helix/clock.hpp>
 #include <helix/ipc.hpp>
+#include <helix/memory.hpp>
 #include <ostrace.bragi.hpp>
 
 namespace protocols::ostrace {
@@ -146,8 +149,14 @@ struct Context {
 		(determineSize(args.second), ...);
 		determineSize(endOfRecord);
 
-		std::vector<char> buffer;
-		buffer.resize(size);
+		// Avoid a heap allocation for typical records.
+		std::array<char, 256> smallBuffer;
+		std::vector<char> largeBuffer;
+		std::span<char> buffer{smallBuffer.data(), size};
+		if(size > smallBuffer.size()) {
+			largeBuffer.resize(size);
+			buffer = {largeBuffer.data(), size};
+		}
 
 		// Emit all records to the buffer.
 		size_t offset = 0;
@@ -163,7 +172,7 @@ struct Context {
 		(emitMsg(args.second), ...);
 		emitMsg(endOfRecord);
 
-		queue_.put(std::move(buffer));
+		emitBuffer_(buffer);
 	}
 
 	template<typename... Args>
@@ -173,26 +182,34 @@ struct Context {
 
 private:
 	async::result<ItemId> announceItem_(std::string_view name);
+	async::result<void> openRing_();
 	async::result<void> run_();
 
+	// Appends the buffer to the shared-memory ring if possible; otherwise, the buffer
+	// is sent to the kernel via IPC.
+	void emitBuffer_(std::span<const char> buffer);
+	bool appendToRing_(std::span<const char> buffer);
+
 	Vocabulary *vocabulary_;
 	helix::UniqueLane lane_;
 	bool enabled_ = false;
 	async::queue<std::vector<char>, frg::stl_allocator> queue_;
+
+	// Shared-memory ring (see ring.hpp). The kernel drains the ring until ringLane_ is closed.
+	helix::UniqueLane ringLane_;
+	helix::Mapping ringMapping_;
+	size_t ringSize_ = 0;
 };
 
 struct Timer {
-	Timer() {
-		HEL_CHECK(helGetClock(&_start));
-	}
+	Timer()
+	: _start{helix::getClockNanos()} { }
 
 	Timer(const Timer &) = delete;
 	Timer &operator= (const Timer &) = delete;
 
 	uint64_t elapsed() {
-		uint64_t now;
-		HEL_CHECK(helGetClock(&now));
-		return now - _start;
+		return helix::getClockNanos() - _start;
 	}
 
 private:
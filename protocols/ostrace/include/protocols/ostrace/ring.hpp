@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Layout of the shared-memory rings that ostrace contexts use to pass records to the kernel.
+// This header is shared between user space and the kernel.
+
+namespace protocols::ostrace {
+
+// Located at the start of the ring memory. The records start at ringDataOffset.
+// All fields are accessed atomically.
+struct RingHeader {
+	// Producers (i.e., the ostrace context) reserve space by advancing head.
+	uint64_t head;
+	// The consumer (i.e., the kernel) advances tail after it has drained a record.
+	// The consumer never reads tail back, hence producers cannot change it.
+	uint64_t tail;
+	// Number of records that producers dropped because the ring was full.
+	uint64_t dropped;
+};
+
+// Each record starts with this header. Records are aligned to ringRecordAlign,
+// hence the header never wraps around the end of the ring (but the payload may).
+// The consumer zeros all records that it drains, such that a non-zero committed field
+// always belongs to a record that was completely written by a producer.
+struct RingRecordHeader {
+	// Size of the payload (i.e., excluding this header).
+	uint32_t size;
+	// Written (with release semantics) after the payload was written.
+	uint32_t committed;
+};
+
+inline constexpr size_t ringDataOffset = 0x1000;
+inline constexpr size_t ringRecordAlign = 8;
+
+// Larger records are not sent through the ring.
+inline constexpr size_t ringMaxPayloadSize = 0x2000;
+
+inline constexpr size_t ringRecordSize(size_t payloadSize) {
+	return (sizeof(RingRecordHeader) + payloadSize + ringRecordAlign - 1)
+			& ~(ringRecordAlign - 1);
+}
+
+} // namespace protocols::ostrace
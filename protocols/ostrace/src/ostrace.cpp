@@ -1,8 +1,13 @@
+#include <string.h>
+
+#include <algorithm>
+
 #include <async/oneshot-event.hpp>
 #include <bragi/helpers-std.hpp>
 #include <frg/std_compat.hpp>
 #include <protocols/mbus/client.hpp>
 #include <protocols/ostrace/ostrace.hpp>
+#include <protocols/ostrace/ring.hpp>
 #include <ostrace.bragi.hpp>
 
 namespace protocols::ostrace {
@@ -57,6 +62,7 @@ async::result<void> Context::create() {
 	for (auto *term : vocabulary_->terms())
 		co_await define(term);
 
+	co_await openRing_();
 	async::detach(run_());
 }
 
@@ -86,6 +92,87 @@ async::result<ItemId> Context::announceItem_(std::string_view name) {
 	co_return ItemId{resp.id()};
 }
 
+async::result<void> Context::openRing_() {
+	managarm::ostrace::OpenRingReq req;
+
+	auto [offer, sendReq, recvResp, pullMemory] =
+		co_await helix_ng::exchangeMsgs(
+			lane_,
+			helix_ng::offer(
+				helix_ng::sendBragiHeadOnly(req, frg::stl_allocator{}),
+				helix_ng::recvInline(),
+				helix_ng::pullDescriptor()
+			)
+		);
+
+	HEL_CHECK(offer.error());
+	HEL_CHECK(sendReq.error());
+	HEL_CHECK(recvResp.error());
+
+	auto maybeResp = bragi::parse_head_only<managarm::ostrace::Response>(recvResp);
+	recvResp.reset();
+	assert(maybeResp);
+	auto &resp = maybeResp.value();
+
+	// Older kernels do not support rings; keep sending records via IPC.
+	if(resp.error() == managarm::ostrace::Error::ILLEGAL_REQUEST)
+		co_return;
+	assert(resp.error() == managarm::ostrace::Error::SUCCESS);
+	HEL_CHECK(pullMemory.error());
+
+	size_t size;
+	HEL_CHECK(helMemoryInfo(pullMemory.descriptor().getHandle(), &size));
+	assert(size > ringDataOffset);
+	ringSize_ = size - ringDataOffset;
+	assert(!(ringSize_ & (ringSize_ - 1)));
+	ringMapping_ = helix::Mapping{pullMemory.descriptor(), 0, size};
+
+	// The kernel drains the ring as long as the conversation is open.
+	ringLane_ = offer.descriptor();
+}
+
+void Context::emitBuffer_(std::span<const char> buffer) {
+	if(appendToRing_(buffer))
+		return;
+	queue_.put(std::vector<char>(buffer.begin(), buffer.end()));
+}
+
+bool Context::appendToRing_(std::span<const char> buffer) {
+	if(!ringMapping_ || buffer.size() > ringMaxPayloadSize)
+		return false;
+
+	auto base = reinterpret_cast<char *>(ringMapping_.get());
+	auto header = reinterpret_cast<RingHeader *>(base);
+	auto data = base + ringDataOffset;
+	auto recordSize = ringRecordSize(buffer.size());
+
+	// Reserve space for the record. The acquire barrier on tail ensures that we see
+	// the kernel's clearing of the space before we overwrite it.
+	auto head = __atomic_load_n(&header->head, __ATOMIC_RELAXED);
+	do {
+		auto tail = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+		if(head + recordSize - tail > ringSize_) {
+			// The kernel reports the number of dropped records.
+			__atomic_fetch_add(&header->dropped, 1, __ATOMIC_RELAXED);
+			return true;
+		}
+	} while(!__atomic_compare_exchange_n(&header->head, &head, head + recordSize,
+			true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	// Copy the payload; it may wrap around the end of the ring.
+	auto recordOffset = head & (ringSize_ - 1);
+	auto recordHeader = reinterpret_cast<RingRecordHeader *>(data + recordOffset);
+	auto payloadOffset = (recordOffset + sizeof(RingRecordHeader)) & (ringSize_ - 1);
+	auto preWrapSize = std::min(ringSize_ - payloadOffset, buffer.size());
+	memcpy(data + payloadOffset, buffer.data(), preWrapSize);
+	memcpy(data, buffer.data() + preWrapSize, buffer.size() - preWrapSize);
+
+	// Commit the record *after* writing the payload.
+	__atomic_store_n(&recordHeader->size, static_cast<uint32_t>(buffer.size()), __ATOMIC_RELAXED);
+	__atomic_store_n(&recordHeader->committed, 1, __ATOMIC_RELEASE);
+	return true;
+}
+
 async::result<void> Context::run_() {
 	if(!enabled_)
 		co_return;
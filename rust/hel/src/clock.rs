@@ -0,0 +1,125 @@
+//! Reading the system-wide monotone clock without a syscall.
+
+use std::ffi::c_void;
+use std::mem::offset_of;
+use std::ptr::NonNull;
+use std::sync::OnceLock;
+use std::sync::atomic::{AtomicU32, AtomicU64, Ordering, fence};
+
+use crate::result::{Result, hel_check};
+
+/// Pointer to the kernel's read-only clock page.
+struct ClockPage(NonNull<hel_sys::HelClockPage>);
+
+// SAFETY: The clock page is mapped read-only for the lifetime of the
+// process and is only accessed atomically.
+unsafe impl Send for ClockPage {}
+unsafe impl Sync for ClockPage {}
+
+impl ClockPage {
+    /// Maps the clock page. Returns [`None`] if the kernel
+    /// does not support it.
+    fn map() -> Option<Self> {
+        let mut pointer: *mut c_void = std::ptr::null_mut();
+
+        hel_check(unsafe {
+            hel_sys::helMapMemory(
+                hel_sys::kHelClockMemory as hel_sys::HelHandle,
+                hel_sys::kHelNullHandle as hel_sys::HelHandle,
+                std::ptr::null_mut(),
+                0,
+                0x1000,
+                hel_sys::kHelMapProtRead,
+                &mut pointer,
+            )
+        })
+        .ok()?;
+
+        NonNull::new(pointer.cast()).map(Self)
+    }
+
+    fn field_u64(&self, offset: usize) -> &AtomicU64 {
+        // SAFETY: The field is 8-byte aligned and only accessed atomically.
+        unsafe { AtomicU64::from_ptr(self.0.as_ptr().byte_add(offset).cast()) }
+    }
+
+    fn field_u32(&self, offset: usize) -> &AtomicU32 {
+        // SAFETY: The field is 4-byte aligned and only accessed atomically.
+        unsafe { AtomicU32::from_ptr(self.0.as_ptr().byte_add(offset).cast()) }
+    }
+
+    /// Returns the clock in nanoseconds since boot, or [`None`] if the
+    /// clock cannot be read from user space.
+    fn read(&self) -> Option<u64> {
+        let seqlock = self.field_u64(offset_of!(hel_sys::HelClockPage, seqlock));
+        let source = self.field_u32(offset_of!(hel_sys::HelClockPage, source));
+        let shift = self.field_u32(offset_of!(hel_sys::HelClockPage, shift));
+        let multiplier = self.field_u64(offset_of!(hel_sys::HelClockPage, multiplier));
+
+        loop {
+            // Start the seqlock read.
+            let seq = seqlock.load(Ordering::Acquire);
+            if seq & 1 != 0 {
+                std::hint::spin_loop();
+                continue;
+            }
+
+            // Perform the actual loads.
+            let source = source.load(Ordering::Relaxed);
+            let shift = shift.load(Ordering::Relaxed);
+            let multiplier = multiplier.load(Ordering::Relaxed);
+
+            // Finish the seqlock read.
+            fence(Ordering::Acquire);
+            if seqlock.load(Ordering::Relaxed) != seq {
+                continue;
+            }
+
+            if source != hel_sys::kHelClockSourceCounter {
+                return None;
+            }
+
+            // This matches the kernel's computation (including the saturation).
+            let product = (read_counter() as u128 * multiplier as u128) >> shift;
+            return Some(u64::try_from(product).unwrap_or(u64::MAX));
+        }
+    }
+}
+
+/// Reads the CPU's timestamp counter.
+fn read_counter() -> u64 {
+    let value: u64;
+
+    #[cfg(target_arch = "x86_64")]
+    unsafe {
+        let lsw: u32;
+        let msw: u32;
+        std::arch::asm!("lfence", "rdtsc", out("eax") lsw, out("edx") msw, options(nostack));
+        value = ((msw as u64) << 32) | lsw as u64;
+    }
+
+    #[cfg(target_arch = "aarch64")]
+    unsafe {
+        std::arch::asm!("isb", "mrs {}, cntvct_el0", out(reg) value, options(nostack));
+    }
+
+    #[cfg(target_arch = "riscv64")]
+    unsafe {
+        std::arch::asm!("rdtime {}", out(reg) value, options(nostack));
+    }
+
+    value
+}
+
+/// Returns the system-wide monotone clock in nanoseconds since boot.
+/// Avoids the syscall if the kernel exports the clock page.
+pub fn clock_nanos() -> Result<u64> {
+    static PAGE: OnceLock<Option<ClockPage>> = OnceLock::new();
+
+    if let Some(nanos) = PAGE.get_or_init(ClockPage::map).as_ref().and_then(ClockPage::read) {
+        return Ok(nanos);
+    }
+
+    let mut nanos = 0;
+    hel_check(unsafe { hel_sys::helGetClock(&mut nanos) }).map(|_| nanos)
+}
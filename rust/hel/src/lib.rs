@@ -4,6 +4,7 @@
 #![feature(generic_const_exprs)]
 #![feature(local_waker)]
 
+pub mod clock;
 pub mod executor;
 pub mod handle;
 pub mod mapping;
@@ -32,9 +33,7 @@ impl Time {
     /// Creates a new [`Time`] instance representing the current time
     /// since boot in nanoseconds.
     pub fn new_since_boot() -> Result<Self> {
-        let mut nanos = 0;
-
-        result::hel_check(unsafe { hel_sys::helGetClock(&mut nanos) }).map(|_| Self(nanos))
+        clock::clock_nanos().map(Self)
     }
 
     /// Creates a new [`Time`] instance from the given number of
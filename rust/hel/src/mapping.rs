@@ -29,6 +29,9 @@ bitflags::bitflags! {
         /// already exists at the same address, it will not be replaced
         /// and the mapping will fail.
         const FIXED_NO_REPLACE = hel_sys::kHelMapFixedNoReplace;
+        /// Only map the faulting page on read faults, even if
+        /// neighbouring pages are already resident.
+        const NO_FAULT_AROUND = hel_sys::kHelMapNoFaultAround;
     }
 }
 
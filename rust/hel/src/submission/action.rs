@@ -11,6 +11,7 @@ const fn default_hel_action() -> hel_sys::HelAction {
         buffer: std::ptr::null_mut(),
         length: 0,
         handle: hel_sys::kHelNullHandle as hel_sys::HelHandle,
+        offset: 0,
     }
 }
 
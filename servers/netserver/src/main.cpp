@@ -845,6 +845,23 @@ static constexpr protocols::svrctl::ControlOperations controlOps = {
 // main() function
 // --------------------------------------------------------
 
+// Busy-polling trades CPU time for IPC latency; enable it if netserver runs on a dedicated core.
+async::detached configureDispatcher() {
+	Cmdline cmdHelper;
+	auto cmdline = co_await cmdHelper.get();
+	bool busyPoll = false;
+
+	frg::array args = {
+		frg::option{"netserver.busy-poll", frg::store_true(busyPoll)},
+	};
+	frg::parse_arguments(cmdline.c_str(), args);
+
+	if(busyPoll) {
+		printf("netserver: Enabling busy-polling\n");
+		helix::Dispatcher::global().enableBusyPolling();
+	}
+}
+
 int main() {
 	printf("netserver: Starting driver\n");
 
@@ -864,6 +881,7 @@ int main() {
 	ip4Router().addRoute(loopbackRoute);
 	nic::runDevice(loopbackLink);
 
+	configureDispatcher();
 	async::detach(protocols::svrctl::serveControl(&controlOps));
 	advertise();
 	async::run_forever(helix::currentDispatcher);
@@ -2,8 +2,18 @@
 
 #include <async/result.hpp>
 #include <async/algorithm.hpp>
+#include <bragi/helpers-std.hpp>
+#include <frg/std_compat.hpp>
+#include <helix/clock.hpp>
 #include <helix/ipc.hpp>
-
+#include <kerncfg.bragi.hpp>
+#include <protocols/mbus/client.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -11,6 +21,9 @@ namespace {
 struct IterationsPerSecondBenchmark {
 	using clock = std::chrono::high_resolution_clock;
 
+	IterationsPerSecondBenchmark(const char *unit = "iterations")
+	: unit_{unit} { }
+
 	void launchRepetition() {
 		ref_ = clock::now();
 	}
@@ -22,7 +35,7 @@ struct IterationsPerSecondBenchmark {
 	}
 
 	void announceIterations(uint64_t iters) {
-		std::cout << "    " << iters << " iterations per second" << std::endl;
+		std::cout << "    " << iters << " " << unit_ << " per second" << std::endl;
 		results_.push_back(iters);
 	}
 
@@ -42,6 +55,7 @@ struct IterationsPerSecondBenchmark {
 	}
 
 private:
+	const char *unit_;
 	std::vector<double> results_;
 	std::chrono::time_point<clock> ref_;
 };
@@ -64,6 +78,30 @@ void doNopBenchmark() {
 	bench.finalizeStatistics();
 }
 
+void doGetClockBenchmark(bool useClockPage) {
+	std::cout << "clock reads" << (useClockPage ? " (clock page)" : " (syscall)") << std::endl;
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			for(int i = 0; i < 100; ++i) {
+				uint64_t now;
+				if(useClockPage) {
+					now = helix::getClockNanos();
+				}else{
+					HEL_CHECK(helGetClock(&now));
+				}
+				asm volatile ("" : : "r"(now));
+				++n;
+			}
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics();
+}
+
 async::result<void> doAsyncNopBenchmark() {
 	std::cout << "ipc ops" << std::endl;
 
@@ -102,6 +140,124 @@ void doFutexBenchmark() {
 	bench.finalizeStatistics();
 }
 
+void pinToCpu(unsigned int cpu) {
+	std::vector<uint8_t> mask(cpu / 8 + 1);
+	mask[cpu / 8] = 1 << (cpu % 8);
+	HEL_CHECK(helSetAffinity(kHelThisThread, mask.data(), mask.size()));
+}
+
+// Threads ping-pong in pairs; each pair waits on and wakes its own futex.
+// Threads are spread across CPUs. Throughput should scale with the number of pairs
+// since only futexes that hash to the same bucket contend on a lock.
+void doParallelFutexBenchmark(unsigned int numThreads) {
+	std::cout << "parallel futex ping-pong (" << numThreads << " threads)" << std::endl;
+
+	struct alignas(64) PaddedFutex {
+		// Even values: the first thread of the pair is active; odd values: the second one.
+		int sequence = 0;
+	};
+
+	unsigned int numPairs = numThreads / 2;
+	unsigned int numCpus = std::max(std::thread::hardware_concurrency(), 1u);
+
+	IterationsPerSecondBenchmark bench{"round trips"};
+	for(int k = 0; k < 5; ++k) {
+		std::vector<PaddedFutex> futexes(numPairs);
+		std::atomic<uint64_t> total{0};
+		std::atomic<bool> done{false};
+		std::vector<std::thread> threads;
+
+		bench.launchRepetition();
+		for(unsigned int t = 0; t < 2 * numPairs; ++t) {
+			threads.emplace_back([&, t] {
+				pinToCpu(t % numCpus);
+				auto futex = &futexes[t / 2].sequence;
+				int parity = t % 2;
+
+				uint64_t n = 0;
+				while(true) {
+					// Sleep until the other thread of the pair passes the turn to us.
+					auto sequence = __atomic_load_n(futex, __ATOMIC_ACQUIRE);
+					while((sequence & 1) != parity) {
+						HEL_CHECK(helFutexWait(futex, sequence, -1));
+						sequence = __atomic_load_n(futex, __ATOMIC_ACQUIRE);
+					}
+
+					// Pass the turn back (also on exit such that the other thread can exit).
+					bool exiting = done.load(std::memory_order_relaxed);
+					__atomic_store_n(futex, sequence + 1, __ATOMIC_RELEASE);
+					HEL_CHECK(helFutexWake(futex));
+					if(exiting)
+						break;
+					if(parity)
+						++n;
+				}
+				total.fetch_add(n, std::memory_order_relaxed);
+			});
+		}
+		while(!bench.isRepetitionDone())
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		done.store(true, std::memory_order_relaxed);
+		for(auto &thread : threads)
+			thread.join();
+		bench.announceIterations(total.load(std::memory_order_relaxed));
+	}
+	bench.finalizeStatistics();
+}
+
+// All threads synchronize in a barrier. All but the last thread to arrive
+// wait on the same futex; the last one wakes them up.
+void doSharedFutexBenchmark(unsigned int numThreads) {
+	std::cout << "shared futex barrier (" << numThreads << " threads)" << std::endl;
+
+	unsigned int numCpus = std::max(std::thread::hardware_concurrency(), 1u);
+
+	IterationsPerSecondBenchmark bench{"barrier rounds"};
+	for(int k = 0; k < 5; ++k) {
+		int generation = 0;
+		std::atomic<unsigned int> numArrived{0};
+		std::atomic<bool> done{false};
+		std::atomic<bool> stopping{false};
+		uint64_t rounds = 0;
+		std::vector<std::thread> threads;
+
+		bench.launchRepetition();
+		for(unsigned int t = 0; t < numThreads; ++t) {
+			threads.emplace_back([&, t] {
+				pinToCpu(t % numCpus);
+
+				uint64_t n = 0;
+				while(true) {
+					auto current = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+					if(numArrived.fetch_add(1, std::memory_order_acq_rel) + 1 == numThreads) {
+						// All threads exit after the same round.
+						numArrived.store(0, std::memory_order_relaxed);
+						stopping.store(done.load(std::memory_order_relaxed),
+								std::memory_order_relaxed);
+						__atomic_store_n(&generation, current + 1, __ATOMIC_RELEASE);
+						HEL_CHECK(helFutexWake(&generation));
+					}else{
+						while(__atomic_load_n(&generation, __ATOMIC_ACQUIRE) == current)
+							HEL_CHECK(helFutexWait(&generation, current, -1));
+					}
+					++n;
+					if(stopping.load(std::memory_order_relaxed))
+						break;
+				}
+				if(!t)
+					rounds = n;
+			});
+		}
+		while(!bench.isRepetitionDone())
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		done.store(true, std::memory_order_relaxed);
+		for(auto &thread : threads)
+			thread.join();
+		bench.announceIterations(rounds);
+	}
+	bench.finalizeStatistics();
+}
+
 void doAllocateBenchmark(size_t size) {
 	std::cout << "allocate memory, size = " << (size / (1024 * 1024)) << " MiB" << std::endl;
 
@@ -205,6 +361,262 @@ void doPageFaultBenchmark(size_t size) {
 	bench.finalizeStatistics();
 }
 
+// Runs the page fault workload on multiple threads at once.
+// Throughput should scale with the number of threads as long as there are enough CPUs.
+void doParallelPageFaultBenchmark(size_t size, unsigned int numThreads) {
+	std::cout << "parallel page faults (mapping size = " << (size / (1024 * 1024)) << " MiB, "
+			<< numThreads << " threads)" << std::endl;
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		std::atomic<uint64_t> total{0};
+		std::atomic<bool> done{false};
+		std::vector<std::thread> threads;
+
+		bench.launchRepetition();
+		for(unsigned int t = 0; t < numThreads; ++t) {
+			threads.emplace_back([&] {
+				uint64_t n = 0;
+				while(!done.load(std::memory_order_relaxed)) {
+					HelHandle handle;
+					HEL_CHECK(helAllocateMemory(size, 0, nullptr, &handle));
+					void *window;
+					HEL_CHECK(helMapMemory(handle, kHelNullHandle, nullptr, 0, size,
+							kHelMapProtRead | kHelMapProtWrite, &window));
+
+					// Touch all mapped pages.
+					auto p = reinterpret_cast<volatile std::byte *>(window);
+					for(size_t progress = 0; progress < size; progress += 0x1000) {
+						p[progress] = static_cast<std::byte>(0);
+						++n;
+					}
+
+					HEL_CHECK(helUnmapMemory(kHelNullHandle, window, size));
+					HEL_CHECK(helCloseDescriptor(kHelThisUniverse, handle));
+				}
+				total.fetch_add(n, std::memory_order_relaxed);
+			});
+		}
+		while(!bench.isRepetitionDone())
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		done.store(true, std::memory_order_relaxed);
+		for(auto &thread : threads)
+			thread.join();
+		bench.announceIterations(total.load(std::memory_order_relaxed));
+	}
+	bench.finalizeStatistics();
+}
+
+// Issues syscalls that only look up a descriptor from multiple threads of the same universe.
+// Throughput should scale with the number of threads since lookups do not take a lock.
+void doParallelDescriptorLookupBenchmark(unsigned int numThreads) {
+	std::cout << "parallel descriptor lookups (" << numThreads << " threads)" << std::endl;
+
+	HelHandle handle;
+	HEL_CHECK(helAllocateMemory(0x1000, 0, nullptr, &handle));
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		std::atomic<uint64_t> total{0};
+		std::atomic<bool> done{false};
+		std::vector<std::thread> threads;
+
+		bench.launchRepetition();
+		for(unsigned int t = 0; t < numThreads; ++t) {
+			threads.emplace_back([&] {
+				uint64_t n = 0;
+				while(!done.load(std::memory_order_relaxed)) {
+					for(int i = 0; i < 100; ++i) {
+						size_t size;
+						HEL_CHECK(helMemoryInfo(handle, &size));
+						++n;
+					}
+				}
+				total.fetch_add(n, std::memory_order_relaxed);
+			});
+		}
+		while(!bench.isRepetitionDone())
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		done.store(true, std::memory_order_relaxed);
+		for(auto &thread : threads)
+			thread.join();
+		bench.announceIterations(total.load(std::memory_order_relaxed));
+	}
+	bench.finalizeStatistics();
+
+	HEL_CHECK(helCloseDescriptor(kHelThisUniverse, handle));
+}
+
+// Runs CPU-bound threads and reports how evenly the work is distributed among them
+// (the imbalance is the ratio of the maximal to the minimal per-thread progress)
+// and how often threads migrate between CPUs.
+void doSchedulerBalanceBenchmark(unsigned int numThreads) {
+	std::cout << "scheduler balance (" << numThreads << " CPU-bound threads)" << std::endl;
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		std::atomic<bool> done{false};
+		std::vector<uint64_t> progress(numThreads);
+		std::vector<uint64_t> migrations(numThreads);
+		std::vector<std::thread> threads;
+
+		bench.launchRepetition();
+		for(unsigned int t = 0; t < numThreads; ++t) {
+			threads.emplace_back([&, t] {
+				uint64_t n = 0;
+				uint64_t m = 0;
+				int lastCpu;
+				HEL_CHECK(helGetCurrentCpu(&lastCpu));
+				while(!done.load(std::memory_order_relaxed)) {
+					// Keep the thread in user space; only sample the CPU occasionally.
+					for(int i = 0; i < 100'000; ++i)
+						asm volatile ("" : : : "memory");
+					++n;
+
+					int cpu;
+					HEL_CHECK(helGetCurrentCpu(&cpu));
+					if(cpu != lastCpu)
+						++m;
+					lastCpu = cpu;
+				}
+				progress[t] = n;
+				migrations[t] = m;
+			});
+		}
+		while(!bench.isRepetitionDone())
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		done.store(true, std::memory_order_relaxed);
+		for(auto &thread : threads)
+			thread.join();
+
+		uint64_t total = 0;
+		uint64_t minProgress = UINT64_MAX;
+		uint64_t maxProgress = 0;
+		uint64_t totalMigrations = 0;
+		for(unsigned int t = 0; t < numThreads; ++t) {
+			total += progress[t];
+			minProgress = std::min(minProgress, progress[t]);
+			maxProgress = std::max(maxProgress, progress[t]);
+			totalMigrations += migrations[t];
+		}
+		std::cout << "    imbalance: "
+				<< (minProgress ? static_cast<double>(maxProgress) / minProgress : INFINITY)
+				<< ", migrations: " << totalMigrations << std::endl;
+		bench.announceIterations(total);
+	}
+	bench.finalizeStatistics();
+}
+
+// Forks a large copy-on-write memory object of which only a few pages are resident.
+// Fork latency should depend on the number of resident pages, not on the size.
+void doSparseForkBenchmark(size_t size, size_t numResident) {
+	std::cout << "sparse fork (size = " << (size / (1024 * 1024)) << " MiB, "
+			<< numResident << " resident pages)" << std::endl;
+
+	HelHandle handle;
+	HEL_CHECK(helCopyOnWrite(kHelZeroMemory, 0, size, &handle));
+	void *window;
+	HEL_CHECK(helMapMemory(handle, kHelNullHandle, nullptr, 0, size,
+			kHelMapProtRead | kHelMapProtWrite, &window));
+
+	// Touch pages that are spread evenly over the object.
+	auto p = reinterpret_cast<volatile std::byte *>(window);
+	auto stride = size / numResident;
+	for(size_t i = 0; i < numResident; ++i)
+		p[i * stride] = static_cast<std::byte>(1);
+
+	HEL_CHECK(helUnmapMemory(kHelNullHandle, window, size));
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			HelHandle forked;
+			HEL_CHECK(helForkMemory(handle, &forked));
+			HEL_CHECK(helCloseDescriptor(kHelThisUniverse, forked));
+			++n;
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics();
+
+	HEL_CHECK(helCloseDescriptor(kHelThisUniverse, handle));
+}
+
+// Faults in fresh pages of the zero memory object; each fault zeroes a page.
+void doZeroFillBenchmark(size_t size) {
+	std::cout << "page zero (mapping size = " << (size / (1024 * 1024)) << " MiB)" << std::endl;
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			HelHandle handle;
+			HEL_CHECK(helCopyOnWrite(kHelZeroMemory, 0, size, &handle));
+			void *window;
+			HEL_CHECK(helMapMemory(handle, kHelNullHandle, nullptr, 0, size,
+					kHelMapProtRead | kHelMapProtWrite, &window));
+
+			auto p = reinterpret_cast<volatile std::byte *>(window);
+			for(size_t progress = 0; progress < size; progress += 0x1000) {
+				p[progress] = static_cast<std::byte>(1);
+				++n;
+			}
+
+			HEL_CHECK(helUnmapMemory(kHelNullHandle, window, size));
+			HEL_CHECK(helCloseDescriptor(kHelThisUniverse, handle));
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics();
+}
+
+// Writes to all pages of a forked copy-on-write object; each fault copies a page.
+void doPageCopyBenchmark(size_t size) {
+	std::cout << "page copy (mapping size = " << (size / (1024 * 1024)) << " MiB)" << std::endl;
+
+	HelHandle handle;
+	HEL_CHECK(helCopyOnWrite(kHelZeroMemory, 0, size, &handle));
+	void *window;
+	HEL_CHECK(helMapMemory(handle, kHelNullHandle, nullptr, 0, size,
+			kHelMapProtRead | kHelMapProtWrite, &window));
+
+	// Make all pages resident such that forks have to copy them.
+	auto p = reinterpret_cast<volatile std::byte *>(window);
+	for(size_t progress = 0; progress < size; progress += 0x1000)
+		p[progress] = static_cast<std::byte>(1);
+
+	HEL_CHECK(helUnmapMemory(kHelNullHandle, window, size));
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			HelHandle forked;
+			HEL_CHECK(helForkMemory(handle, &forked));
+			void *forkedWindow;
+			HEL_CHECK(helMapMemory(forked, kHelNullHandle, nullptr, 0, size,
+					kHelMapProtRead | kHelMapProtWrite, &forkedWindow));
+
+			auto q = reinterpret_cast<volatile std::byte *>(forkedWindow);
+			for(size_t progress = 0; progress < size; progress += 0x1000) {
+				q[progress] = static_cast<std::byte>(2);
+				++n;
+			}
+
+			HEL_CHECK(helUnmapMemory(kHelNullHandle, forkedWindow, size));
+			HEL_CHECK(helCloseDescriptor(kHelThisUniverse, forked));
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics();
+
+	HEL_CHECK(helCloseDescriptor(kHelThisUniverse, handle));
+}
+
 async::result<void> doSendRecvBufferBenchmark(size_t size) {
 	auto [lane1, lane2] = helix::createStream();
 	std::vector<std::byte> sBuf(size);
@@ -247,16 +659,285 @@ async::result<void> doSendRecvBufferBenchmark(size_t size) {
 	bench.finalizeStatistics();
 }
 
+// Measures the bandwidth of large buffer transfers over a stream.
+// Transfers of at least 16 KiB are copied directly between the address spaces.
+async::result<void> doSendRecvThroughputBenchmark(size_t size) {
+	std::cout << "ipc throughput, size = " << (size / 1024) << " KiB" << std::endl;
+
+	auto [lane1, lane2] = helix::createStream();
+	std::vector<std::byte> sBuf(size);
+	std::vector<std::byte> rBuf(size);
+
+	IterationsPerSecondBenchmark bench{"KiB"};
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			co_await async::when_all(
+				async::transform(
+					helix_ng::exchangeMsgs(lane1, helix_ng::sendBuffer(sBuf.data(), size)
+				), [&] (auto result) {
+					auto [send] = std::move(result);
+					HEL_CHECK(send.error());
+				}),
+				async::transform(
+					helix_ng::exchangeMsgs(lane2, helix_ng::recvBuffer(rBuf.data(), size)
+				), [&] (auto result) {
+					auto [recv] = std::move(result);
+					HEL_CHECK(recv.error());
+					assert(recv.actualLength() == size);
+				})
+			);
+			n += size / 1024;
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics();
+}
+
+// Measures request/reply round trips in the way that protocol clients perform them:
+// the client offers a conversation, sends a request and receives an inline reply.
+// With busyPolling, the dispatcher spins before blocking (as servers may opt into).
+async::result<void> doIpcPingPongBenchmark(bool busyPolling) {
+	std::cout << "ipc ping-pong" << (busyPolling ? " (busy-polling)" : "") << std::endl;
+
+	auto &dispatcher = helix::Dispatcher::global();
+	if(busyPolling)
+		dispatcher.enableBusyPolling();
+	auto statsBefore = dispatcher.pollingStats();
+
+	auto [lane1, lane2] = helix::createStream();
+	std::array<std::byte, 64> request{};
+	std::array<std::byte, 64> reply{};
+
+	auto serve = [&] () -> async::result<void> {
+		auto [accept, recvRequest] = co_await helix_ng::exchangeMsgs(
+			lane2,
+			helix_ng::accept(
+				helix_ng::recvInline()
+			)
+		);
+		HEL_CHECK(accept.error());
+		HEL_CHECK(recvRequest.error());
+
+		auto conversation = accept.descriptor();
+		auto [sendReply] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::sendBuffer(reply.data(), reply.size())
+		);
+		HEL_CHECK(sendReply.error());
+	};
+
+	IterationsPerSecondBenchmark bench;
+	for(int k = 0; k < 5; ++k) {
+		uint64_t n = 0;
+		bench.launchRepetition();
+		while(!bench.isRepetitionDone()) {
+			for(int i = 0; i < 100; ++i) {
+				co_await async::when_all(
+					async::transform(
+						helix_ng::exchangeMsgs(
+							lane1,
+							helix_ng::offer(
+								helix_ng::sendBuffer(request.data(), request.size()),
+								helix_ng::recvInline()
+							)
+						), [&] (auto result) {
+							auto [offer, sendRequest, recvReply] = std::move(result);
+							HEL_CHECK(offer.error());
+							HEL_CHECK(sendRequest.error());
+							HEL_CHECK(recvReply.error());
+						}),
+					serve()
+				);
+				++n;
+			}
+		}
+		bench.announceIterations(n);
+	}
+	bench.finalizeStatistics();
+
+	if(busyPolling) {
+		auto statsAfter = dispatcher.pollingStats();
+		std::cout << "    spin hits: " << (statsAfter.spinHits - statsBefore.spinHits)
+				<< ", futex sleeps: " << (statsAfter.futexSleeps - statsBefore.futexSleeps)
+				<< std::endl;
+		dispatcher.disableBusyPolling();
+	}
+}
+
+// Returns the sum of all kerncfg statistics whose name ends in the given suffix
+// (e.g., ".handoffs" sums up the handoffs of all CPUs).
+uint64_t sumKernelStatistics(std::string_view suffix) {
+	return async::run([&] () -> async::result<uint64_t> {
+		auto filter = mbus_ng::Conjunction{{
+			mbus_ng::EqualsFilter{"class", "kerncfg"}
+		}};
+
+		auto enumerator = mbus_ng::Instance::global().enumerate(filter);
+		auto [_, events] = (co_await enumerator.nextEvents()).unwrap();
+		assert(events.size() == 1);
+
+		auto entity = co_await mbus_ng::Instance::global().getEntity(events[0].id);
+		auto lane = (co_await entity.getRemoteLane()).unwrap();
+
+		managarm::kerncfg::GetStatisticsRequest req;
+		auto [offer, sendReq, recvHead] = co_await helix_ng::exchangeMsgs(
+			lane,
+			helix_ng::offer(
+				helix_ng::want_lane,
+				helix_ng::sendBragiHeadOnly(req, frg::stl_allocator{}),
+				helix_ng::recvInline()
+			)
+		);
+		HEL_CHECK(offer.error());
+		HEL_CHECK(sendReq.error());
+		HEL_CHECK(recvHead.error());
+
+		auto conversation = offer.descriptor();
+		auto preamble = bragi::read_preamble(recvHead);
+		assert(!preamble.error());
+
+		std::vector<uint8_t> tail(preamble.tail_size());
+		auto [recvTail] = co_await helix_ng::exchangeMsgs(
+			conversation,
+			helix_ng::recvBuffer(tail.data(), tail.size())
+		);
+		HEL_CHECK(recvTail.error());
+
+		auto resp = *bragi::parse_head_tail<managarm::kerncfg::GetStatisticsResponse>(
+				recvHead, tail);
+		assert(resp.error() == managarm::kerncfg::Error::SUCCESS);
+
+		uint64_t sum = 0;
+		for(size_t i = 0; i < resp.names().size(); ++i) {
+			if(resp.names()[i].ends_with(suffix))
+				sum += resp.values()[i];
+		}
+		co_return sum;
+	}(), helix::currentDispatcher);
+}
+
+// Measures synchronous request/reply round trips over a lane between two threads.
+// The client blocks until the reply arrives, hence each round trip involves two wakeups;
+// if both threads are on the same CPU, the kernel can hand off the CPU directly.
+void doLanePingPongBenchmark(unsigned int clientCpu, unsigned int serverCpu) {
+	std::cout << "lane ping-pong (client on CPU " << clientCpu
+			<< ", server on CPU " << serverCpu << ")" << std::endl;
+
+	auto handoffsBefore = sumKernelStatistics(".handoffs");
+
+	auto [lane1, lane2] = helix::createStream();
+
+	// The server replies to requests until it receives a request with a non-zero first byte.
+	std::thread server{[&, lane = std::move(lane2)] {
+		pinToCpu(serverCpu);
+		async::run([&] () -> async::result<void> {
+			std::array<std::byte, 64> reply{};
+			while(true) {
+				auto [accept, recvRequest] = co_await helix_ng::exchangeMsgs(
+					lane,
+					helix_ng::accept(
+						helix_ng::recvInline()
+					)
+				);
+				HEL_CHECK(accept.error());
+				HEL_CHECK(recvRequest.error());
+				bool stop = static_cast<const uint8_t *>(recvRequest.data())[0];
+
+				auto conversation = accept.descriptor();
+				auto [sendReply] = co_await helix_ng::exchangeMsgs(
+					conversation,
+					helix_ng::sendBuffer(reply.data(), reply.size())
+				);
+				HEL_CHECK(sendReply.error());
+				if(stop)
+					co_return;
+			}
+		}(), helix::currentDispatcher);
+	}};
+
+	std::thread client{[&, lane = std::move(lane1)] {
+		pinToCpu(clientCpu);
+		async::run([&] () -> async::result<void> {
+			std::array<std::byte, 64> request{};
+			auto roundTrip = [&] () -> async::result<void> {
+				auto [offer, sendRequest, recvReply] = co_await helix_ng::exchangeMsgs(
+					lane,
+					helix_ng::offer(
+						helix_ng::sendBuffer(request.data(), request.size()),
+						helix_ng::recvInline()
+					)
+				);
+				HEL_CHECK(offer.error());
+				HEL_CHECK(sendRequest.error());
+				HEL_CHECK(recvReply.error());
+			};
+
+			IterationsPerSecondBenchmark bench{"round trips"};
+			for(int k = 0; k < 5; ++k) {
+				uint64_t n = 0;
+				bench.launchRepetition();
+				while(!bench.isRepetitionDone()) {
+					for(int i = 0; i < 100; ++i) {
+						co_await roundTrip();
+						++n;
+					}
+				}
+				std::cout << "    latency: " << 1'000'000'000 / std::max(n, uint64_t{1})
+						<< " ns per round trip" << std::endl;
+				bench.announceIterations(n);
+			}
+			bench.finalizeStatistics();
+
+			request[0] = std::byte{1};
+			co_await roundTrip();
+		}(), helix::currentDispatcher);
+	}};
+
+	client.join();
+	server.join();
+
+	// If both threads share a CPU, (nearly) every round trip should involve handoffs.
+	std::cout << "    " << (sumKernelStatistics(".handoffs") - handoffsBefore)
+			<< " scheduler handoffs" << std::endl;
+}
+
 } // anonymous namespace
 
 int main() {
 	doNopBenchmark();
 	doFutexBenchmark();
+	doGetClockBenchmark(false);
+	doGetClockBenchmark(true);
 	async::run(doAsyncNopBenchmark(), helix::currentDispatcher);
+	async::run(doIpcPingPongBenchmark(false), helix::currentDispatcher);
+	async::run(doIpcPingPongBenchmark(true), helix::currentDispatcher);
+	doLanePingPongBenchmark(0, 0);
+	if(std::thread::hardware_concurrency() > 1)
+		doLanePingPongBenchmark(0, 1);
 	doAllocateBenchmark(1 << 20);
 	doMapBenchmark(1 << 20);
 	doMapPopulatedBenchmark(1 << 20);
+	// Large enough to be backed by 2 MiB pages.
+	doMapPopulatedBenchmark(16 << 20);
 	doPageFaultBenchmark(1 << 20);
+	doPageFaultBenchmark(16 << 20);
+	for(unsigned int n = 1; n <= std::thread::hardware_concurrency(); n *= 2)
+		doParallelPageFaultBenchmark(1 << 20, n);
+	for(unsigned int n = 1; n <= std::thread::hardware_concurrency(); n *= 2)
+		doParallelDescriptorLookupBenchmark(n);
+	for(unsigned int n = 2; n <= std::max(std::thread::hardware_concurrency(), 2u); n *= 2) {
+		doParallelFutexBenchmark(n);
+		doSharedFutexBenchmark(n);
+	}
+	// Use more threads than CPUs such that the balancer has to distribute them.
+	doSchedulerBalanceBenchmark(std::thread::hardware_concurrency() + 1);
+	doSchedulerBalanceBenchmark(2 * std::thread::hardware_concurrency());
+	doSparseForkBenchmark(size_t{64} << 20, 16);
+	doSparseForkBenchmark(size_t{4} << 30, 16);
+	doZeroFillBenchmark(16 << 20);
+	doPageCopyBenchmark(16 << 20);
 	async::run(doSendRecvBufferBenchmark(1), helix::currentDispatcher);
 	async::run(doSendRecvBufferBenchmark(32), helix::currentDispatcher);
 	async::run(doSendRecvBufferBenchmark(128), helix::currentDispatcher);
@@ -264,4 +945,6 @@ int main() {
 	async::run(doSendRecvBufferBenchmark(16 * 1024), helix::currentDispatcher);
 	async::run(doSendRecvBufferBenchmark(64 * 1024), helix::currentDispatcher);
 	async::run(doSendRecvBufferBenchmark(1024 * 1024), helix::currentDispatcher);
+	for(size_t size = 4 * 1024; size <= 16 * 1024 * 1024; size *= 4)
+		async::run(doSendRecvThroughputBenchmark(size), helix::currentDispatcher);
 }
@@ -2,8 +2,17 @@
 
 import argparse
 import bisect
+import collections
+import os
 import struct
 import subprocess
+import sys
+
+KERNEL_PATH = 'pkg-builds/managarm-kernel/kernel/thor/thor'
+
+# Must match ProfileRecordHeader in kernel/thor/generic/thor-internal/profile.hpp.
+RECORD_MAGIC = 0x50524F46
+RECORD_HEADER = struct.Struct('<IHHQQ')
 
 parser = argparse.ArgumentParser()
 parser.add_argument('profile_path', type=str)
@@ -12,82 +21,182 @@ parser.add_argument('--aggregate-by',
 	help="aggregate samples by source line of code or by symbol inside the binary")
 parser.add_argument('--line', action='store_true')
 parser.add_argument('--isn', action='store_true')
+parser.add_argument('--user-binary', type=str, action='append', default=[],
+	metavar='PATH[@BASE]',
+	help="symbolize user space samples using this binary (loaded at BASE, default 0);"
+		" can be given multiple times, e.g., for posix-subsystem and netserver")
+parser.add_argument('--collapsed', action='store_true',
+	help="print call chains in collapsed stack format (e.g., for flamegraph.pl)")
 
 args = parser.parse_args()
 
-profile = dict()
-
-if args.aggregate_by == 'symbol':
-	nm = subprocess.check_output(
-		[
-			'nm', '-nC',
-			'pkg-builds/managarm-kernel/kernel/thor/thor'
-		],
-		encoding='ascii');
-
-	sym_table = []
-	for line in nm.splitlines():
-		start, attr, symbol = line.split(' ', 2)
-		sym_table.append((int(start, 16), symbol))
-	sym_index = [e[0] for e in sym_table]
-else:
-	addr2line = subprocess.Popen(
-		[
-			'addr2line', '-sfC',
-			'-e', 'pkg-builds/managarm-kernel/kernel/thor/thor'
-		],
-		encoding='ascii',
-		stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+class Binary:
+	def __init__(self, path, base=0):
+		self.path = path
+		self.name = os.path.basename(path)
+		self.base = base
+		self._addr2line = None
+
+		nm = subprocess.check_output(['nm', '-nC', path], encoding='ascii')
+		self.sym_table = []
+		for line in nm.splitlines():
+			parts = line.split(' ', 2)
+			if len(parts) != 3 or not parts[0]:
+				continue
+			self.sym_table.append((int(parts[0], 16) + base, parts[2]))
+		self.sym_index = [e[0] for e in self.sym_table]
+
+	def covers(self, ip):
+		return bool(self.sym_index) and self.sym_index[0] <= ip <= self.sym_index[-1]
+
+	def symbol(self, ip):
+		idx = bisect.bisect_right(self.sym_index, ip)
+		if idx == 0:
+			return None
+		start, symbol = self.sym_table[idx - 1]
+		assert ip >= start
+		return symbol
+
+	def source(self, ip):
+		if self._addr2line is None:
+			self._addr2line = subprocess.Popen(
+				[
+					'addr2line', '-sfC',
+					'-e', self.path
+				],
+				encoding='ascii',
+				stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+		self._addr2line.stdin.write(hex(ip - self.base) + '\n')
+		self._addr2line.stdin.flush()
+		func = self._addr2line.stdout.readline().rstrip()
+		line = self._addr2line.stdout.readline().rstrip()
+		return func, line
+
+	# Returns a (function, location) tuple or None.
+	def resolve(self, ip):
+		if args.aggregate_by == 'symbol':
+			symbol = self.symbol(ip)
+			if symbol is None:
+				return None
+			return symbol, self.name
+		func, line = self.source(ip)
+		if func == '??':
+			return None
+		if args.line:
+			return func, line
+		elif args.isn:
+			return func, line.split(':')[0] + ':' + hex(ip)
+		else:
+			return func, line.split(':')[0]
+
+def parse_binary_arg(spec):
+	path, sep, base = spec.rpartition('@')
+	if not sep:
+		return Binary(spec)
+	return Binary(path, int(base, 0))
+
+kernel = Binary(KERNEL_PATH)
+user_binaries = [parse_binary_arg(spec) for spec in args.user_binary]
+
+# Read all samples.
+samples = []
+n_skipped = 0
+
+with open(args.profile_path, 'rb') as f:
+	data = f.read()
 
+offset = 0
+while offset + RECORD_HEADER.size <= len(data):
+	magic, n_kernel_frames, n_user_frames, tid, uid = RECORD_HEADER.unpack_from(data, offset)
+	size = RECORD_HEADER.size + 8 * (n_kernel_frames + n_user_frames)
+	if magic != RECORD_MAGIC or offset + size > len(data):
+		# Records may be lost; resynchronize on the next magic.
+		# All records are a multiple of 8 bytes long.
+		offset += 8
+		n_skipped += 8
+		continue
+	frames = struct.unpack_from('<{}Q'.format(n_kernel_frames + n_user_frames),
+			data, offset + RECORD_HEADER.size)
+	samples.append((tid, uid, frames[:n_kernel_frames], frames[n_kernel_frames:]))
+	offset += size
+
+if n_skipped:
+	print("Warning: skipped {} bytes of corrupted or truncated records".format(n_skipped),
+		file=sys.stderr)
+
+# Assign each universe to the user binary that covers most of its IPs.
+universe_ips = collections.defaultdict(list)
+for tid, uid, kernel_frames, user_frames in samples:
+	universe_ips[uid].extend(user_frames)
+
+universe_binary = dict()
+for uid, ips in universe_ips.items():
+	best, best_count = None, 0
+	for binary in user_binaries:
+		count = sum(1 for ip in ips if binary.covers(ip))
+		if count > best_count:
+			best, best_count = binary, count
+	universe_binary[uid] = best
+
+def universe_label(uid):
+	if not uid:
+		return 'kernel'
+	binary = universe_binary.get(uid)
+	if binary is None:
+		return 'universe-{}'.format(uid)
+	return '{}-{}'.format(binary.name, uid)
+
+def frame_label(binary, ip):
+	if binary is not None:
+		loc = binary.resolve(ip)
+		if loc is not None:
+			return loc[0]
+	return hex(ip)
+
+if args.collapsed:
+	stacks = collections.Counter()
+	for tid, uid, kernel_frames, user_frames in samples:
+		# Frames are recorded innermost first; collapsed stacks start at the root.
+		chain = [universe_label(uid)]
+		binary = universe_binary.get(uid)
+		chain.extend(frame_label(binary, ip) for ip in reversed(user_frames))
+		chain.extend('[k] ' + frame_label(kernel, ip) for ip in reversed(kernel_frames))
+		stacks[';'.join(s.replace(';', ':') for s in chain)] += 1
+	for stack, count in sorted(stacks.items()):
+		print(stack, count)
+	raise SystemExit(0)
+
+# Flat profile of the innermost frames.
+profile = collections.Counter()
 n_user = 0
 n_kernel = 0
 n_resolved = 0
 
-with open(args.profile_path, 'rb') as f:
-	while True:
-		rec = f.read(8)
-		if not rec:
-			break
-		ip = struct.unpack('Q', rec)[0]
-		if ip < (1 << 63):
-			n_user += 1
+for tid, uid, kernel_frames, user_frames in samples:
+	if kernel_frames:
+		n_kernel += 1
+		loc = kernel.resolve(kernel_frames[0])
+	elif user_frames:
+		n_user += 1
+		binary = universe_binary.get(uid)
+		if binary is None:
 			continue
-		else:
-			n_kernel += 1
+		loc = binary.resolve(user_frames[0])
+	else:
+		continue
 
-		if args.aggregate_by == 'symbol':
-			idx = bisect.bisect_right(sym_index, ip)
-			if idx == 0:
-				continue
-			start, symbol = sym_table[idx - 1];
-			assert ip >= start
-
-			loc = symbol, 0
-		else:
-			addr2line.stdin.write(hex(ip) + '\n')
-			addr2line.stdin.flush()
-			func = addr2line.stdout.readline().rstrip()
-			line = addr2line.stdout.readline().rstrip()
-			if args.line:
-				loc = (func, line)
-			elif args.isn:
-				loc = (func, line.split(':')[0] + ':' + hex(ip))
-			else:
-				loc = (func, line.split(':')[0])
-
-		if loc in profile:
-			profile[loc] += 1
-		else:
-			profile[loc] = 1
-		n_resolved += 1
+	if loc is None:
+		continue
+	profile[loc] += 1
+	n_resolved += 1
 
 n_all = n_user + n_kernel
 
 cumulative = 0
 out = sorted(profile.keys(), key=lambda loc: profile[loc])
 for loc in out:
-	print("{:.2f}% (cumulative: {:.2f}%) ({} samples) in:".format(profile[loc]/n_kernel*100, 100-cumulative/n_kernel*100, profile[loc]))
+	print("{:.2f}% (cumulative: {:.2f}%) ({} samples) in:".format(profile[loc]/n_all*100, 100-cumulative/n_all*100, profile[loc]))
 	print("    {} in {}".format(loc[0], loc[1]))
 	cumulative += profile[loc]
-print("{} (= {:.2f}% of all samples) in the kernel".format(n_kernel, n_kernel/(n_user + n_kernel)*100))
-print("{:.2f}% of all kernel samples could be resolved".format(n_resolved/n_kernel*100))
+print("{} (= {:.2f}% of all samples) in the kernel".format(n_kernel, n_kernel/n_all*100))
+print("{:.2f}% of all samples could be resolved".format(n_resolved/n_all*100))
@@ -1,10 +1,6 @@
 #!/usr/bin/python3
 
 import os
-import shutil
-import subprocess
-import tempfile
-import sys
 import argparse
 
 parser = argparse.ArgumentParser(description = 'Generate a managarm initrd')
@@ -102,28 +98,72 @@ for fname in os.listdir(os.path.join(args.sysroot, 'usr/lib/managarm/server')):
 		continue
 	add_file('usr/lib/managarm/server', 'usr/lib/managarm/server', fname)
 
-# Copy (= hard link) the files to a temporary directory, run GNU cpio.
-
-tree_path = tempfile.mkdtemp(prefix='initrd-', dir='.')
-
-file_list = sorted(file_dict.keys())
-for rel_path in file_list:
-	entry = file_dict[rel_path]
-	dest_path = os.path.join(tree_path, rel_path)
-
-	if entry.is_dir:
-		os.mkdir(dest_path)
-	else:
-		os.link(os.path.realpath(os.path.join(args.sysroot, entry.source)), dest_path)
-
-proc = subprocess.Popen(['cpio', '--create', '--format=newc',
-			'-D', tree_path,
-			'--file', args.out,
-			'--quiet'],
-		stdin=subprocess.PIPE,
-		encoding='ascii')
-proc.communicate(input='\n'.join(file_list))
-if proc.returncode != 0:
-	sys.exit(1)
-
-shutil.rmtree(tree_path)
+# Write the cpio archive (newc format).
+# The data of each regular file starts at a page boundary and is padded with zeros
+# up to the next page boundary. This allows thor to map the files without copying them.
+# To achieve this, we insert NUL bytes before the headers of such files;
+# thor's cpio parser skips these bytes.
+
+PAGE_SIZE = 0x1000
+
+def align_up(x, alignment):
+	return (x + alignment - 1) & ~(alignment - 1)
+
+class CpioWriter:
+	def __init__(self, f):
+		self.f = f
+		self.pos = 0
+		self.ino = 0
+
+	def write(self, data):
+		self.f.write(data)
+		self.pos += len(data)
+
+	def pad_to(self, pos):
+		assert pos >= self.pos
+		self.write(bytes(pos - self.pos))
+
+	def header_size(self, name):
+		return align_up(110 + len(name.encode('ascii')) + 1, 4)
+
+	def write_header(self, name, mode, nlink, mtime, file_size):
+		name_bytes = name.encode('ascii') + b'\0'
+		self.ino += 1
+		fields = [self.ino, mode, 0, 0, nlink, mtime, file_size,
+				0, 0, 0, 0, len(name_bytes), 0]
+		self.write(('070701' + ''.join('{:08X}'.format(v) for v in fields)).encode('ascii'))
+		self.write(name_bytes)
+		self.pad_to(align_up(self.pos, 4))
+
+	def add_dir(self, name):
+		self.write_header(name, 0o040755, 2, 0, 0)
+
+	def add_file(self, name, source_path):
+		st = os.stat(source_path)
+		with open(source_path, 'rb') as src:
+			data = src.read()
+		if data:
+			# Place the header such that the data starts at a page boundary.
+			self.pad_to(align_up(self.pos + self.header_size(name), PAGE_SIZE)
+					- self.header_size(name))
+		self.write_header(name, 0o100000 | (st.st_mode & 0o7777), 1, int(st.st_mtime), len(data))
+		assert not data or self.pos % PAGE_SIZE == 0
+		self.write(data)
+		if data:
+			self.pad_to(align_up(self.pos, PAGE_SIZE))
+		else:
+			self.pad_to(align_up(self.pos, 4))
+
+	def finish(self):
+		self.write_header('TRAILER!!!', 0, 1, 0, 0)
+		self.pad_to(align_up(self.pos, 512))
+
+with open(args.out, 'wb') as f:
+	writer = CpioWriter(f)
+	for rel_path in sorted(file_dict.keys()):
+		entry = file_dict[rel_path]
+		if entry.is_dir:
+			writer.add_dir(rel_path)
+		else:
+			writer.add_file(rel_path, os.path.realpath(os.path.join(args.sysroot, entry.source)))
+	writer.finish()